@@ -1,26 +1,133 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
+//
+// A luminaire in the middle of the ceiling of a room serves the STAs
+// placed on the desks below it. The STAs associate with the luminaire
+// from its beacons, then each sends a UDP flow to the luminaire, and the
+// goodput received by the luminaire is printed at the end.
+//
+// ./waf --run "new-module-example --nStas=4 --payload=1000"
+//
+
 #include "ns3/core-module.h"
-#include "ns3/new-module-helper.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/vlc-helper.h"
+#include <iostream>
+
+NS_LOG_COMPONENT_DEFINE ("NewModuleExample");
 
 using namespace ns3;
 
+static uint64_t g_rxBytes = 0;
+
+static void
+ReceivePacket (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      g_rxBytes += packet->GetSize ();
+    }
+}
 
-int 
+static void
+SendPacket (Ptr<Socket> socket, uint32_t payload, Time interval, Time stop)
+{
+  if (Simulator::Now () >= stop)
+    {
+      return;
+    }
+  socket->Send (Create<Packet> (payload));
+  Simulator::Schedule (interval, &SendPacket, socket, payload, interval, stop);
+}
+
+int
 main (int argc, char *argv[])
 {
-  bool verbose = true;
+  bool verbose = false;
+  uint32_t nStas = 4;
+  uint32_t payload = 1000;
+  double rate = 2.0;
+  double duration = 5.0;
 
   CommandLine cmd;
   cmd.AddValue ("verbose", "Tell application to log if true", verbose);
+  cmd.AddValue ("nStas", "Number of STAs", nStas);
+  cmd.AddValue ("payload", "Size of the UDP payloads, in bytes", payload);
+  cmd.AddValue ("rate", "Offered load of each STA, in Mbit/s", rate);
+  cmd.AddValue ("duration", "Duration of the flows, in seconds", duration);
 
   cmd.Parse (argc,argv);
 
-  /* ... */
+  if (verbose)
+    {
+      LogComponentEnable ("NewModuleExample", LOG_LEVEL_INFO);
+      LogComponentEnable ("VlcHelper", LOG_LEVEL_ALL);
+    }
+
+  NodeContainer apNode;
+  apNode.Create (1);
+  NodeContainer staNodes;
+  staNodes.Create (nStas);
 
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (1.5),
+                                 "MinY", DoubleValue (1.5),
+                                 "Z", DoubleValue (0.8),
+                                 "DeltaX", DoubleValue (1.0),
+                                 "DeltaY", DoubleValue (1.0),
+                                 "GridWidth", UintegerValue (4));
+  mobility.Install (staNodes);
+  Ptr<ListPositionAllocator> ceiling = CreateObject<ListPositionAllocator> ();
+  ceiling->Add (Vector (3.0, 3.0, 3.0));
+  mobility.SetPositionAllocator (ceiling);
+  mobility.Install (apNode);
+
+  VlcChannelHelper channel;
+  channel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  channel.AddPropagationLoss ("ns3::VlcLambertianPropagationLossModel");
+  VlcPhyHelper phy = VlcPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  VlcHelper vlc = VlcHelper::Default ();
+  VlcMacHelper mac = VlcMacHelper::Default ();
+  mac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer apDevice = vlc.Install (phy, mac, apNode);
+  mac.SetType ("ns3::StaVlcMac");
+  NetDeviceContainer staDevices = vlc.Install (phy, mac, staNodes);
+
+  InternetStackHelper stack;
+  stack.Install (apNode);
+  stack.Install (staNodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer apInterface = address.Assign (apDevice);
+  address.Assign (staDevices);
+
+  TypeId udp = UdpSocketFactory::GetTypeId ();
+  Ptr<Socket> sink = Socket::CreateSocket (apNode.Get (0), udp);
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&ReceivePacket));
+
+  // leave one second to the STAs to associate before starting the flows
+  Time start = Seconds (1.0);
+  Time stop = start + Seconds (duration);
+  Time interval = Seconds (payload * 8 / (rate * 1e6));
+  for (uint32_t i = 0; i < nStas; i++)
+    {
+      Ptr<Socket> source = Socket::CreateSocket (staNodes.Get (i), udp);
+      source->Connect (InetSocketAddress (apInterface.GetAddress (0), 9));
+      Simulator::Schedule (start + MicroSeconds (i * 100), &SendPacket, source, payload, interval, stop);
+    }
+
+  Simulator::Stop (stop + Seconds (0.1));
   Simulator::Run ();
   Simulator::Destroy ();
+
+  std::cout << nStas << " STAs, offered " << rate * nStas << " Mbit/s, goodput "
+            << g_rxBytes * 8 / duration / 1e6 << " Mbit/s" << std::endl;
   return 0;
 }
-
-
@@ -0,0 +1,45 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+//
+// Convert a binary PHY state log written by VlcPhyStateRecorder into
+// text, one interval per line:
+//
+//   phyId start(ns) duration(ns) state
+//
+// ./waf --run "vlc-state-log-reader --input=states.bin"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/vlc-phy-state-recorder.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+
+int
+main (int argc, char *argv[])
+{
+  std::string input = "states.bin";
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Binary state log to convert", input);
+
+  cmd.Parse (argc,argv);
+
+  std::vector<VlcPhyStateRecord> records;
+  if (!VlcPhyStateRecordFile::Read (input, records))
+    {
+      std::cerr << input << " is not a VLC state log" << std::endl;
+      return 1;
+    }
+
+  for (std::vector<VlcPhyStateRecord>::const_iterator i = records.begin (); i != records.end (); ++i)
+    {
+      std::cout << i->phyId << " "
+                << i->start << " "
+                << i->duration << " "
+                << static_cast<enum VlcPhy::State> (i->state) << std::endl;
+    }
+  return 0;
+}
@@ -1,11 +0,0 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
-
-#include "new-module-helper.h"
-
-namespace ns3 {
-
-/* ... */
-
-
-}
-
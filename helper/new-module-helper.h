@@ -1,14 +0,0 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
-#ifndef NEW_MODULE_HELPER_H
-#define NEW_MODULE_HELPER_H
-
-#include "ns3/new-module.h"
-
-namespace ns3 {
-
-/* ... */
-
-}
-
-#endif /* NEW_MODULE_HELPER_H */
-
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-counter-snapshotter.h"
+#include "ns3/vlc-net-device.h"
+#include "ns3/vlc-mac.h"
+#include "ns3/vlc-phy.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("VlcCounterSnapshotter");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (VlcCounterSnapshotter)
+  ;
+
+TypeId
+VlcCounterSnapshotter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcCounterSnapshotter")
+    .SetParent<Object> ()
+    .AddConstructor<VlcCounterSnapshotter> ()
+    .AddAttribute ("Interval",
+                   "The interval between two snapshots.",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&VlcCounterSnapshotter::m_interval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+VlcCounterSnapshotter::VlcCounterSnapshotter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+VlcCounterSnapshotter::~VlcCounterSnapshotter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VlcCounterSnapshotter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_snapshotEvent.Cancel ();
+  if (m_os.is_open ())
+    {
+      m_os.close ();
+    }
+  m_devices.clear ();
+  Object::DoDispose ();
+}
+
+void
+VlcCounterSnapshotter::Add (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  Ptr<VlcNetDevice> vlc = DynamicCast<VlcNetDevice> (device);
+  NS_ASSERT (vlc != 0);
+  m_devices.push_back (vlc);
+}
+
+void
+VlcCounterSnapshotter::Add (NetDeviceContainer devices)
+{
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); i++)
+    {
+      Add (*i);
+    }
+}
+
+void
+VlcCounterSnapshotter::Start (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT (m_interval.IsStrictlyPositive ());
+  Stop ();
+  m_os.open (filename.c_str (), std::ios::out | std::ios::trunc);
+  if (!m_os.is_open ())
+    {
+      NS_FATAL_ERROR ("unable to open " << filename);
+    }
+  m_os << "# time node device"
+       << " macTx macTxBytes macTxDrop macRetryDrop macLifetimeDrop macRx macRxBytes macPromiscRx macRxDrop"
+       << " phyTxBegin phyTxBytes phyTxEnd phyTxDrop phyRxBegin phyRxEnd phyRxBytes phyRxDrop"
+       << " dropSwitching dropAlreadyRx dropAlreadyTx dropBelowThreshold dropPer"
+       << " queued" << std::endl;
+  m_snapshotEvent = Simulator::Schedule (m_interval, &VlcCounterSnapshotter::PeriodicSnapshot, this);
+}
+
+void
+VlcCounterSnapshotter::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_snapshotEvent.Cancel ();
+  if (m_os.is_open ())
+    {
+      Snapshot ();
+      m_os.close ();
+    }
+}
+
+void
+VlcCounterSnapshotter::PeriodicSnapshot (void)
+{
+  Snapshot ();
+  m_snapshotEvent = Simulator::Schedule (m_interval, &VlcCounterSnapshotter::PeriodicSnapshot, this);
+}
+
+void
+VlcCounterSnapshotter::Snapshot (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_os.is_open ())
+    {
+      return;
+    }
+  double now = Simulator::Now ().GetSeconds ();
+  for (std::vector<Ptr<VlcNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); i++)
+    {
+      Ptr<VlcNetDevice> device = *i;
+      const VlcMac::Counters &mac = device->GetMac ()->GetCounters ();
+      const VlcPhy::Counters &phy = device->GetPhy ()->GetCounters ();
+      m_os << now << " "
+           << (device->GetNode () != 0 ? device->GetNode ()->GetId () : 0) << " "
+           << device->GetIfIndex () << " "
+           << mac.tx << " " << mac.txBytes << " " << mac.txDrop << " "
+           << mac.retryDrop << " " << mac.lifetimeDrop << " "
+           << mac.rx << " " << mac.rxBytes << " " << mac.promiscRx << " " << mac.rxDrop << " "
+           << phy.txBegin << " " << phy.txBytes << " " << phy.txEnd << " " << phy.txDrop << " "
+           << phy.rxBegin << " " << phy.rxEnd << " " << phy.rxBytes << " " << phy.rxDrop;
+      for (uint32_t reason = 0; reason < VlcPhy::RX_DROP_N_REASONS; reason++)
+        {
+          m_os << " " << phy.rxDropReason[reason];
+        }
+      m_os << " " << device->GetQueuedPackets () << "\n";
+    }
+  m_os.flush ();
+}
+
+} // namespace ns3
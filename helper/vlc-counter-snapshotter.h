@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_COUNTER_SNAPSHOTTER_H
+#define VLC_COUNTER_SNAPSHOTTER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+class VlcNetDevice;
+
+/**
+ * \brief write the counters of VlcNetDevices at a fixed interval
+ *
+ * Every Interval, the snapshotter writes one text line per device with
+ * the cumulative counters of its MAC and PHY (see VlcMac::GetCounters and
+ * VlcPhy::GetCounters), the PHY drops broken down by reason and the
+ * number of frames queued in the MAC:
+ *
+ *   time(s) node device macTx macTxBytes macTxDrop macRetryDrop
+ *   macLifetimeDrop macRx macRxBytes macPromiscRx macRxDrop phyTxBegin
+ *   phyTxBytes phyTxEnd phyTxDrop phyRxBegin phyRxEnd phyRxBytes phyRxDrop
+ *   dropSwitching dropAlreadyRx dropAlreadyTx dropBelowThreshold dropPer
+ *   queued
+ *
+ * The counters are read in place, so the cost does not depend on the
+ * number of packets exchanged between two snapshots.
+ */
+class VlcCounterSnapshotter : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcCounterSnapshotter ();
+  virtual ~VlcCounterSnapshotter ();
+
+  /**
+   * \param device a VlcNetDevice whose counters are written
+   */
+  void Add (Ptr<NetDevice> device);
+  /**
+   * \param devices VlcNetDevices whose counters are written
+   */
+  void Add (NetDeviceContainer devices);
+  /**
+   * Create (or truncate) the given file, write the column names and
+   * start the periodic snapshots.
+   *
+   * \param filename the name of the file
+   */
+  void Start (std::string filename);
+  /**
+   * Write a last snapshot and close the file.
+   */
+  void Stop (void);
+  /**
+   * Write the counters of all the devices now.
+   */
+  void Snapshot (void);
+
+private:
+  virtual void DoDispose (void);
+  /**
+   * Write a snapshot and schedule the next one.
+   */
+  void PeriodicSnapshot (void);
+
+  std::vector<Ptr<VlcNetDevice> > m_devices; //!< The devices whose counters are written
+  std::ofstream m_os;                         //!< The output file
+  Time m_interval;                            //!< Interval between two snapshots
+  EventId m_snapshotEvent;                    //!< Next periodic snapshot
+};
+
+} // namespace ns3
+
+#endif /* VLC_COUNTER_SNAPSHOTTER_H */
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-helper.h"
+#include "ns3/vlc-net-device.h"
+#include "ns3/vlc-mac.h"
+#include "ns3/vlc-phy.h"
+#include "ns3/yans-vlc-phy.h"
+#include "ns3/ap-vlc-mac.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/mac48-address.h"
+#include "ns3/names.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("VlcHelper");
+
+namespace ns3 {
+
+VlcHelper::VlcHelper ()
+  : m_standard (WIFI_PHY_STANDARD_80211a)
+{
+  m_device.SetTypeId ("ns3::VlcNetDevice");
+  m_stationManager.SetTypeId ("ns3::VlcSnrRateManager");
+}
+
+VlcHelper
+VlcHelper::Default (void)
+{
+  return VlcHelper ();
+}
+
+void
+VlcHelper::SetRemoteStationManager (std::string type,
+                                    std::string n0, const AttributeValue &v0,
+                                    std::string n1, const AttributeValue &v1,
+                                    std::string n2, const AttributeValue &v2,
+                                    std::string n3, const AttributeValue &v3)
+{
+  m_stationManager = ObjectFactory ();
+  m_stationManager.SetTypeId (type);
+  m_stationManager.Set (n0, v0);
+  m_stationManager.Set (n1, v1);
+  m_stationManager.Set (n2, v2);
+  m_stationManager.Set (n3, v3);
+}
+
+void
+VlcHelper::SetDeviceAttribute (std::string name, const AttributeValue &v)
+{
+  m_device.Set (name, v);
+}
+
+void
+VlcHelper::SetStandard (enum WifiPhyStandard standard)
+{
+  m_standard = standard;
+}
+
+NetDeviceContainer
+VlcHelper::Install (const VlcPhyHelper &phyHelper,
+                    const VlcMacHelper &macHelper, NodeContainer c) const
+{
+  NetDeviceContainer devices;
+  phyHelper.Reserve (c.GetN ());
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      Ptr<VlcNetDevice> device = m_device.Create<VlcNetDevice> ();
+      Ptr<WifiRemoteStationManager> manager = m_stationManager.Create<WifiRemoteStationManager> ();
+      Ptr<VlcMac> mac = macHelper.Create ();
+      Ptr<VlcPhy> phy = phyHelper.Create (node, device);
+      mac->SetAddress (Mac48Address::Allocate ());
+      mac->ConfigureStandard (m_standard);
+      phy->ConfigureStandard (m_standard);
+      device->SetMac (mac);
+      device->SetPhy (phy);
+      device->SetRemoteStationManager (manager);
+      node->AddDevice (device);
+      devices.Add (device);
+      NS_LOG_DEBUG ("node=" << node->GetId () << ", address=" << mac->GetAddress ());
+    }
+  return devices;
+}
+
+NetDeviceContainer
+VlcHelper::Install (const VlcPhyHelper &phy,
+                    const VlcMacHelper &mac, Ptr<Node> node) const
+{
+  return Install (phy, mac, NodeContainer (node));
+}
+
+NetDeviceContainer
+VlcHelper::Install (const VlcPhyHelper &phy,
+                    const VlcMacHelper &mac, std::string nodeName) const
+{
+  Ptr<Node> node = Names::Find<Node> (nodeName);
+  return Install (phy, mac, NodeContainer (node));
+}
+
+int64_t
+VlcHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<VlcNetDevice> device = DynamicCast<VlcNetDevice> (*i);
+      if (device == 0)
+        {
+          continue;
+        }
+      currentStream += device->GetPhy ()->AssignStreams (currentStream);
+      Ptr<ApVlcMac> ap = DynamicCast<ApVlcMac> (device->GetMac ());
+      if (ap != 0)
+        {
+          currentStream += ap->AssignStreams (currentStream);
+        }
+    }
+  return (currentStream - stream);
+}
+
+Ptr<VlcPhyStateRecordFile>
+VlcHelper::EnableStateLog (std::string filename, NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION (filename);
+  Ptr<VlcPhyStateRecordFile> file = CreateObject<VlcPhyStateRecordFile> ();
+  file->Open (filename);
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<VlcNetDevice> device = DynamicCast<VlcNetDevice> (c.Get (i));
+      if (device == 0)
+        {
+          continue;
+        }
+      Ptr<YansVlcPhy> phy = DynamicCast<YansVlcPhy> (device->GetPhy ());
+      if (phy == 0)
+        {
+          NS_LOG_WARN ("The PHY of device " << i << " cannot record its states");
+          continue;
+        }
+      Ptr<VlcPhyStateRecorder> recorder = CreateObject<VlcPhyStateRecorder> ();
+      recorder->SetPhyId (i);
+      recorder->SetFile (file);
+      phy->SetStateRecorder (recorder);
+    }
+  return file;
+}
+
+} // namespace ns3
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_HELPER_H
+#define VLC_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/wifi-phy-standard.h"
+#include "ns3/vlc-phy-state-recorder.h"
+#include "vlc-phy-helper.h"
+#include "vlc-mac-helper.h"
+
+namespace ns3 {
+
+/**
+ * \brief helps to create VlcNetDevice objects
+ *
+ * The counterpart of WifiHelper: for each node, creates a VlcNetDevice
+ * with a MAC from a VlcMacHelper, a PHY from a VlcPhyHelper and a remote
+ * station manager, gives it a new MAC address, configures the standard
+ * and adds the device to the node. All the objects come from factories
+ * configured once, so installing on many nodes only costs the creation
+ * of the objects themselves.
+ */
+class VlcHelper
+{
+public:
+  /**
+   * Create a helper with a ns3::VlcSnrRateManager and the 802.11a
+   * standard.
+   */
+  VlcHelper ();
+
+  /**
+   * \returns a helper in the default state
+   */
+  static VlcHelper Default (void);
+
+  /**
+   * \param type the type of the remote station manager
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   * \param n2 the name of the attribute to set
+   * \param v2 the value of the attribute to set
+   * \param n3 the name of the attribute to set
+   * \param v3 the value of the attribute to set
+   */
+  void SetRemoteStationManager (std::string type,
+                                std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                                std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                                std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                                std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+  /**
+   * \param name the name of a ns3::VlcNetDevice attribute
+   * \param v the value of the attribute, set on every device created
+   */
+  void SetDeviceAttribute (std::string name, const AttributeValue &v);
+  /**
+   * \param standard the standard the MACs and PHYs are configured for
+   */
+  void SetStandard (enum WifiPhyStandard standard);
+
+  /**
+   * \param phy the helper which creates the PHYs
+   * \param mac the helper which creates the MACs
+   * \param c the nodes to install a device on
+   * \returns the devices created
+   */
+  NetDeviceContainer Install (const VlcPhyHelper &phy,
+                              const VlcMacHelper &mac, NodeContainer c) const;
+  /**
+   * \param phy the helper which creates the PHY
+   * \param mac the helper which creates the MAC
+   * \param node the node to install a device on
+   * \returns the device created
+   */
+  NetDeviceContainer Install (const VlcPhyHelper &phy,
+                              const VlcMacHelper &mac, Ptr<Node> node) const;
+  /**
+   * \param phy the helper which creates the PHY
+   * \param mac the helper which creates the MAC
+   * \param nodeName the name of the node to install a device on
+   * \returns the device created
+   */
+  NetDeviceContainer Install (const VlcPhyHelper &phy,
+                              const VlcMacHelper &mac, std::string nodeName) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the PHYs and the access point MACs of the given devices.
+   *
+   * \param c the VlcNetDevices
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  static int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
+
+  /**
+   * Record the state intervals of the PHYs of the given devices in a
+   * binary state log, which the vlc-state-log-reader example converts
+   * into text. The records of the i-th device of the container carry the
+   * PHY identifier i.
+   *
+   * \param filename the name of the log
+   * \param c the VlcNetDevices
+   * \return the log, to close once the simulation is over
+   */
+  static Ptr<VlcPhyStateRecordFile> EnableStateLog (std::string filename, NetDeviceContainer c);
+
+private:
+  ObjectFactory m_device;         //!< Factory of the devices
+  ObjectFactory m_stationManager; //!< Factory of the remote station managers
+  enum WifiPhyStandard m_standard; //!< Standard of the MACs and PHYs
+};
+
+} // namespace ns3
+
+#endif /* VLC_HELPER_H */
@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-mac-helper.h"
+
+namespace ns3 {
+
+VlcMacHelper::VlcMacHelper ()
+{
+  m_mac.SetTypeId ("ns3::StaVlcMac");
+}
+
+VlcMacHelper
+VlcMacHelper::Default (void)
+{
+  return VlcMacHelper ();
+}
+
+void
+VlcMacHelper::SetType (std::string type,
+                       std::string n0, const AttributeValue &v0,
+                       std::string n1, const AttributeValue &v1,
+                       std::string n2, const AttributeValue &v2,
+                       std::string n3, const AttributeValue &v3,
+                       std::string n4, const AttributeValue &v4,
+                       std::string n5, const AttributeValue &v5)
+{
+  m_mac = ObjectFactory ();
+  m_mac.SetTypeId (type);
+  m_mac.Set (n0, v0);
+  m_mac.Set (n1, v1);
+  m_mac.Set (n2, v2);
+  m_mac.Set (n3, v3);
+  m_mac.Set (n4, v4);
+  m_mac.Set (n5, v5);
+}
+
+void
+VlcMacHelper::Set (std::string name, const AttributeValue &v)
+{
+  m_mac.Set (name, v);
+}
+
+Ptr<VlcMac>
+VlcMacHelper::Create (void) const
+{
+  return m_mac.Create<VlcMac> ();
+}
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_MAC_HELPER_H
+#define VLC_MAC_HELPER_H
+
+#include <string>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/vlc-mac.h"
+
+namespace ns3 {
+
+/**
+ * \brief create MAC layers for a ns3::VlcNetDevice
+ *
+ * The counterpart of NqosWifiMacHelper and QosWifiMacHelper: the type
+ * of the MAC (ns3::StaVlcMac or ns3::ApVlcMac) and its attributes, e.g.
+ * "Ssid" or "QosSupported".
+ */
+class VlcMacHelper
+{
+public:
+  /**
+   * Create a MAC helper for ns3::StaVlcMac objects.
+   */
+  VlcMacHelper ();
+
+  /**
+   * \returns a MAC helper in the default state
+   */
+  static VlcMacHelper Default (void);
+
+  /**
+   * \param type the type of the MAC
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   * \param n2 the name of the attribute to set
+   * \param v2 the value of the attribute to set
+   * \param n3 the name of the attribute to set
+   * \param v3 the value of the attribute to set
+   * \param n4 the name of the attribute to set
+   * \param v4 the value of the attribute to set
+   * \param n5 the name of the attribute to set
+   * \param v5 the value of the attribute to set
+   */
+  void SetType (std::string type,
+                std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
+                std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue (),
+                std::string n5 = "", const AttributeValue &v5 = EmptyAttributeValue ());
+  /**
+   * \param name the name of the attribute to set
+   * \param v the value of the attribute
+   */
+  void Set (std::string name, const AttributeValue &v);
+
+  /**
+   * \returns a new MAC
+   */
+  Ptr<VlcMac> Create (void) const;
+
+private:
+  ObjectFactory m_mac; //!< Factory of the MACs
+};
+
+} // namespace ns3
+
+#endif /* VLC_MAC_HELPER_H */
@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-office-floor-helper.h"
+#include "ns3/vlc-propagation-loss-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("VlcOfficeFloorHelper");
+
+namespace ns3 {
+
+VlcOfficeFloorHelper::VlcOfficeFloorHelper ()
+  : m_roomsX (1),
+    m_roomsY (1),
+    m_width (6.0),
+    m_depth (6.0),
+    m_luminairesX (2),
+    m_luminairesY (2),
+    m_ceilingHeight (3.0),
+    m_stasPerRoom (4),
+    m_deskHeight (0.8),
+    m_randomBlockers (0),
+    m_blockerSize (Vector (0.5, 0.5, 1.8)),
+    m_blockerAttenuation (100.0),
+    m_stream (-1)
+{
+  m_channel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  m_channel.AddPropagationLoss ("ns3::VlcLambertianPropagationLossModel");
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+void
+VlcOfficeFloorHelper::SetRooms (uint32_t roomsX, uint32_t roomsY, double width, double depth)
+{
+  NS_ASSERT (roomsX > 0 && roomsY > 0 && width > 0 && depth > 0);
+  m_roomsX = roomsX;
+  m_roomsY = roomsY;
+  m_width = width;
+  m_depth = depth;
+}
+
+void
+VlcOfficeFloorHelper::SetLuminaireGrid (uint32_t n, uint32_t m)
+{
+  NS_ASSERT (n > 0 && m > 0);
+  m_luminairesX = n;
+  m_luminairesY = m;
+}
+
+void
+VlcOfficeFloorHelper::SetCeilingHeight (double height)
+{
+  m_ceilingHeight = height;
+}
+
+void
+VlcOfficeFloorHelper::SetStasPerRoom (uint32_t n)
+{
+  m_stasPerRoom = n;
+}
+
+void
+VlcOfficeFloorHelper::SetDeskHeight (double height)
+{
+  m_deskHeight = height;
+}
+
+void
+VlcOfficeFloorHelper::SetChannelHelper (const VlcChannelHelper &channel)
+{
+  m_channel = channel;
+}
+
+void
+VlcOfficeFloorHelper::AddBlocker (Box blocker)
+{
+  m_blockers.push_back (blocker);
+}
+
+void
+VlcOfficeFloorHelper::SetRandomBlockers (uint32_t n, Vector size)
+{
+  NS_ASSERT (size.x <= m_width && size.y <= m_depth);
+  m_randomBlockers = n;
+  m_blockerSize = size;
+}
+
+void
+VlcOfficeFloorHelper::SetBlockerAttenuation (double db)
+{
+  m_blockerAttenuation = db;
+}
+
+void
+VlcOfficeFloorHelper::SetStream (int64_t stream)
+{
+  m_stream = stream;
+}
+
+void
+VlcOfficeFloorHelper::Install (const VlcHelper &helper, const VlcPhyHelper &phy,
+                               const VlcMacHelper &apMac, const VlcMacHelper &staMac)
+{
+  NS_LOG_FUNCTION (this);
+  int64_t stream = m_stream;
+  if (stream >= 0)
+    {
+      m_random->SetStream (stream++);
+    }
+
+  m_rooms.clear ();
+  m_rooms.resize (m_roomsX * m_roomsY);
+  for (uint32_t y = 0; y < m_roomsY; y++)
+    {
+      for (uint32_t x = 0; x < m_roomsX; x++)
+        {
+          m_rooms[y * m_roomsX + x].bounds = Box (x * m_width, (x + 1) * m_width,
+                                                  y * m_depth, (y + 1) * m_depth,
+                                                  0, m_ceilingHeight);
+        }
+    }
+  for (std::vector<Box>::const_iterator i = m_blockers.begin (); i != m_blockers.end (); ++i)
+    {
+      Vector center ((i->xMin + i->xMax) / 2, (i->yMin + i->yMax) / 2, (i->zMin + i->zMax) / 2);
+      m_rooms[GetRoomIndex (center)].blockers.push_back (*i);
+    }
+
+  VlcPhyHelper roomPhy = phy;
+  for (Rooms::iterator room = m_rooms.begin (); room != m_rooms.end (); ++room)
+    {
+      const Box &b = room->bounds;
+      for (uint32_t i = 0; i < m_randomBlockers; i++)
+        {
+          double x = m_random->GetValue (b.xMin, b.xMax - m_blockerSize.x);
+          double y = m_random->GetValue (b.yMin, b.yMax - m_blockerSize.y);
+          room->blockers.push_back (Box (x, x + m_blockerSize.x,
+                                         y, y + m_blockerSize.y,
+                                         0, m_blockerSize.z));
+        }
+
+      room->channel = m_channel.Create ();
+      if (!room->blockers.empty ())
+        {
+          Ptr<VlcBlockerPropagationLossModel> blockers = CreateObject<VlcBlockerPropagationLossModel> ();
+          blockers->SetAttribute ("Attenuation", DoubleValue (m_blockerAttenuation));
+          for (std::vector<Box>::const_iterator i = room->blockers.begin (); i != room->blockers.end (); ++i)
+            {
+              blockers->AddBlocker (*i);
+            }
+          PointerValue loss;
+          room->channel->GetAttribute ("PropagationLossModel", loss);
+          if (loss.Get<PropagationLossModel> () != 0)
+            {
+              blockers->SetNext (loss.Get<PropagationLossModel> ());
+            }
+          room->channel->SetPropagationLossModel (blockers);
+        }
+      roomPhy.SetChannel (room->channel);
+
+      room->apNodes.Create (m_luminairesX * m_luminairesY);
+      double stepX = (b.xMax - b.xMin) / m_luminairesX;
+      double stepY = (b.yMax - b.yMin) / m_luminairesY;
+      for (uint32_t i = 0; i < room->apNodes.GetN (); i++)
+        {
+          Place (room->apNodes.Get (i),
+                 Vector (b.xMin + (i % m_luminairesX + 0.5) * stepX,
+                         b.yMin + (i / m_luminairesX + 0.5) * stepY,
+                         m_ceilingHeight));
+        }
+      room->staNodes.Create (m_stasPerRoom);
+      for (uint32_t i = 0; i < room->staNodes.GetN (); i++)
+        {
+          Place (room->staNodes.Get (i),
+                 Vector (m_random->GetValue (b.xMin, b.xMax),
+                         m_random->GetValue (b.yMin, b.yMax),
+                         m_deskHeight));
+        }
+
+      room->apDevices = helper.Install (roomPhy, apMac, room->apNodes);
+      room->staDevices = helper.Install (roomPhy, staMac, room->staNodes);
+      if (stream >= 0)
+        {
+          stream += VlcChannelHelper::AssignStreams (room->channel, stream);
+          stream += VlcHelper::AssignStreams (room->apDevices, stream);
+          stream += VlcHelper::AssignStreams (room->staDevices, stream);
+        }
+      NS_LOG_DEBUG ("room " << (room - m_rooms.begin ()) << ": " << room->apNodes.GetN () << " luminaires, "
+                    << room->staNodes.GetN () << " STAs, " << room->blockers.size () << " obstacles");
+    }
+}
+
+uint32_t
+VlcOfficeFloorHelper::GetNRooms (void) const
+{
+  return m_rooms.size ();
+}
+
+Box
+VlcOfficeFloorHelper::GetRoomBounds (uint32_t room) const
+{
+  NS_ASSERT (room < m_rooms.size ());
+  return m_rooms[room].bounds;
+}
+
+Ptr<YansVlcChannel>
+VlcOfficeFloorHelper::GetChannel (uint32_t room) const
+{
+  NS_ASSERT (room < m_rooms.size ());
+  return m_rooms[room].channel;
+}
+
+NodeContainer
+VlcOfficeFloorHelper::GetApNodes (uint32_t room) const
+{
+  NS_ASSERT (room < m_rooms.size ());
+  return m_rooms[room].apNodes;
+}
+
+NodeContainer
+VlcOfficeFloorHelper::GetStaNodes (uint32_t room) const
+{
+  NS_ASSERT (room < m_rooms.size ());
+  return m_rooms[room].staNodes;
+}
+
+NetDeviceContainer
+VlcOfficeFloorHelper::GetApDevices (uint32_t room) const
+{
+  NS_ASSERT (room < m_rooms.size ());
+  return m_rooms[room].apDevices;
+}
+
+NetDeviceContainer
+VlcOfficeFloorHelper::GetStaDevices (uint32_t room) const
+{
+  NS_ASSERT (room < m_rooms.size ());
+  return m_rooms[room].staDevices;
+}
+
+NetDeviceContainer
+VlcOfficeFloorHelper::GetApDevices (void) const
+{
+  NetDeviceContainer devices;
+  for (Rooms::const_iterator i = m_rooms.begin (); i != m_rooms.end (); ++i)
+    {
+      devices.Add (i->apDevices);
+    }
+  return devices;
+}
+
+NetDeviceContainer
+VlcOfficeFloorHelper::GetStaDevices (void) const
+{
+  NetDeviceContainer devices;
+  for (Rooms::const_iterator i = m_rooms.begin (); i != m_rooms.end (); ++i)
+    {
+      devices.Add (i->staDevices);
+    }
+  return devices;
+}
+
+uint32_t
+VlcOfficeFloorHelper::GetRoomIndex (Vector position) const
+{
+  uint32_t x = std::min (static_cast<uint32_t> (std::max (position.x, 0.0) / m_width), m_roomsX - 1);
+  uint32_t y = std::min (static_cast<uint32_t> (std::max (position.y, 0.0) / m_depth), m_roomsY - 1);
+  return y * m_roomsX + x;
+}
+
+void
+VlcOfficeFloorHelper::Place (Ptr<Node> node, Vector position)
+{
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (position);
+  node->AggregateObject (mobility);
+}
+
+} // namespace ns3
@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_OFFICE_FLOOR_HELPER_H
+#define VLC_OFFICE_FLOOR_HELPER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/box.h"
+#include "ns3/vector.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/yans-vlc-channel.h"
+#include "vlc-helper.h"
+#include "vlc-phy-helper.h"
+#include "vlc-mac-helper.h"
+
+namespace ns3 {
+
+/**
+ * \brief build the VLC deployment of an office floor
+ *
+ * The floor is a grid of rooms of the same size. Each room has a grid of
+ * luminaires (the APs) on its ceiling and STAs placed at random on its
+ * desks, and gets its own YansVlcChannel, since light does not cross the
+ * walls: a frame is only delivered to the PHYs of its room, and the cost
+ * of a transmission does not grow with the size of the floor. Obstacles
+ * (people, partitions) can be placed in the rooms explicitly or at
+ * random; they attenuate the links crossing them through a
+ * ns3::VlcBlockerPropagationLossModel added to the channel of their room.
+ *
+ * The channels come from a VlcChannelHelper which, by default, uses a
+ * ns3::VlcLambertianPropagationLossModel, in which the higher node of a
+ * link faces down and the lower one faces up. With that model, the STAs
+ * on the desks do not hear each other, nor do the luminaires.
+ *
+ * The floor is built in a single pass, in time linear in the number of
+ * nodes. When a stream is set with SetStream, the positions of the STAs
+ * and of the random obstacles, and the random variables of the channels
+ * and devices, use fixed streams from that index on: the same
+ * configuration then always builds the same floor.
+ */
+class VlcOfficeFloorHelper
+{
+public:
+  /**
+   * Create a helper for a single 6m x 6m room, 3m high, with 2x2
+   * luminaires, 4 STAs on 0.8m high desks and no obstacles.
+   */
+  VlcOfficeFloorHelper ();
+
+  /**
+   * \param roomsX the number of rooms along the x axis
+   * \param roomsY the number of rooms along the y axis
+   * \param width the size of a room along the x axis (m)
+   * \param depth the size of a room along the y axis (m)
+   */
+  void SetRooms (uint32_t roomsX, uint32_t roomsY, double width, double depth);
+  /**
+   * \param n the number of luminaires of a room along the x axis
+   * \param m the number of luminaires of a room along the y axis
+   */
+  void SetLuminaireGrid (uint32_t n, uint32_t m);
+  /**
+   * \param height the height of the luminaires (m)
+   */
+  void SetCeilingHeight (double height);
+  /**
+   * \param n the number of STAs of a room
+   */
+  void SetStasPerRoom (uint32_t n);
+  /**
+   * \param height the height of the STAs (m)
+   */
+  void SetDeskHeight (double height);
+  /**
+   * \param channel the helper which creates the channel of each room
+   */
+  void SetChannelHelper (const VlcChannelHelper &channel);
+  /**
+   * Place an obstacle on the floor. It is added to the room which
+   * contains its center.
+   *
+   * \param blocker the volume of the obstacle, in floor coordinates
+   */
+  void AddBlocker (Box blocker);
+  /**
+   * Place obstacles at random positions on the floor of every room.
+   *
+   * \param n the number of obstacles of a room
+   * \param size the size of an obstacle along the x, y and z axes (m)
+   */
+  void SetRandomBlockers (uint32_t n, Vector size);
+  /**
+   * \param db the attenuation of a link crossing an obstacle (dB)
+   */
+  void SetBlockerAttenuation (double db);
+  /**
+   * Use fixed random variable streams, from the given index on, to build
+   * the floor and for the channels and devices it creates.
+   *
+   * \param stream the first stream index to use
+   */
+  void SetStream (int64_t stream);
+
+  /**
+   * Create the nodes, channels and devices of the floor. Any floor
+   * previously built by this helper is forgotten.
+   *
+   * \param helper the helper which creates the devices
+   * \param phy the helper which creates the PHYs; its channel is replaced
+   *        by the channel of each room
+   * \param apMac the helper which creates the MACs of the luminaires
+   * \param staMac the helper which creates the MACs of the STAs
+   */
+  void Install (const VlcHelper &helper, const VlcPhyHelper &phy,
+                const VlcMacHelper &apMac, const VlcMacHelper &staMac);
+
+  /**
+   * \returns the number of rooms
+   */
+  uint32_t GetNRooms (void) const;
+  /**
+   * \param room the index of a room
+   * \returns the volume of the room, in floor coordinates
+   */
+  Box GetRoomBounds (uint32_t room) const;
+  /**
+   * \param room the index of a room
+   * \returns the channel of the room
+   */
+  Ptr<YansVlcChannel> GetChannel (uint32_t room) const;
+  /**
+   * \param room the index of a room
+   * \returns the nodes of the luminaires of the room
+   */
+  NodeContainer GetApNodes (uint32_t room) const;
+  /**
+   * \param room the index of a room
+   * \returns the nodes of the STAs of the room
+   */
+  NodeContainer GetStaNodes (uint32_t room) const;
+  /**
+   * \param room the index of a room
+   * \returns the devices of the luminaires of the room
+   */
+  NetDeviceContainer GetApDevices (uint32_t room) const;
+  /**
+   * \param room the index of a room
+   * \returns the devices of the STAs of the room
+   */
+  NetDeviceContainer GetStaDevices (uint32_t room) const;
+  /**
+   * \returns the devices of the luminaires of all the rooms
+   */
+  NetDeviceContainer GetApDevices (void) const;
+  /**
+   * \returns the devices of the STAs of all the rooms
+   */
+  NetDeviceContainer GetStaDevices (void) const;
+
+private:
+  /**
+   * The nodes and devices of a room.
+   */
+  struct Room
+  {
+    Box bounds;                       //!< Volume of the room
+    Ptr<YansVlcChannel> channel;      //!< Channel of the room
+    std::vector<Box> blockers;        //!< Obstacles of the room
+    NodeContainer apNodes;            //!< Nodes of the luminaires
+    NodeContainer staNodes;           //!< Nodes of the STAs
+    NetDeviceContainer apDevices;     //!< Devices of the luminaires
+    NetDeviceContainer staDevices;    //!< Devices of the STAs
+  };
+  typedef std::vector<Room> Rooms; //!< Rooms of the floor
+
+  /**
+   * \param position a position, in floor coordinates
+   * \returns the index of the room which contains the position
+   */
+  uint32_t GetRoomIndex (Vector position) const;
+  /**
+   * \param node a node
+   * \param position the constant position to give to the node
+   */
+  static void Place (Ptr<Node> node, Vector position);
+
+  uint32_t m_roomsX;            //!< Number of rooms along the x axis
+  uint32_t m_roomsY;            //!< Number of rooms along the y axis
+  double m_width;               //!< Size of a room along the x axis (m)
+  double m_depth;               //!< Size of a room along the y axis (m)
+  uint32_t m_luminairesX;       //!< Number of luminaires of a room along the x axis
+  uint32_t m_luminairesY;       //!< Number of luminaires of a room along the y axis
+  double m_ceilingHeight;       //!< Height of the luminaires (m)
+  uint32_t m_stasPerRoom;       //!< Number of STAs of a room
+  double m_deskHeight;          //!< Height of the STAs (m)
+  std::vector<Box> m_blockers;  //!< Obstacles placed explicitly
+  uint32_t m_randomBlockers;    //!< Number of random obstacles of a room
+  Vector m_blockerSize;         //!< Size of the random obstacles (m)
+  double m_blockerAttenuation;  //!< Attenuation of a blocked link (dB)
+  int64_t m_stream;             //!< First stream index, or -1
+  VlcChannelHelper m_channel;   //!< Helper which creates the channels
+  Ptr<UniformRandomVariable> m_random; //!< Positions of the STAs and random obstacles
+  Rooms m_rooms;                //!< Rooms of the last floor built
+};
+
+} // namespace ns3
+
+#endif /* VLC_OFFICE_FLOOR_HELPER_H */
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-phy-helper.h"
+#include "ns3/yans-vlc-phy.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("VlcPhyHelper");
+
+namespace ns3 {
+
+VlcChannelHelper::VlcChannelHelper ()
+{
+}
+
+VlcChannelHelper
+VlcChannelHelper::Default (void)
+{
+  VlcChannelHelper helper;
+  helper.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  helper.AddPropagationLoss ("ns3::LogDistancePropagationLossModel");
+  return helper;
+}
+
+void
+VlcChannelHelper::AddPropagationLoss (std::string type,
+                                      std::string n0, const AttributeValue &v0,
+                                      std::string n1, const AttributeValue &v1,
+                                      std::string n2, const AttributeValue &v2,
+                                      std::string n3, const AttributeValue &v3)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  factory.Set (n0, v0);
+  factory.Set (n1, v1);
+  factory.Set (n2, v2);
+  factory.Set (n3, v3);
+  m_propagationLoss.push_back (factory);
+}
+
+void
+VlcChannelHelper::SetPropagationDelay (std::string type,
+                                       std::string n0, const AttributeValue &v0,
+                                       std::string n1, const AttributeValue &v1)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  factory.Set (n0, v0);
+  factory.Set (n1, v1);
+  m_propagationDelay = factory;
+}
+
+Ptr<YansVlcChannel>
+VlcChannelHelper::Create (void) const
+{
+  Ptr<YansVlcChannel> channel = CreateObject<YansVlcChannel> ();
+  Ptr<PropagationLossModel> prev = 0;
+  for (std::vector<ObjectFactory>::const_iterator i = m_propagationLoss.begin (); i != m_propagationLoss.end (); i++)
+    {
+      Ptr<PropagationLossModel> cur = (*i).Create<PropagationLossModel> ();
+      if (prev != 0)
+        {
+          prev->SetNext (cur);
+        }
+      else
+        {
+          channel->SetPropagationLossModel (cur);
+        }
+      prev = cur;
+    }
+  Ptr<PropagationDelayModel> delay = m_propagationDelay.Create<PropagationDelayModel> ();
+  channel->SetPropagationDelayModel (delay);
+  return channel;
+}
+
+int64_t
+VlcChannelHelper::AssignStreams (Ptr<YansVlcChannel> channel, int64_t stream)
+{
+  return channel->AssignStreams (stream);
+}
+
+VlcPhyHelper::VlcPhyHelper ()
+  : m_channel (0)
+{
+  m_phy.SetTypeId ("ns3::YansVlcPhy");
+  m_errorRateModel.SetTypeId ("ns3::NistErrorRateModel");
+}
+
+VlcPhyHelper
+VlcPhyHelper::Default (void)
+{
+  return VlcPhyHelper ();
+}
+
+void
+VlcPhyHelper::SetChannel (Ptr<YansVlcChannel> channel)
+{
+  m_channel = channel;
+}
+
+void
+VlcPhyHelper::Set (std::string name, const AttributeValue &v)
+{
+  m_phy.Set (name, v);
+}
+
+void
+VlcPhyHelper::SetErrorRateModel (std::string name,
+                                 std::string n0, const AttributeValue &v0,
+                                 std::string n1, const AttributeValue &v1)
+{
+  m_errorRateModel = ObjectFactory ();
+  m_errorRateModel.SetTypeId (name);
+  m_errorRateModel.Set (n0, v0);
+  m_errorRateModel.Set (n1, v1);
+}
+
+void
+VlcPhyHelper::Reserve (uint32_t n) const
+{
+  NS_ASSERT (m_channel != 0);
+  m_channel->Reserve (m_channel->GetNDevices () + n);
+}
+
+Ptr<VlcPhy>
+VlcPhyHelper::Create (Ptr<Node> node, Ptr<NetDevice> device) const
+{
+  NS_ASSERT (m_channel != 0);
+  Ptr<YansVlcPhy> phy = m_phy.Create<YansVlcPhy> ();
+  Ptr<ErrorRateModel> error = m_errorRateModel.Create<ErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (m_channel);
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+  return phy;
+}
+
+} // namespace ns3
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_PHY_HELPER_H
+#define VLC_PHY_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/yans-vlc-channel.h"
+#include "ns3/vlc-phy.h"
+
+namespace ns3 {
+
+/**
+ * \brief manage and create YansVlcChannel objects
+ *
+ * The counterpart of YansWifiChannelHelper: the propagation loss models
+ * (chained in the order they are added) and the propagation delay model
+ * of the channels it creates.
+ */
+class VlcChannelHelper
+{
+public:
+  /**
+   * Create a channel helper without any propagation model.
+   */
+  VlcChannelHelper ();
+
+  /**
+   * \returns a channel helper with a ns3::LogDistancePropagationLossModel
+   *          and a ns3::ConstantSpeedPropagationDelayModel.
+   */
+  static VlcChannelHelper Default (void);
+
+  /**
+   * \param name the type of the propagation loss model to add
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   * \param n2 the name of the attribute to set
+   * \param v2 the value of the attribute to set
+   * \param n3 the name of the attribute to set
+   * \param v3 the value of the attribute to set
+   *
+   * The loss of the channels is the sum of the losses of all the models
+   * added, in the order they were added.
+   */
+  void AddPropagationLoss (std::string name,
+                           std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                           std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                           std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                           std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+  /**
+   * \param name the type of the propagation delay model
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   */
+  void SetPropagationDelay (std::string name,
+                            std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                            std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue ());
+
+  /**
+   * \returns a new channel, with new instances of the propagation models
+   */
+  Ptr<YansVlcChannel> Create (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the channel (its propagation loss models).
+   *
+   * \param channel the channel
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (Ptr<YansVlcChannel> channel, int64_t stream);
+
+private:
+  std::vector<ObjectFactory> m_propagationLoss; //!< Factories of the chained loss models
+  ObjectFactory m_propagationDelay;             //!< Factory of the delay model
+};
+
+/**
+ * \brief make it easy to create and manage PHY objects
+ *
+ * The counterpart of YansWifiPhyHelper: creates the YansVlcPhy (and its
+ * error rate model) of each device and attaches it to the channel, the
+ * node (as the mobility model holder) and the device. The factories are
+ * configured once and shared by all the PHYs created.
+ */
+class VlcPhyHelper
+{
+public:
+  /**
+   * Create a PHY helper without any channel and with a
+   * ns3::NistErrorRateModel.
+   */
+  VlcPhyHelper ();
+
+  /**
+   * \returns a PHY helper in the default state
+   */
+  static VlcPhyHelper Default (void);
+
+  /**
+   * \param channel the channel the created PHYs are attached to
+   */
+  void SetChannel (Ptr<YansVlcChannel> channel);
+  /**
+   * \param name the name of the attribute to set
+   * \param v the value of the attribute
+   *
+   * Set an attribute of the ns3::YansVlcPhy objects created.
+   */
+  void Set (std::string name, const AttributeValue &v);
+  /**
+   * \param name the type of the error rate model
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   */
+  void SetErrorRateModel (std::string name,
+                          std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                          std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue ());
+
+  /**
+   * Reserve room in the channel for the given number of additional PHYs.
+   *
+   * \param n the number of PHYs about to be created
+   */
+  void Reserve (uint32_t n) const;
+  /**
+   * \param node the node the PHY belongs to, which holds its mobility model
+   * \param device the device the PHY belongs to
+   * \returns a new PHY attached to the channel
+   */
+  Ptr<VlcPhy> Create (Ptr<Node> node, Ptr<NetDevice> device) const;
+
+private:
+  ObjectFactory m_phy;            //!< Factory of the PHYs
+  ObjectFactory m_errorRateModel; //!< Factory of the error rate models
+  Ptr<YansVlcChannel> m_channel;  //!< The channel of the PHYs
+};
+
+} // namespace ns3
+
+#endif /* VLC_PHY_HELPER_H */
@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-static-association-helper.h"
+#include "ns3/vlc-net-device.h"
+#include "ns3/sta-vlc-mac.h"
+#include "ns3/ap-vlc-mac.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("VlcStaticAssociationHelper");
+
+namespace ns3 {
+
+void
+VlcStaticAssociationHelper::Associate (Ptr<NetDevice> sta, Ptr<NetDevice> ap)
+{
+  Ptr<VlcNetDevice> staDevice = DynamicCast<VlcNetDevice> (sta);
+  Ptr<VlcNetDevice> apDevice = DynamicCast<VlcNetDevice> (ap);
+  NS_ASSERT (staDevice != 0 && apDevice != 0);
+  Ptr<StaVlcMac> staMac = DynamicCast<StaVlcMac> (staDevice->GetMac ());
+  Ptr<ApVlcMac> apMac = DynamicCast<ApVlcMac> (apDevice->GetMac ());
+  if (staMac == 0 || apMac == 0)
+    {
+      NS_FATAL_ERROR ("static association needs a StaVlcMac and an ApVlcMac");
+    }
+  NS_LOG_DEBUG ("associating sta=" << staMac->GetAddress () << " with ap=" << apMac->GetAddress ());
+  apMac->AddStaticStation (staMac->GetAddress ());
+  staMac->SetStaticAssociation (apMac->GetAddress ());
+}
+
+void
+VlcStaticAssociationHelper::Install (NetDeviceContainer stas, NetDeviceContainer aps)
+{
+  NS_ASSERT (aps.GetN () > 0);
+  for (uint32_t i = 0; i < stas.GetN (); i++)
+    {
+      Associate (stas.Get (i), aps.Get (i % aps.GetN ()));
+    }
+}
+
+} // namespace ns3
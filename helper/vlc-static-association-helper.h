@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_STATIC_ASSOCIATION_HELPER_H
+#define VLC_STATIC_ASSOCIATION_HELPER_H
+
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+/**
+ * \brief associate STAs with APs at configuration time
+ *
+ * The STAs start the simulation associated, without the probe and
+ * association exchanges, which is useful for steady-state experiments
+ * with many STAs. The devices must be installed (their MAC, PHY and
+ * remote station manager set) before the helper is used.
+ */
+class VlcStaticAssociationHelper
+{
+public:
+  /**
+   * Associate one STA with one AP.
+   *
+   * \param sta the VlcNetDevice of the STA, with a StaVlcMac
+   * \param ap the VlcNetDevice of the AP, with an ApVlcMac
+   */
+  static void Associate (Ptr<NetDevice> sta, Ptr<NetDevice> ap);
+  /**
+   * Associate each STA with one of the APs, in a round robin fashion:
+   * the i-th STA is associated with the (i modulo the number of APs)-th
+   * AP.
+   *
+   * \param stas the VlcNetDevices of the STAs
+   * \param aps the VlcNetDevices of the APs
+   */
+  static void Install (NetDeviceContainer stas, NetDeviceContainer aps);
+};
+
+} // namespace ns3
+
+#endif /* VLC_STATIC_ASSOCIATION_HELPER_H */
@@ -27,6 +27,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/qos-tag.h"
 #include "vlc-phy.h"
@@ -37,6 +38,15 @@
 #include "ns3/mac-low.h"
 #include "ns3/amsdu-subframe-header.h"
 #include "ns3/msdu-aggregator.h"
+#include "vlc-superframe-header.h"
+#include "vlc-beacon-scheduler.h"
+#include "ns3/dca-txop.h"
+#include "ns3/edca-txop-n.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "ns3/msdu-standard-aggregator.h"
+#include <algorithm>
+#include <map>
 
 NS_LOG_COMPONENT_DEFINE ("ApVlcMac");
 
@@ -49,7 +59,7 @@ TypeId
 ApVlcMac::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::ApVlcMac")
-    .SetParent<RegularWifiMac> ()
+    .SetParent<VlcMac> ()
     .AddConstructor<ApVlcMac> ()
     .AddAttribute ("BeaconInterval", "Delay between two beacons",
                    TimeValue (MicroSeconds (102400)),
@@ -69,6 +79,76 @@ ApVlcMac::GetTypeId (void)
                    MakeBooleanAccessor (&ApVlcMac::SetBeaconGeneration,
                                         &ApVlcMac::GetBeaconGeneration),
                    MakeBooleanChecker ())
+    .AddAttribute ("ShareBeaconScheduler",
+                   "If true, the beacons are sent by a scheduler shared by all the APs, which "
+                   "keeps one pending event per distinct beacon interval instead of one per AP. "
+                   "The phase given by BeaconJitter is rounded down to a BeaconSchedulerTick.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ApVlcMac::m_shareBeaconScheduler),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BeaconSchedulerTick",
+                   "The granularity of the beacon phases of the shared scheduler: the APs whose "
+                   "phases fall in the same tick share one event. All the APs sharing the "
+                   "scheduler must use the same value.",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&ApVlcMac::m_beaconSchedulerTick),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableSuperframe",
+                   "If true, every beacon starts a superframe made of a contention access "
+                   "period followed by guaranteed time slots allocated to the associated STAs.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ApVlcMac::m_enableSuperframe),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FinalCapSlot",
+                   "The last of the 16 superframe slots which belongs to the contention access period.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&ApVlcMac::m_finalCapSlot),
+                   MakeUintegerChecker<uint8_t> (0, 15))
+    .AddAttribute ("EnableFairQueueing",
+                   "If true, unicast data frames are queued per receiving station and "
+                   "handed over to the DCF/EDCAF by an airtime-fair deficit round robin scheduler.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ApVlcMac::m_enableFairQueueing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FairQueueingQuantum",
+                   "The airtime credited to a station at each round of the fair queueing scheduler.",
+                   TimeValue (MicroSeconds (1000)),
+                   MakeTimeAccessor (&ApVlcMac::SetFairQueueingQuantum),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableAggregation",
+                   "If true and QoS is supported, the frames sent to the same station are "
+                   "aggregated into A-MSDUs and acknowledged with block acks.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ApVlcMac::m_enableAggregation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxAggregateSize",
+                   "The maximum size of an aggregate in bytes.",
+                   UintegerValue (7935),
+                   MakeUintegerAccessor (&ApVlcMac::m_maxAggregateSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxAggregateAge",
+                   "The maximum time a frame is held to fill an aggregate. "
+                   "A zero value hands the frames over immediately.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&ApVlcMac::m_maxAggregateAge),
+                   MakeTimeChecker ())
+    .AddAttribute ("BlockAckThreshold",
+                   "The number of frames queued for a station which triggers the setup "
+                   "of a block ack agreement when aggregation is enabled.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&ApVlcMac::m_blockAckThreshold),
+                   MakeUintegerChecker<uint8_t> (0, 64))
+    .AddAttribute ("MaxGts",
+                   "The maximum number of guaranteed time slots allocated in one superframe.",
+                   UintegerValue (7),
+                   MakeUintegerAccessor (&ApVlcMac::m_maxGts),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("GtsTimeout",
+                   "The time after which an associated STA we received nothing from loses "
+                   "its guaranteed time slot, until it sends again. A zero value disables it.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&ApVlcMac::m_gtsTimeout),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -87,6 +167,15 @@ ApVlcMac::ApVlcMac ()
   SetTypeOfStation (AP);
 
   m_enableBeaconGeneration = false;
+  m_shareBeaconScheduler = false;
+  m_beaconSchedulerRegistered = false;
+  m_beaconSchedulerId = 0;
+  m_beaconTemplateNModes = 0;
+  m_beaconTemplateNBasicModes = 0;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_aggregationBuffers[i].bytes = 0;
+    }
 }
 
 ApVlcMac::~ApVlcMac ()
@@ -99,9 +188,16 @@ ApVlcMac::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_beaconDca = 0;
+  m_beaconTemplate = 0;
   m_enableBeaconGeneration = false;
-  m_beaconEvent.Cancel ();
-  RegularWifiMac::DoDispose ();
+  CancelBeacons ();
+  m_gtsStations.clear ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_aggregationBuffers[i].flushEvent.Cancel ();
+      m_aggregationBuffers[i].frames.clear ();
+    }
+  VlcMac::DoDispose ();
 }
 
 void
@@ -110,8 +206,31 @@ ApVlcMac::SetAddress (Mac48Address address)
   NS_LOG_FUNCTION (this << address);
   // As an AP, our MAC address is also the BSSID. Hence we are
   // overriding this function and setting both in our parent class.
-  RegularWifiMac::SetAddress (address);
-  RegularWifiMac::SetBssid (address);
+  VlcMac::SetAddress (address);
+  VlcMac::SetBssid (address);
+}
+
+void
+ApVlcMac::SetSsid (Ssid ssid)
+{
+  NS_LOG_FUNCTION (this << ssid);
+  VlcMac::SetSsid (ssid);
+  InvalidateBeaconTemplate ();
+}
+
+void
+ApVlcMac::SetWifiPhy (Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  VlcMac::SetWifiPhy (phy);
+  InvalidateBeaconTemplate ();
+}
+
+void
+ApVlcMac::InvalidateBeaconTemplate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_beaconTemplate = 0;
 }
 
 void
@@ -120,11 +239,11 @@ ApVlcMac::SetBeaconGeneration (bool enable)
   NS_LOG_FUNCTION (this << enable);
   if (!enable)
     {
-      m_beaconEvent.Cancel ();
+      CancelBeacons ();
     }
   else if (enable && !m_enableBeaconGeneration)
     {
-      m_beaconEvent = Simulator::ScheduleNow (&ApVlcMac::SendOneBeacon, this);
+      ScheduleBeacons (Seconds (0));
     }
   m_enableBeaconGeneration = enable;
 }
@@ -148,14 +267,15 @@ ApVlcMac::SetWifiRemoteStationManager (Ptr<WifiRemoteStationManager> stationMana
 {
   NS_LOG_FUNCTION (this << stationManager);
   m_beaconDca->SetWifiRemoteStationManager (stationManager);
-  RegularWifiMac::SetWifiRemoteStationManager (stationManager);
+  VlcMac::SetWifiRemoteStationManager (stationManager);
+  InvalidateBeaconTemplate ();
 }
 
 void
 ApVlcMac::SetLinkUpCallback (Callback<void> linkUp)
 {
   NS_LOG_FUNCTION (this << &linkUp);
-  RegularWifiMac::SetLinkUpCallback (linkUp);
+  VlcMac::SetLinkUpCallback (linkUp);
 
   // The approach taken here is that, from the point of view of an AP,
   // the link is always up, so we immediately invoke the callback if
@@ -172,6 +292,19 @@ ApVlcMac::SetBeaconInterval (Time interval)
       NS_LOG_WARN ("beacon interval should be multiple of 1024us, see IEEE Std. 802.11-2007, section 11.1.1.1");
     }
   m_beaconInterval = interval;
+  InvalidateBeaconTemplate ();
+  if (m_beaconSchedulerRegistered)
+    {
+      // Keep the time of the next beacon, the following ones use the
+      // new interval
+      Time delay = Max (m_lastBeacon + m_beaconSchedulerInterval - Simulator::Now (), Seconds (0));
+      if (delay >= interval)
+        {
+          delay = Seconds (0);
+        }
+      CancelBeacons ();
+      ScheduleBeacons (delay);
+    }
 }
 
 void
@@ -181,6 +314,26 @@ ApVlcMac::StartBeaconing (void)
   SendOneBeacon ();
 }
 
+void
+ApVlcMac::AddStaticStation (Mac48Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  for (uint32_t i = 0; i < m_phy->GetNModes (); i++)
+    {
+      m_stationManager->AddSupportedMode (address, m_phy->GetMode (i));
+    }
+  if (m_htSupported)
+    {
+      for (uint32_t i = 0; i < m_phy->GetNMcs (); i++)
+        {
+          m_stationManager->AddSupportedMcs (address, m_phy->GetMcs (i));
+        }
+    }
+  m_stationManager->RecordWaitAssocTxOk (address);
+  m_stationManager->RecordGotAssocTxOk (address);
+  RefreshGtsStation (address);
+}
+
 int64_t
 ApVlcMac::AssignStreams (int64_t stream)
 {
@@ -220,6 +373,14 @@ ApVlcMac::ForwardDown (Ptr<const Packet> packet_vlc, Mac48Address from,
                         Mac48Address to, uint8_t tid)
 {
   NS_LOG_FUNCTION (this << packet_vlc << from << to << static_cast<uint32_t> (tid));
+  // Sanity check that the TID is valid
+  NS_ASSERT (tid < 8);
+  QueueData (packet_vlc, GetForwardHeader (from, to, tid), m_qosSupported ? QosUtilsMapTidToAc (tid) : AC_BE);
+}
+
+WifiMacHeader
+ApVlcMac::GetForwardHeader (Mac48Address from, Mac48Address to, uint8_t tid) const
+{
   WifiMacHeader hdr;
 
   // For now, an AP that supports QoS does not support non-QoS
@@ -233,9 +394,7 @@ ApVlcMac::ForwardDown (Ptr<const Packet> packet_vlc, Mac48Address from,
       hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
       hdr.SetQosNoEosp ();
       hdr.SetQosNoAmsdu ();
-      // Transmission of multiple frames in the same TXOP is not
-      // supported for now
-      hdr.SetQosTxopLimit (0);
+      hdr.SetQosTxopLimit (GetQosTxopLimit (QosUtilsMapTidToAc (tid)));
       // Fill in the QoS control field in the MAC header
       hdr.SetQosTid (tid);
     }
@@ -251,12 +410,99 @@ ApVlcMac::ForwardDown (Ptr<const Packet> packet_vlc, Mac48Address from,
   hdr.SetAddr3 (from);
   hdr.SetDsFrom ();
   hdr.SetDsNotTo ();
+  return hdr;
+}
 
-  if (m_qosSupported)
+void
+ApVlcMac::QueueData (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr, enum AcIndex ac)
+{
+  NS_LOG_FUNCTION (this << packet_vlc << ac);
+  if (m_enableAggregation && m_qosSupported
+      && m_maxAggregateAge.IsStrictlyPositive ()
+      && !hdr.GetAddr1 ().IsGroup ())
+    {
+      // Hold the frame so that the EDCAF finds more than one frame to
+      // aggregate when it gets access to the medium.
+      AggregationBuffer &buffer = m_aggregationBuffers[ac];
+      buffer.frames.push_back (std::make_pair (packet_vlc, hdr));
+      buffer.bytes += packet_vlc->GetSize ();
+      if (buffer.bytes >= m_maxAggregateSize)
+        {
+          FlushAggregationBuffer (ac);
+        }
+      else if (!buffer.flushEvent.IsRunning ())
+        {
+          buffer.flushEvent = Simulator::Schedule (m_maxAggregateAge,
+                                                   &ApVlcMac::FlushAggregationBuffer, this, ac);
+        }
+      return;
+    }
+  SendToTxQueue (packet_vlc, hdr, ac);
+}
+
+void
+ApVlcMac::QueueData (const FrameList &frames, enum AcIndex ac)
+{
+  NS_LOG_FUNCTION (this << frames.size () << ac);
+  if (m_enableAggregation && m_qosSupported
+      && m_maxAggregateAge.IsStrictlyPositive ())
     {
-      // Sanity check that the TID is valid
-      NS_ASSERT (tid < 8);
-      m_edca[QosUtilsMapTidToAc (tid)]->Queue (packet_vlc, hdr);
+      AggregationBuffer &buffer = m_aggregationBuffers[ac];
+      FrameList group;
+      for (FrameList::const_iterator i = frames.begin (); i != frames.end (); i++)
+        {
+          if (i->second.GetAddr1 ().IsGroup ())
+            {
+              group.push_back (*i);
+            }
+          else
+            {
+              buffer.frames.push_back (*i);
+              buffer.bytes += i->first->GetSize ();
+            }
+        }
+      if (buffer.bytes >= m_maxAggregateSize)
+        {
+          FlushAggregationBuffer (ac);
+        }
+      else if (!buffer.frames.empty () && !buffer.flushEvent.IsRunning ())
+        {
+          buffer.flushEvent = Simulator::Schedule (m_maxAggregateAge,
+                                                   &ApVlcMac::FlushAggregationBuffer, this, ac);
+        }
+      if (!group.empty ())
+        {
+          SendToTxQueue (group, ac);
+        }
+      return;
+    }
+  SendToTxQueue (frames, ac);
+}
+
+void
+ApVlcMac::FlushAggregationBuffer (enum AcIndex ac)
+{
+  NS_LOG_FUNCTION (this << ac);
+  AggregationBuffer &buffer = m_aggregationBuffers[ac];
+  buffer.flushEvent.Cancel ();
+  FrameList frames;
+  frames.swap (buffer.frames);
+  buffer.bytes = 0;
+  SendToTxQueue (frames, ac);
+}
+
+void
+ApVlcMac::SendToTxQueue (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr, enum AcIndex ac)
+{
+  NS_LOG_FUNCTION (this << packet_vlc << ac);
+  if (m_enableFairQueueing && !hdr.GetAddr1 ().IsGroup ())
+    {
+      m_fairQueues[ac].Enqueue (packet_vlc, hdr, GetDataAirtime (packet_vlc, hdr));
+      FeedTxQueue (ac);
+    }
+  else if (m_qosSupported)
+    {
+      m_edca[ac]->Queue (packet_vlc, hdr);
     }
   else
     {
@@ -264,6 +510,98 @@ ApVlcMac::ForwardDown (Ptr<const Packet> packet_vlc, Mac48Address from,
     }
 }
 
+void
+ApVlcMac::SendToTxQueue (const FrameList &frames, enum AcIndex ac)
+{
+  NS_LOG_FUNCTION (this << frames.size () << ac);
+  bool feed = false;
+  for (FrameList::const_iterator i = frames.begin (); i != frames.end (); i++)
+    {
+      if (m_enableFairQueueing && !i->second.GetAddr1 ().IsGroup ())
+        {
+          m_fairQueues[ac].Enqueue (i->first, i->second, GetDataAirtime (i->first, i->second));
+          feed = true;
+        }
+      else if (m_qosSupported)
+        {
+          m_edca[ac]->Queue (i->first, i->second);
+        }
+      else
+        {
+          m_dca->Queue (i->first, i->second);
+        }
+    }
+  if (feed)
+    {
+      FeedTxQueue (ac);
+    }
+}
+
+void
+ApVlcMac::FeedTxQueue (enum AcIndex ac)
+{
+  NS_LOG_FUNCTION (this << ac);
+  Ptr<WifiMacQueue> queue = m_qosSupported ? m_edca[ac]->GetQueue () : m_dca->GetQueue ();
+  // Only one frame (or, with aggregation, one aggregate worth of frames)
+  // waits in the DCF/EDCAF queue: a station at a low rate can then only
+  // delay the others by the frame being transmitted. The queue is fed
+  // again by NotifyTxQueueDrain once it is empty.
+  if (!queue->IsEmpty ())
+    {
+      return;
+    }
+  Ptr<const Packet> packet_vlc;
+  WifiMacHeader hdr;
+  // The aggregate is also bounded by the TXOP limit of the AC.
+  uint32_t limit = m_enableAggregation && m_qosSupported ? m_maxAggregateSize : 0;
+  Time txopLimit = m_qosSupported ? GetTxopLimit (ac) : Seconds (0);
+  uint32_t bytes = 0;
+  Time airtime = Seconds (0);
+  while ((bytes == 0
+          || (bytes < limit && (txopLimit.IsZero () || airtime < txopLimit)))
+         && m_fairQueues[ac].Dequeue (packet_vlc, hdr))
+    {
+      bytes += packet_vlc->GetSize ();
+      airtime += GetDataAirtime (packet_vlc, hdr);
+      if (m_qosSupported)
+        {
+          m_edca[ac]->Queue (packet_vlc, hdr);
+        }
+      else
+        {
+          m_dca->Queue (packet_vlc, hdr);
+        }
+    }
+}
+
+void
+ApVlcMac::SetupAggregation (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_enableAggregation || !m_qosSupported)
+    {
+      return;
+    }
+  for (EdcaQueues::const_iterator i = m_edca.begin (); i != m_edca.end (); i++)
+    {
+      Ptr<MsduStandardAggregator> aggregator = CreateObject<MsduStandardAggregator> ();
+      aggregator->SetAttribute ("MaxAmsduSize", UintegerValue (m_maxAggregateSize));
+      i->second->SetMsduAggregator (aggregator);
+      i->second->SetBlockAckThreshold (m_blockAckThreshold);
+    }
+}
+
+void
+ApVlcMac::SetFairQueueingQuantum (Time quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_fairQueueingQuantum = quantum;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_fairQueues[i].SetQuantum (quantum);
+    }
+}
+
 void
 ApVlcMac::Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to, Mac48Address from)
 {
@@ -272,6 +610,10 @@ ApVlcMac::Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to, Mac48Address f
     {
       ForwardDown (packet_vlc, from, to);
     }
+  else
+    {
+      NotifyTxDrop (packet_vlc);
+    }
 }
 
 void
@@ -284,6 +626,65 @@ ApVlcMac::Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to)
   Enqueue (packet_vlc, to, m_low->GetAddress ());
 }
 
+void
+ApVlcMac::EnqueueBatch (const VlcMac::PacketBatch &packets)
+{
+  NS_LOG_FUNCTION (this << packets.size ());
+  Mac48Address from = m_low->GetAddress ();
+  // The AP relays bursts to many stations: look the headers up in a map
+  // keyed by destination and TID rather than scanning them.
+  std::map<std::pair<Mac48Address, uint8_t>, WifiMacHeader> headers;
+  FrameList frames[4];
+  for (VlcMac::PacketBatch::const_iterator i = packets.begin (); i != packets.end (); i++)
+    {
+      Mac48Address to = i->second;
+      if (!to.IsBroadcast () && !m_stationManager->IsAssociated (to))
+        {
+          NotifyTxDrop (i->first);
+          continue;
+        }
+      uint8_t tid = 0;
+      if (m_qosSupported)
+        {
+          tid = QosUtilsGetTidForPacket (i->first);
+          // Same as ForwardDown: no valid QoS tag means AC_BE
+          if (tid >= 7)
+            {
+              tid = 0;
+            }
+        }
+      std::pair<Mac48Address, uint8_t> key = std::make_pair (to, tid);
+      std::map<std::pair<Mac48Address, uint8_t>, WifiMacHeader>::iterator header = headers.find (key);
+      if (header == headers.end ())
+        {
+          header = headers.insert (std::make_pair (key, GetForwardHeader (from, to, tid))).first;
+        }
+      frames[m_qosSupported ? QosUtilsMapTidToAc (tid) : AC_BE].push_back (std::make_pair (i->first, header->second));
+    }
+  for (uint32_t ac = 0; ac < 4; ac++)
+    {
+      if (!frames[ac].empty ())
+        {
+          QueueData (frames[ac], static_cast<enum AcIndex> (ac));
+        }
+    }
+}
+
+uint32_t
+ApVlcMac::GetTxQueueSize (void) const
+{
+  uint32_t size = m_dca->GetQueue ()->GetSize ();
+  for (EdcaQueues::const_iterator i = m_edca.begin (); i != m_edca.end (); i++)
+    {
+      size += i->second->GetQueue ()->GetSize ();
+    }
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      size += m_fairQueues[i].GetNPackets () + m_aggregationBuffers[i].frames.size ();
+    }
+  return size;
+}
+
 bool
 ApVlcMac::SupportsSendFrom (void) const
 {
@@ -406,6 +807,35 @@ ApVlcMac::SendAssocResp (Mac48Address to, bool success)
   m_dca->Queue (packet_vlc, hdr);
 }
 
+Ptr<const Packet>
+ApVlcMac::GetBeaconTemplate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_beaconTemplate != 0
+      && m_beaconTemplateNModes == m_phy->GetNModes ()
+      && m_beaconTemplateNBasicModes == m_stationManager->GetNBasicModes ())
+    {
+      return m_beaconTemplate;
+    }
+  NS_LOG_DEBUG ("building beacon template");
+  MgtBeaconHeader beacon;
+  beacon.SetSsid (GetSsid ());
+  beacon.SetSupportedRates (GetSupportedRates ());
+  beacon.SetBeaconIntervalUs (m_beaconInterval.GetMicroSeconds ());
+  if (m_htSupported)
+    {
+      beacon.SetHtCapabilities (GetHtCapabilities());
+    }
+  m_beaconTemplate = Create<Packet> ();
+  m_beaconTemplate->AddHeader (beacon);
+  // The timestamp, the first field of the body, is written by
+  // SendOneBeacon for each beacon
+  m_beaconTemplate->RemoveAtStart (8);
+  m_beaconTemplateNModes = m_phy->GetNModes ();
+  m_beaconTemplateNBasicModes = m_stationManager->GetNBasicModes ();
+  return m_beaconTemplate;
+}
+
 void
 ApVlcMac::SendOneBeacon (void)
 {
@@ -417,34 +847,140 @@ ApVlcMac::SendOneBeacon (void)
   hdr.SetAddr3 (GetAddress ());
   hdr.SetDsNotFrom ();
   hdr.SetDsNotTo ();
-  Ptr<Packet> packet = Create<Packet> ();
-  MgtBeaconHeader beacon;
-  beacon.SetSsid (GetSsid ());
-  beacon.SetSupportedRates (GetSupportedRates ());
-  beacon.SetBeaconIntervalUs (m_beaconInterval.GetMicroSeconds ());
   if (m_htSupported)
     {
-      beacon.SetHtCapabilities (GetHtCapabilities());
       hdr.SetNoOrder();
     }
-  packet->AddHeader (beacon);
+  uint64_t now = Simulator::Now ().GetMicroSeconds ();
+  uint8_t timestamp[8];
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      timestamp[i] = (now >> (8 * i)) & 0xff;
+    }
+  Ptr<Packet> packet = Create<Packet> (timestamp, 8);
+  packet->AddAtEnd (GetBeaconTemplate ());
+  if (m_enableSuperframe)
+    {
+      Ptr<Packet> superframe = Create<Packet> ();
+      AddSuperframeHeader (superframe);
+      packet->AddAtEnd (superframe);
+    }
 
   // The beacon has it's own special queue, so we load it in there
   m_beaconDca->Queue (packet, hdr);
-  m_beaconEvent = Simulator::Schedule (m_beaconInterval, &ApVlcMac::SendOneBeacon, this);
+  if (m_beaconSchedulerRegistered)
+    {
+      m_lastBeacon = Simulator::Now ();
+    }
+  else
+    {
+      m_beaconEvent = Simulator::Schedule (m_beaconInterval, &ApVlcMac::SendOneBeacon, this);
+    }
+}
+
+void
+ApVlcMac::ScheduleBeacons (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  if (m_shareBeaconScheduler)
+    {
+      NS_ASSERT (!m_beaconSchedulerRegistered);
+      VlcBeaconScheduler *scheduler = VlcBeaconScheduler::Get ();
+      scheduler->SetTick (m_beaconSchedulerTick);
+      m_beaconSchedulerId = scheduler->Add (m_beaconInterval, delay,
+                                            MakeCallback (&ApVlcMac::SendOneBeacon, this));
+      m_beaconSchedulerInterval = m_beaconInterval;
+      m_lastBeacon = Simulator::Now () + delay - m_beaconInterval;
+      m_beaconSchedulerRegistered = true;
+    }
+  else
+    {
+      m_beaconEvent = Simulator::Schedule (delay, &ApVlcMac::SendOneBeacon, this);
+    }
+}
+
+void
+ApVlcMac::CancelBeacons (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_beaconEvent.Cancel ();
+  if (m_beaconSchedulerRegistered)
+    {
+      VlcBeaconScheduler::Get ()->Remove (m_beaconSchedulerInterval, m_beaconSchedulerId);
+      m_beaconSchedulerRegistered = false;
+    }
+}
+
+void
+ApVlcMac::AddSuperframeHeader (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  PruneGtsStations ();
+  VlcSuperframeHeader superframe;
+  superframe.SetFinalCapSlot (m_finalCapSlot);
+  uint32_t cfpSlots = VlcSuperframeHeader::NUM_SLOTS - m_finalCapSlot - 1;
+  uint32_t nGts = std::min (m_maxGts, std::min<uint32_t> (cfpSlots, m_gtsStations.size ()));
+  uint8_t slot = m_finalCapSlot + 1;
+  GtsStations::const_iterator sta = m_gtsStations.lower_bound (m_nextGtsStation);
+  for (uint32_t i = 0; i < nGts; i++)
+    {
+      if (sta == m_gtsStations.end ())
+        {
+          sta = m_gtsStations.begin ();
+        }
+      // The first GTS get the slots left over by the integer division
+      uint8_t length = cfpSlots / nGts + (i < cfpSlots % nGts ? 1 : 0);
+      superframe.AddGts (sta->first, slot, length);
+      slot += length;
+      sta++;
+    }
+  if (!m_gtsStations.empty ())
+    {
+      m_nextGtsStation = sta == m_gtsStations.end () ? m_gtsStations.begin ()->first : sta->first;
+    }
+  NS_LOG_DEBUG ("superframe " << superframe);
+  packet->AddHeader (superframe);
+}
+
+void
+ApVlcMac::RefreshGtsStation (Mac48Address address)
+{
+  m_gtsStations[address] = Simulator::Now ();
+}
+
+void
+ApVlcMac::PruneGtsStations (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  GtsStations::iterator i = m_gtsStations.begin ();
+  while (i != m_gtsStations.end ())
+    {
+      if (!m_stationManager->IsAssociated (i->first)
+          || (m_gtsTimeout.IsStrictlyPositive () && now - i->second > m_gtsTimeout))
+        {
+          NS_LOG_DEBUG ("withdrawing the GTS of sta=" << i->first);
+          m_gtsStations.erase (i++);
+        }
+      else
+        {
+          i++;
+        }
+    }
 }
 
 void
 ApVlcMac::TxOk (const WifiMacHeader &hdr)
 {
   NS_LOG_FUNCTION (this);
-  RegularWifiMac::TxOk (hdr);
+  VlcMac::TxOk (hdr);
 
   if (hdr.IsAssocResp ()
       && m_stationManager->IsWaitAssocTxOk (hdr.GetAddr1 ()))
     {
       NS_LOG_DEBUG ("associated with sta=" << hdr.GetAddr1 ());
       m_stationManager->RecordGotAssocTxOk (hdr.GetAddr1 ());
+      RefreshGtsStation (hdr.GetAddr1 ());
     }
 }
 
@@ -452,7 +988,7 @@ void
 ApVlcMac::TxFailed (const WifiMacHeader &hdr)
 {
   NS_LOG_FUNCTION (this);
-  RegularWifiMac::TxFailed (hdr);
+  VlcMac::TxFailed (hdr);
 
   if (hdr.IsAssocResp ()
       && m_stationManager->IsWaitAssocTxOk (hdr.GetAddr1 ()))
@@ -462,6 +998,22 @@ ApVlcMac::TxFailed (const WifiMacHeader &hdr)
     }
 }
 
+void
+ApVlcMac::NotifyTxQueueDrain (void)
+{
+  if (m_enableFairQueueing)
+    {
+      for (uint32_t ac = 0; ac < 4; ac++)
+        {
+          if (m_fairQueues[ac].GetNPackets () > 0)
+            {
+              FeedTxQueue (static_cast<enum AcIndex> (ac));
+            }
+        }
+    }
+  VlcMac::NotifyTxQueueDrain ();
+}
+
 void
 ApVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
 {
@@ -477,6 +1029,10 @@ ApVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
           && bssid == GetAddress ()
           && m_stationManager->IsAssociated (from))
         {
+          if (m_enableSuperframe)
+            {
+              RefreshGtsStation (from);
+            }
           Mac48Address to = hdr->GetAddr3 ();
           if (to == GetAddress ())
             {
@@ -620,6 +1176,16 @@ ApVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
           else if (hdr->IsDisassociation ())
             {
               m_stationManager->RecordDisassociated (from);
+              m_gtsStations.erase (from);
+              std::vector<Ptr<const Packet> > dropped;
+              for (uint32_t i = 0; i < 4; i++)
+                {
+                  m_fairQueues[i].RemoveStation (from, dropped);
+                }
+              for (std::vector<Ptr<const Packet> >::const_iterator i = dropped.begin (); i != dropped.end (); i++)
+                {
+                  NotifyTxDrop (*i);
+                }
               return;
             }
         }
@@ -628,7 +1194,7 @@ ApVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
   // Invoke the receive handler of our parent class to deal with any
   // other frames. Specifically, this will handle Block Ack-related
   // Management Action frames.
-  RegularWifiMac::Receive (packet_vlc, hdr);
+  VlcMac::Receive (packet_vlc, hdr);
 }
 
 void
@@ -636,25 +1202,57 @@ ApVlcMac::DeaggregateAmsduAndForward (Ptr<Packet> aggregatedPacket,
                                        const WifiMacHeader *hdr)
 {
   NS_LOG_FUNCTION (this << aggregatedPacket << hdr);
-  MsduAggregator::DeaggregatedMsdus packets =
-    MsduAggregator::Deaggregate (aggregatedPacket);
+  // Find the MSDUs by walking the subframe headers on a copy of the
+  // aggregate (which only moves its start), then cut the MSDUs out of the
+  // aggregate as fragments sharing its buffer.
+  std::vector<AmsduFragment> fragments;
+  Ptr<Packet> cursor = aggregatedPacket->Copy ();
+  uint32_t size = aggregatedPacket->GetSize ();
+  uint32_t offset = 0;
+  AmsduSubframeHeader subframe;
+  while (size - offset >= subframe.GetSerializedSize ())
+    {
+      offset += cursor->RemoveHeader (subframe);
+      AmsduFragment fragment;
+      fragment.offset = offset;
+      fragment.length = subframe.GetLength ();
+      fragment.source = subframe.GetSourceAddr ();
+      fragment.destination = subframe.GetDestinationAddr ();
+      if (fragment.length > size - offset)
+        {
+          NS_LOG_DEBUG ("truncated A-MSDU subframe");
+          break;
+        }
+      fragments.push_back (fragment);
+      // Subframes are padded to a multiple of 4 bytes, except the last one
+      uint32_t padding = (4 - ((fragment.length + subframe.GetSerializedSize ()) % 4)) % 4;
+      uint32_t skip = std::min (fragment.length + padding, size - offset);
+      cursor->RemoveAtStart (skip);
+      offset += skip;
+    }
 
-  for (MsduAggregator::DeaggregatedMsdusCI i = packets.begin ();
-       i != packets.end (); ++i)
+  uint8_t tid = hdr->GetQosTid ();
+  FrameList down;
+  for (std::vector<AmsduFragment>::const_iterator i = fragments.begin ();
+       i != fragments.end (); ++i)
     {
-      if ((*i).second.GetDestinationAddr () == GetAddress ())
+      Ptr<Packet> msdu = aggregatedPacket->CreateFragment (i->offset, i->length);
+      if (i->destination == GetAddress ())
         {
-          ForwardUp ((*i).first, (*i).second.GetSourceAddr (),
-                     (*i).second.GetDestinationAddr ());
+          ForwardUp (msdu, i->source, i->destination);
         }
       else
         {
-          Mac48Address from = (*i).second.GetSourceAddr ();
-          Mac48Address to = (*i).second.GetDestinationAddr ();
-          NS_LOG_DEBUG ("forwarding QoS frame from=" << from << ", to=" << to);
-          ForwardDown ((*i).first, from, to, hdr->GetQosTid ());
+          NS_LOG_DEBUG ("forwarding QoS frame from=" << i->source << ", to=" << i->destination);
+          down.push_back (std::make_pair (Ptr<const Packet> (msdu),
+                                          GetForwardHeader (i->source, i->destination, tid)));
         }
     }
+  // The MSDUs relayed to other stations enter the queues together
+  if (!down.empty ())
+    {
+      QueueData (down, QosUtilsMapTidToAc (tid));
+    }
 }
 
 void
@@ -662,22 +1260,23 @@ ApVlcMac::DoInitialize (void)
 {
   NS_LOG_FUNCTION (this);
   m_beaconDca->Initialize ();
-  m_beaconEvent.Cancel ();
+  SetupAggregation ();
+  CancelBeacons ();
   if (m_enableBeaconGeneration)
     {
       if (m_enableBeaconJitter)
         {
           int64_t jitter = m_beaconJitter->GetValue (0, m_beaconInterval.GetMicroSeconds ());
           NS_LOG_DEBUG ("Scheduling initial beacon for access point " << GetAddress() << " at time " << jitter << " microseconds");
-          m_beaconEvent = Simulator::Schedule (MicroSeconds (jitter), &ApVlcMac::SendOneBeacon, this);
+          ScheduleBeacons (MicroSeconds (jitter));
         }
       else
         {
           NS_LOG_DEBUG ("Scheduling initial beacon for access point " << GetAddress() << " at time 0");
-          m_beaconEvent = Simulator::ScheduleNow (&ApVlcMac::SendOneBeacon, this);
+          ScheduleBeacons (Seconds (0));
         }
     }
-  RegularWifiMac::DoInitialize ();
+  VlcMac::DoInitialize ();
 }
 
 } // namespace ns3
@@ -19,14 +19,16 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  * Author: Mirko Banchi <mk.banchi@gmail.com>
  */
-#ifndef AP_WIFI_MAC_H
-#define AP_WIFI_MAC_H
+#ifndef AP_VLC_MAC_H
+#define AP_VLC_MAC_H
 
-#include "ns3/regular-wifi-mac.h"
 #include "ns3/ht-capabilities.h"
 #include "ns3/amsdu-subframe-header.h"
 #include "ns3/supported-rates.h"
 #include "ns3/random-variable-stream.h"
+#include "vlc-drr-queue.h"
+#include <map>
+#include "vlc-mac.h"
 
 namespace ns3 {
 
@@ -37,7 +39,7 @@ namespace ns3 {
  * Handle association, dis-association and authentication,
  * of STAs within an infrastructure BSS.
  */
-class ApVlcMac : public RegularWifiMac
+class ApVlcMac : public VlcMac
 {
 public:
   static TypeId GetTypeId (void);
@@ -54,6 +56,22 @@ public:
    * \param linkUp the callback to invoke when the link becomes up.
    */
   virtual void SetLinkUpCallback (Callback<void> linkUp);
+  /**
+   * \param ssid the current SSID of this MAC layer.
+   */
+  virtual void SetSsid (Ssid ssid);
+  /**
+   * \param phy the physical layer attached to this MAC.
+   */
+  virtual void SetWifiPhy (Ptr<WifiPhy> phy);
+  /**
+   * Discard the cached beacon so that the next one is built again. This
+   * is done automatically when the SSID, the beacon interval, the PHY, the
+   * station manager or the number of supported or basic modes change,
+   * but must be called explicitly after changing the HT capabilities of
+   * the PHY (LDPC, guard interval, greenfield) during the simulation.
+   */
+  void InvalidateBeaconTemplate (void);
 
   /**
    * \param packet the packet to send.
@@ -77,6 +95,19 @@ public:
    * frames without altering the source address.
    */
   virtual void Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to, Mac48Address from);
+  /**
+   * \param packets the packets to send with their destinations.
+   *
+   * Enqueue a burst of packets, building the MAC header once per
+   * destination and TID and handing the packets of each access category
+   * over to the queues at once.
+   */
+  virtual void EnqueueBatch (const VlcMac::PacketBatch &packets);
+  /**
+   * \return the number of frames waiting in the DCF/EDCAF queues, the
+   *         per-station queues and the aggregation buffers.
+   */
+  virtual uint32_t GetTxQueueSize (void) const;
   virtual bool SupportsSendFrom (void) const;
 
   /**
@@ -95,6 +126,14 @@ public:
    * Start beacon transmission immediately.
    */
   void StartBeaconing (void);
+  /**
+   * Record the given STA as associated without any exchange of frames,
+   * see StaVlcMac::SetStaticAssociation. The STA is assumed to support
+   * all our modes.
+   *
+   * \param address the address of the STA
+   */
+  void AddStaticStation (Mac48Address address);
 
  /**
   * Assign a fixed random variable stream number to the random variables
@@ -126,6 +165,13 @@ private:
    * \param hdr the header of the packet that we failed to sent
    */
   virtual void TxFailed (const WifiMacHeader &hdr);
+  /**
+   * Feed the DCF/EDCAF queues which became empty from the per-station
+   * queues, whichever way their frames left: data or management frames
+   * acknowledged or dropped, frames sent without an ACK, frames
+   * acknowledged by a block ack or dropped at the end of their lifetime.
+   */
+  virtual void NotifyTxQueueDrain (void);
 
   /**
    * This method is called to de-aggregate an A-MSDU and forward the
@@ -138,6 +184,16 @@ private:
    */
   virtual void DeaggregateAmsduAndForward (Ptr<Packet> aggregatedPacket,
                                            const WifiMacHeader *hdr);
+  /**
+   * The position of an MSDU in an A-MSDU.
+   */
+  struct AmsduFragment
+  {
+    uint32_t offset; //!< Offset of the MSDU in the A-MSDU
+    uint32_t length; //!< Length of the MSDU
+    Mac48Address source; //!< Source address of the MSDU
+    Mac48Address destination; //!< Destination address of the MSDU
+  };
 
   /**
    * Forward the packet down to DCF/EDCAF (enqueue the packet). This method
@@ -157,6 +213,88 @@ private:
    * \param tid the traffic id for the packet
    */
   void ForwardDown (Ptr<const Packet> packet_vlc, Mac48Address from, Mac48Address to, uint8_t tid);
+  /**
+   * \param from the address to be used for Address 3 field in the header
+   * \param to the address to be used for Address 1 field in the header
+   * \param tid the traffic id for the packet
+   * \return the MAC header of a frame forwarded down
+   */
+  WifiMacHeader GetForwardHeader (Mac48Address from, Mac48Address to, uint8_t tid) const;
+  /**
+   * A list of data frames with their MAC headers.
+   */
+  typedef std::vector<std::pair<Ptr<const Packet>, WifiMacHeader> > FrameList;
+  /**
+   * Hand several data frames of the same access category over to the
+   * DCF/EDCAF at once, see QueueData.
+   *
+   * \param frames the frames to send
+   * \param ac the access category of the frames
+   */
+  void QueueData (const FrameList &frames, enum AcIndex ac);
+  /**
+   * Hand several data frames of the same access category over to the
+   * per-station queues or directly to the DCF/EDCAF, feeding the
+   * DCF/EDCAF from the per-station queues once for all of them.
+   *
+   * \param frames the frames to send
+   * \param ac the access category of the frames
+   */
+  void SendToTxQueue (const FrameList &frames, enum AcIndex ac);
+  /**
+   * Hand a data frame over to the DCF/EDCAF of the given access category,
+   * through the per-station queues if fair queueing is enabled.
+   *
+   * \param packet the packet to send
+   * \param hdr the MAC header of the packet
+   * \param ac the access category of the packet
+   */
+  void QueueData (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr, enum AcIndex ac);
+  /**
+   * Hand a data frame over to the per-station queues or directly to the
+   * DCF/EDCAF of the given access category.
+   *
+   * \param packet the packet to send
+   * \param hdr the MAC header of the packet
+   * \param ac the access category of the packet
+   */
+  void SendToTxQueue (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr, enum AcIndex ac);
+  /**
+   * Hand all the frames held for aggregation in the given access category
+   * over to the DCF/EDCAF.
+   *
+   * \param ac the access category
+   */
+  void FlushAggregationBuffer (enum AcIndex ac);
+  /**
+   * Move frames from the per-station queues of the given access category
+   * to its DCF/EDCAF queue, if that queue is empty: it is kept almost
+   * empty so that the scheduler decides which station is served next.
+   *
+   * \param ac the access category
+   */
+  void FeedTxQueue (enum AcIndex ac);
+  /**
+   * \param quantum the airtime credited to a station at each round of
+   *        the fair queueing scheduler
+   */
+  void SetFairQueueingQuantum (Time quantum);
+  /**
+   * Install an A-MSDU aggregator and the block ack threshold on the
+   * EDCAFs if aggregation is enabled.
+   */
+  void SetupAggregation (void);
+
+  /**
+   * Data frames held in one access category until an aggregate is full
+   * or the oldest frame is MaxAggregateAge old.
+   */
+  struct AggregationBuffer
+  {
+    FrameList frames; //!< The held frames
+    uint32_t bytes; //!< The size of the held frames
+    EventId flushEvent; //!< Flush when the oldest frame reaches its maximum age
+  };
   /**
    * Forward a probe response packet to the DCF. The standard is not clear on the correct
    * queue for management frames if QoS is supported. We always use the DCF.
@@ -176,6 +314,50 @@ private:
    * Forward a beacon packet to the beacon special DCF.
    */
   void SendOneBeacon (void);
+  /**
+   * Schedule the beacons, the first one after the given delay. With
+   * ShareBeaconScheduler, the AP registers with the VlcBeaconScheduler
+   * instead of scheduling its own events.
+   *
+   * \param delay the delay until the first beacon
+   */
+  void ScheduleBeacons (Time delay);
+  /**
+   * Cancel the beacons scheduled by ScheduleBeacons.
+   */
+  void CancelBeacons (void);
+  /**
+   * Return the serialized beacon body, building it first if the cached
+   * one is missing or out of date. The beacon interval, SSID, supported
+   * rates and HT capabilities rarely change, so the beacon is not
+   * rebuilt every beacon interval.
+   *
+   * \return the beacon body without its leading 8-byte timestamp, which
+   *         the caller writes for each beacon
+   */
+  Ptr<const Packet> GetBeaconTemplate (void);
+  /**
+   * Allocate the GTS of the next superframe and add the superframe
+   * specification to the given packet, which the caller then appends
+   * to a copy of the beacon template. The contention free period is
+   * split evenly between up to MaxGts active STAs; when more STAs are
+   * active, the allocation rotates from one superframe to the next.
+   *
+   * \param packet the packet which receives the superframe specification
+   */
+  void AddSuperframeHeader (Ptr<Packet> packet);
+  /**
+   * Make the given associated STA eligible for a GTS, or record that it
+   * is still active if it already is.
+   *
+   * \param address the address of the STA
+   */
+  void RefreshGtsStation (Mac48Address address);
+  /**
+   * Withdraw the GTS of the STAs which are no longer associated, and of
+   * those we received nothing from for GtsTimeout.
+   */
+  void PruneGtsStations (void);
   /**
    * Return the HT capability of the current AP.
    * 
@@ -210,8 +392,36 @@ private:
   EventId m_beaconEvent; //!< Event to generate one beacon
   Ptr<UniformRandomVariable> m_beaconJitter; //!< UniformRandomVariable used to randomize the time of the first beacon
   bool m_enableBeaconJitter; //!< Flag if the first beacon should be generated at random time
+  bool m_shareBeaconScheduler; //!< Flag if the beacons are sent by the shared VlcBeaconScheduler
+  bool m_beaconSchedulerRegistered; //!< Flag if the AP is registered with the VlcBeaconScheduler
+  uint32_t m_beaconSchedulerId; //!< Identifier of the registration with the VlcBeaconScheduler
+  Time m_beaconSchedulerInterval; //!< Beacon interval of the registration
+  Time m_beaconSchedulerTick; //!< Granularity of the phases of the VlcBeaconScheduler
+  Time m_lastBeacon; //!< Time of the last beacon sent through the VlcBeaconScheduler
+  Ptr<Packet> m_beaconTemplate; //!< The cached beacon body, without its timestamp
+  uint32_t m_beaconTemplateNModes; //!< Number of PHY modes when the template was built
+  uint32_t m_beaconTemplateNBasicModes; //!< Number of basic modes when the template was built
+  bool m_enableSuperframe; //!< Flag if the beacons carry a superframe specification
+  uint8_t m_finalCapSlot; //!< Last slot of the contention access period
+  uint32_t m_maxGts; //!< Maximum number of GTS per superframe
+  Time m_gtsTimeout; //!< Time after which a silent STA loses its GTS
+  /**
+   * typedef for the STAs eligible for a GTS, with the time we last
+   * received a frame from each of them
+   */
+  typedef std::map<Mac48Address, Time> GtsStations;
+  GtsStations m_gtsStations; //!< Active associated STAs eligible for a GTS
+  Mac48Address m_nextGtsStation; //!< The STA, or the first one after it, which gets the next first GTS
+  bool m_enableFairQueueing; //!< Flag if unicast data frames go through per-station queues
+  Time m_fairQueueingQuantum; //!< Airtime credited to a station at each round
+  VlcDrrQueue m_fairQueues[4]; //!< Per-station queues of each access category
+  bool m_enableAggregation; //!< Flag if downlink QoS data frames are aggregated
+  uint32_t m_maxAggregateSize; //!< Maximum size of an A-MSDU
+  Time m_maxAggregateAge; //!< Maximum time a frame is held to fill an aggregate
+  uint8_t m_blockAckThreshold; //!< Number of queued frames which trigger a block ack agreement
+  AggregationBuffer m_aggregationBuffers[4]; //!< Held frames of each access category
 };
 
 } // namespace ns3
 
-#endif /* AP_WIFI_MAC_H */
+#endif /* AP_VLC_MAC_H */
@@ -26,6 +26,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/trace-source-accessor.h"
 
 #include "ns3/qos-tag.h"
@@ -38,6 +39,11 @@
 #include "ns3/amsdu-subframe-header.h"
 #include "ns3/mgt-headers.h"
 #include "ns3/ht-capabilities.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "ns3/dca-txop.h"
+#include "ns3/edca-txop-n.h"
+#include "ns3/wifi-mac-queue.h"
+#include "vlc-phy.h"
 
 NS_LOG_COMPONENT_DEFINE ("StavlcMac");
 
@@ -67,7 +73,7 @@ TypeId
 StaVlcMac::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::StaVlcMac")
-    .SetParent<RegularWifiMac> ()
+    .SetParent<VlcMac> ()
     .AddConstructor<StaVlcMac> ()
     .AddAttribute ("ProbeRequestTimeout", "The interval between two consecutive probe request attempts.",
                    TimeValue (Seconds (0.05)),
@@ -87,10 +93,36 @@ StaVlcMac::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&StaVlcMac::SetActiveProbing),
                    MakeBooleanChecker ())
+    .AddAttribute ("EnableHandover",
+                   "If true, the SNR of the beacons of all the APs in range is tracked and "
+                   "we re-associate with a better AP before missing MaxMissedBeacons beacons.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&StaVlcMac::m_enableHandover),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HandoverHysteresis",
+                   "The margin, in dB, by which the SNR of another AP must exceed the SNR "
+                   "of our AP for the other AP to become a handover candidate.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&StaVlcMac::m_handoverHysteresis),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("HandoverTimeToTrigger",
+                   "The time a candidate must remain better than our AP before the handover.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&StaVlcMac::m_handoverTimeToTrigger),
+                   MakeTimeChecker ())
+    .AddAttribute ("ApTableTimeout",
+                   "The time after which an AP whose beacons we do not hear anymore is "
+                   "not considered for handover, and our own AP loses to any candidate.",
+                   TimeValue (MilliSeconds (300)),
+                   MakeTimeAccessor (&StaVlcMac::m_apTableTimeout),
+                   MakeTimeChecker ())
     .AddTraceSource ("Assoc", "Associated with an access point.",
                      MakeTraceSourceAccessor (&StaVlcMac::m_assocLogger))
     .AddTraceSource ("DeAssoc", "Association with an access point lost.",
                      MakeTraceSourceAccessor (&StaVlcMac::m_deAssocLogger))
+    .AddTraceSource ("Handover", "Associated again after losing the association: the old "
+                     "access point, the new one and the time spent without association.",
+                     MakeTraceSourceAccessor (&StaVlcMac::m_handoverLogger))
   ;
   return tid;
 }
@@ -99,7 +131,11 @@ StaVlcMac::StaVlcMac ()
   : m_state (BEACON_MISSED),
     m_probeRequestEvent (),
     m_assocRequestEvent (),
-    m_beaconWatchdogEnd (Seconds (0.0))
+    m_beaconWatchdogEnd (Seconds (0.0)),
+    m_staticAssociation (false),
+    m_linkLost (false),
+    m_superframe (false),
+    m_txWindowOpen (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -141,11 +177,171 @@ StaVlcMac::StartActiveAssociation (void)
   TryToEnsureAssociated ();
 }
 
+void
+StaVlcMac::SetStaticAssociation (Mac48Address bssid)
+{
+  NS_LOG_FUNCTION (this << bssid);
+  m_probeRequestEvent.Cancel ();
+  m_assocRequestEvent.Cancel ();
+  m_beaconWatchdog.Cancel ();
+  m_staticAssociation = true;
+  SetBssid (bssid);
+  for (uint32_t i = 0; i < m_phy->GetNModes (); i++)
+    {
+      m_stationManager->AddSupportedMode (bssid, m_phy->GetMode (i));
+    }
+  if (m_htSupported)
+    {
+      for (uint32_t i = 0; i < m_phy->GetNMcs (); i++)
+        {
+          m_stationManager->AddSupportedMcs (bssid, m_phy->GetMcs (i));
+        }
+    }
+  SetState (ASSOCIATED);
+  if (!m_linkUp.IsNull ())
+    {
+      m_linkUp ();
+    }
+}
+
+void
+StaVlcMac::SetWifiPhy (Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  VlcMac::SetWifiPhy (phy);
+  phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeCallback (&StaVlcMac::SniffRx, this));
+}
+
+void
+StaVlcMac::SniffRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                    uint32_t rate, bool isShortPreamble, double signalDbm, double noiseDbm)
+{
+  if (!m_enableHandover)
+    {
+      return;
+    }
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (!hdr.IsBeacon ())
+    {
+      return;
+    }
+  if (!GetSsid ().IsBroadcast ())
+    {
+      Ptr<Packet> copy = packet->Copy ();
+      copy->RemoveHeader (hdr);
+      MgtBeaconHeader beacon;
+      copy->PeekHeader (beacon);
+      if (!beacon.GetSsid ().IsEqual (GetSsid ()))
+        {
+          return;
+        }
+    }
+
+  Time now = Simulator::Now ();
+  double snr = signalDbm - noiseDbm;
+  // Forget the APs we have not heard for a while, so that the table only
+  // holds the APs in sight and not every AP we ever passed by.
+  std::vector<ApInfo>::iterator ap = m_apTable.begin ();
+  while (ap != m_apTable.end ())
+    {
+      if (now - ap->lastSeen > m_apTableTimeout)
+        {
+          ap = m_apTable.erase (ap);
+        }
+      else
+        {
+          ap++;
+        }
+    }
+  ap = m_apTable.begin ();
+  while (ap != m_apTable.end () && ap->bssid != hdr.GetAddr3 ())
+    {
+      ap++;
+    }
+  if (ap == m_apTable.end ())
+    {
+      ApInfo info;
+      info.bssid = hdr.GetAddr3 ();
+      info.snr = snr;
+      info.betterSince = Seconds (0);
+      ap = m_apTable.insert (m_apTable.end (), info);
+    }
+  else
+    {
+      // Smooth out the fading of single beacons
+      ap->snr = 0.75 * ap->snr + 0.25 * snr;
+    }
+  ap->lastSeen = now;
+
+  if (!IsAssociated () || m_handoverEvent.IsRunning ())
+    {
+      return;
+    }
+  // Our AP, if we still hear it
+  double currentSnr = -1e9;
+  for (std::vector<ApInfo>::const_iterator i = m_apTable.begin (); i != m_apTable.end (); i++)
+    {
+      if (i->bssid == GetBssid ())
+        {
+          currentSnr = i->snr;
+        }
+    }
+  std::vector<ApInfo>::iterator best = m_apTable.end ();
+  for (std::vector<ApInfo>::iterator i = m_apTable.begin (); i != m_apTable.end (); i++)
+    {
+      if (i->bssid == GetBssid ())
+        {
+          continue;
+        }
+      if (i->snr < currentSnr + m_handoverHysteresis)
+        {
+          i->betterSince = Seconds (0);
+          continue;
+        }
+      if (i->betterSince.IsZero ())
+        {
+          i->betterSince = now;
+        }
+      if (now - i->betterSince >= m_handoverTimeToTrigger
+          && (best == m_apTable.end () || i->snr > best->snr))
+        {
+          best = i;
+        }
+    }
+  if (best != m_apTable.end ())
+    {
+      NS_LOG_DEBUG ("handover from " << GetBssid () << " to " << best->bssid);
+      best->betterSince = Seconds (0);
+      // We are called by the PHY in the middle of the reception
+      m_handoverEvent = Simulator::ScheduleNow (&StaVlcMac::StartHandover, this, best->bssid);
+    }
+}
+
+void
+StaVlcMac::StartHandover (Mac48Address bssid)
+{
+  NS_LOG_FUNCTION (this << bssid);
+  if (!IsAssociated ())
+    {
+      return;
+    }
+  // The watchdog keeps running: if the new AP does not answer, we fall
+  // back to the normal association sequence when it fires.
+  m_linkDown ();
+  // Let the old AP free the resources it keeps for us (GTS, fair queue)
+  // instead of waiting for them to time out.
+  SendDisassociation (GetBssid ());
+  SetState (WAIT_ASSOC_RESP);
+  SetBssid (bssid);
+  SendAssociationRequest ();
+}
+
 void
 StaVlcMac::SetActiveProbing (bool enable)
 {
   NS_LOG_FUNCTION (this << enable);
-  if (enable)
+  if (enable && !m_staticAssociation)
     {
       Simulator::ScheduleNow (&StaVlcMac::TryToEnsureAssociated, this);
     }
@@ -192,6 +388,21 @@ StaVlcMac::SendProbeRequest (void)
                                              &StaVlcMac::ProbeRequestTimeout, this);
 }
 
+void
+StaVlcMac::SendDisassociation (Mac48Address bssid)
+{
+  NS_LOG_FUNCTION (this << bssid);
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_MGT_DISASSOCIATION);
+  hdr.SetAddr1 (bssid);
+  hdr.SetAddr2 (GetAddress ());
+  hdr.SetAddr3 (bssid);
+  hdr.SetDsNotFrom ();
+  hdr.SetDsNotTo ();
+  Ptr<Packet> packet_vlc = Create<Packet> ();
+  m_dca->Queue (packet_vlc, hdr);
+}
+
 void
 StaVlcMac::SendAssociationRequest (void)
 {
@@ -340,12 +551,96 @@ StaVlcMac::Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to)
       TryToEnsureAssociated ();
       return;
     }
-  WifiMacHeader hdr;
+  WifiMacHeader hdr = GetDataHeader (to, GetTid (packet_vlc));
+
+  if (m_superframe)
+    {
+      // In a beacon-enabled BSS, we only transmit in our window
+      HoldFrame (packet_vlc, hdr);
+      ReleaseHeldFrames ();
+      return;
+    }
+  QueueData (packet_vlc, hdr);
+}
 
+void
+StaVlcMac::EnqueueBatch (const VlcMac::PacketBatch &packets)
+{
+  NS_LOG_FUNCTION (this << packets.size ());
+  if (!IsAssociated ())
+    {
+      for (VlcMac::PacketBatch::const_iterator i = packets.begin (); i != packets.end (); i++)
+        {
+          NotifyTxDrop (i->first);
+        }
+      TryToEnsureAssociated ();
+      return;
+    }
+  // A burst usually goes to one or a few destinations with one TID
+  std::vector<std::pair<std::pair<Mac48Address, uint8_t>, WifiMacHeader> > headers;
+  for (VlcMac::PacketBatch::const_iterator i = packets.begin (); i != packets.end (); i++)
+    {
+      std::pair<Mac48Address, uint8_t> key = std::make_pair (i->second, GetTid (i->first));
+      uint32_t j = 0;
+      while (j < headers.size () && headers[j].first != key)
+        {
+          j++;
+        }
+      if (j == headers.size ())
+        {
+          headers.push_back (std::make_pair (key, GetDataHeader (key.first, key.second)));
+        }
+      if (m_superframe)
+        {
+          HoldFrame (i->first, headers[j].second);
+        }
+      else
+        {
+          QueueData (i->first, headers[j].second);
+        }
+    }
+  if (m_superframe)
+    {
+      ReleaseHeldFrames ();
+    }
+}
+
+uint32_t
+StaVlcMac::GetTxQueueSize (void) const
+{
+  uint32_t size = m_dca->GetQueue ()->GetSize () + m_heldFrames.size ();
+  for (EdcaQueues::const_iterator i = m_edca.begin (); i != m_edca.end (); i++)
+    {
+      size += i->second->GetQueue ()->GetSize ();
+    }
+  return size;
+}
+
+uint8_t
+StaVlcMac::GetTid (Ptr<const Packet> packet_vlc) const
+{
   // If we are not a QoS AP then we definitely want to use AC_BE to
   // transmit the packet. A TID of zero will map to AC_BE (through \c
   // QosUtilsMapTidToAc()), so we use that as our default here.
   uint8_t tid = 0;
+  if (m_qosSupported)
+    {
+      tid = QosUtilsGetTidForPacket (packet_vlc);
+      // Any value greater than 7 is invalid and likely indicates that
+      // the packet had no QoS tag, so we revert to zero, which'll
+      // mean that AC_BE is used.
+      if (tid >= 7)
+        {
+          tid = 0;
+        }
+    }
+  return tid;
+}
+
+WifiMacHeader
+StaVlcMac::GetDataHeader (Mac48Address to, uint8_t tid) const
+{
+  WifiMacHeader hdr;
 
   // For now, an AP that supports QoS does not support non-QoS
   // associations, and vice versa. In future the AP model should
@@ -358,26 +653,19 @@ StaVlcMac::Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to)
       hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
       hdr.SetQosNoEosp ();
       hdr.SetQosNoAmsdu ();
-      // Transmission of multiple frames in the same TXOP is not
-      // supported for now
+      // In the frames of a STA the field requests a TXOP duration
+      // from a hybrid coordinator; none is requested. The TXOPs won
+      // by contention are still continued up to the TXOP limits of
+      // VlcMac.
       hdr.SetQosTxopLimit (0);
-
       // Fill in the QoS control field in the MAC header
-      tid = QosUtilsGetTidForPacket (packet_vlc);
-      // Any value greater than 7 is invalid and likely indicates that
-      // the packet had no QoS tag, so we revert to zero, which'll
-      // mean that AC_BE is used.
-      if (tid >= 7)
-        {
-          tid = 0;
-        }
       hdr.SetQosTid (tid);
     }
   else
     {
       hdr.SetTypeData ();
     }
-if (m_htSupported)
+  if (m_htSupported)
     {
       hdr.SetNoOrder();
     }
@@ -387,10 +675,17 @@ if (m_htSupported)
   hdr.SetAddr3 (to);
   hdr.SetDsNotFrom ();
   hdr.SetDsTo ();
+  return hdr;
+}
 
+void
+StaVlcMac::QueueData (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr)
+{
+  NS_LOG_FUNCTION (this << packet_vlc);
   if (m_qosSupported)
     {
       // Sanity check that the TID is valid
+      uint8_t tid = hdr.GetQosTid ();
       NS_ASSERT (tid < 8);
       m_edca[QosUtilsMapTidToAc (tid)]->Queue (packet_vlc, hdr);
     }
@@ -400,6 +695,142 @@ if (m_htSupported)
     }
 }
 
+void
+StaVlcMac::StartSuperframe (const VlcSuperframeHeader &superframe, uint64_t beaconIntervalUs)
+{
+  NS_LOG_FUNCTION (this << beaconIntervalUs);
+  uint64_t slotUs = beaconIntervalUs / VlcSuperframeHeader::NUM_SLOTS;
+  uint64_t startSlot;
+  uint64_t endSlot;
+  VlcSuperframeHeader::Gts gts;
+  if (superframe.FindGts (GetAddress (), gts))
+    {
+      startSlot = gts.startSlot;
+      endSlot = gts.startSlot + gts.length;
+    }
+  else
+    {
+      // The STAs without GTS contend during the CAP, which starts with
+      // the beacon
+      startSlot = 0;
+      endSlot = superframe.GetFinalCapSlot () + 1;
+    }
+  NS_LOG_DEBUG ("tx window: slots " << startSlot << " to " << endSlot);
+  m_superframe = true;
+  m_txWindowOpen = false;
+  m_txWindowStartEvent.Cancel ();
+  m_txWindowEndEvent.Cancel ();
+  m_txWindowEnd = Simulator::Now () + MicroSeconds (endSlot * slotUs);
+  m_txWindowStartEvent = Simulator::Schedule (MicroSeconds (startSlot * slotUs),
+                                              &StaVlcMac::OpenTxWindow, this);
+  m_txWindowEndEvent = Simulator::Schedule (MicroSeconds (endSlot * slotUs),
+                                            &StaVlcMac::CloseTxWindow, this);
+}
+
+void
+StaVlcMac::StopSuperframe (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_superframe = false;
+  m_txWindowOpen = false;
+  m_txWindowStartEvent.Cancel ();
+  m_txWindowEndEvent.Cancel ();
+  while (!m_heldFrames.empty ())
+    {
+      HeldFrame frame = m_heldFrames.front ();
+      m_heldFrames.pop_front ();
+      if (IsAssociated ())
+        {
+          QueueData (frame.packet, frame.hdr);
+        }
+      else
+        {
+          NotifyTxDrop (frame.packet);
+        }
+    }
+}
+
+void
+StaVlcMac::OpenTxWindow (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_txWindowOpen = true;
+  m_txWindowBusyUntil = Simulator::Now ();
+  ReleaseHeldFrames ();
+}
+
+void
+StaVlcMac::CloseTxWindow (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_txWindowOpen = false;
+}
+
+void
+StaVlcMac::HoldFrame (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr)
+{
+  NS_LOG_FUNCTION (this << packet_vlc);
+  ExpireHeldFrames ();
+  if (m_heldFrames.size () >= m_dca->GetQueue ()->GetMaxSize ())
+    {
+      NS_LOG_DEBUG ("too many held frames, dropping " << packet_vlc);
+      NotifyTxDrop (packet_vlc);
+      return;
+    }
+  HeldFrame frame;
+  frame.packet = packet_vlc;
+  frame.hdr = hdr;
+  frame.tstamp = Simulator::Now ();
+  m_heldFrames.push_back (frame);
+}
+
+void
+StaVlcMac::ExpireHeldFrames (void)
+{
+  Time lifetime = m_dca->GetQueue ()->GetMaxDelay ();
+  while (!m_heldFrames.empty ()
+         && Simulator::Now () - m_heldFrames.front ().tstamp > lifetime)
+    {
+      NS_LOG_DEBUG ("held frame expired " << m_heldFrames.front ().packet);
+      NotifyTxLifetimeDrop (m_heldFrames.front ().packet);
+      m_heldFrames.pop_front ();
+    }
+}
+
+void
+StaVlcMac::NotifyTxQueueDrain (void)
+{
+  ExpireHeldFrames ();
+  VlcMac::NotifyTxQueueDrain ();
+}
+
+void
+StaVlcMac::ReleaseHeldFrames (void)
+{
+  NS_LOG_FUNCTION (this);
+  ExpireHeldFrames ();
+  while (m_txWindowOpen && !m_heldFrames.empty ())
+    {
+      const HeldFrame &frame = m_heldFrames.front ();
+      uint32_t size = frame.packet->GetSize () + frame.hdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+      WifiTxVector txVector = m_stationManager->GetDataTxVector (frame.hdr.GetAddr1 (), &frame.hdr,
+                                                                 frame.packet, size);
+      Time duration = VlcPhy::CalculateTxDuration (size, txVector, WIFI_PREAMBLE_LONG);
+      Time start = std::max (m_txWindowBusyUntil, Simulator::Now ());
+      // A frame which does not fit in the rest of the window waits for
+      // the next one, unless the window is still unused: it would never
+      // fit and must not block the frames behind it.
+      if (start + duration > m_txWindowEnd
+          && m_txWindowBusyUntil > Simulator::Now ())
+        {
+          break;
+        }
+      m_txWindowBusyUntil = start + duration;
+      QueueData (frame.packet, frame.hdr);
+      m_heldFrames.pop_front ();
+    }
+}
+
 void
 StaVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
 {
@@ -487,12 +918,26 @@ StaVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
         {
           goodBeacon = false;
         }
-      if (goodBeacon)
+      if (goodBeacon && !m_staticAssociation)
         {
           Time delay = MicroSeconds (beacon.GetBeaconIntervalUs () * m_maxMissedBeacons);
           RestartBeaconWatchdog (delay);
           SetBssid (hdr->GetAddr3 ());
         }
+      if (goodBeacon && IsAssociated ())
+        {
+          // The superframe specification, if any, follows the beacon
+          if (packet_vlc->GetSize () > 0)
+            {
+              VlcSuperframeHeader superframe;
+              packet_vlc->RemoveHeader (superframe);
+              StartSuperframe (superframe, beacon.GetBeaconIntervalUs ());
+            }
+          else if (m_superframe)
+            {
+              StopSuperframe ();
+            }
+        }
       if (goodBeacon && m_state == BEACON_MISSED)
         {
           SetState (WAIT_ASSOC_RESP);
@@ -595,7 +1040,7 @@ StaVlcMac::Receive (Ptr<Packet> packet_vlc, const WifiMacHeader *hdr)
   // Invoke the receive handler of our parent class to deal with any
   // other frames. Specifically, this will handle Block Ack-related
   // Management Action frames.
-  RegularWifiMac::Receive (packet_vlc, hdr);
+  VlcMac::Receive (packet_vlc, hdr);
 }
 
 SupportedRates
@@ -637,13 +1082,25 @@ StaVlcMac::SetState (MacState value)
       && m_state != ASSOCIATED)
     {
       m_assocLogger (GetBssid ());
+      if (m_linkLost)
+        {
+          m_handoverLogger (m_lostBssid, GetBssid (), Simulator::Now () - m_linkLostAt);
+          m_linkLost = false;
+        }
     }
   else if (value != ASSOCIATED
            && m_state == ASSOCIATED)
     {
       m_deAssocLogger (GetBssid ());
+      m_linkLost = true;
+      m_lostBssid = GetBssid ();
+      m_linkLostAt = Simulator::Now ();
     }
   m_state = value;
+  if (value != ASSOCIATED && m_superframe)
+    {
+      StopSuperframe ();
+    }
 }
 
 } // namespace ns3
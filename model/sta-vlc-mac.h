@@ -19,10 +19,9 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  * Author: Mirko Banchi <mk.banchi@gmail.com>
  */
-#ifndef STA_WIFI_MAC_H
-#define STA_WIFI_MAC_H
+#ifndef STA_VLC_MAC_H
+#define STA_VLC_MAC_H
 
-#include "ns3/regular-wifi-mac.h"
 
 #include "ns3/event-id.h"
 #include "ns3/packet.h"
@@ -30,6 +29,10 @@
 
 #include "ns3/supported-rates.h"
 #include "ns3/amsdu-subframe-header.h"
+#include "vlc-superframe-header.h"
+#include "vlc-mac.h"
+#include <deque>
+#include <vector>
 
 namespace ns3  {
 
@@ -40,7 +43,7 @@ class MgtAddBaRequestHeader;
  *
  * The Wifi MAC high model for a non-AP STA in a BSS.
  */
-class StaVlcMac : public RegularWifiMac
+class StaVlcMac : public VlcMac
 {
 public:
   static TypeId GetTypeId (void);
@@ -57,6 +60,18 @@ public:
    * access is granted to this MAC.
    */
   virtual void Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to);
+  /**
+   * \param packets the packets to send with their destinations.
+   *
+   * Enqueue a burst of packets, building the MAC header once per
+   * destination and TID.
+   */
+  virtual void EnqueueBatch (const VlcMac::PacketBatch &packets);
+  /**
+   * \return the number of frames waiting in the DCF/EDCAF queues and
+   *         for our superframe transmission window.
+   */
+  virtual uint32_t GetTxQueueSize (void) const;
 
   /**
    * \param missed the number of beacons which must be missed
@@ -82,6 +97,25 @@ public:
    * Start an active association sequence immediately.
    */
   void StartActiveAssociation (void);
+  /**
+   * Associate with the given AP without any exchange of frames. The AP
+   * must be told about us with ApVlcMac::AddStaticStation and is assumed
+   * to support all our modes. The association is never lost: beacons
+   * are still processed, but missing them does not start a new
+   * association sequence. This must be called once the MAC is attached
+   * to its device.
+   *
+   * The STA enters the ASSOCIATED state as after an association
+   * response, so the Assoc trace source fires once with the address of
+   * the AP and the link of the device comes up.
+   *
+   * \param bssid the address of the AP
+   */
+  void SetStaticAssociation (Mac48Address bssid);
+  /**
+   * \param phy the physical layer attached to this MAC.
+   */
+  virtual void SetWifiPhy (Ptr<WifiPhy> phy);
 
 private:
   /**
@@ -120,6 +154,12 @@ private:
    * queue for management frames if QoS is supported. We always use the DCF.
    */
   void SendAssociationRequest (void);
+  /**
+   * Forward a disassociation frame for the given AP to the DCF.
+   *
+   * \param bssid the address of the AP we leave
+   */
+  void SendDisassociation (Mac48Address bssid);
   /**
    * Try to ensure that we are associated with an AP by taking an appropriate action
    * depending on the current association status.
@@ -177,6 +217,113 @@ private:
    * \return the HT capability that we support
    */
   HtCapabilities GetHtCapabilities (void) const;
+  /**
+   * \param to the final destination of the frame (Address 3)
+   * \param tid the traffic id of the frame, ignored without QoS
+   * \return the MAC header of a data frame sent to our AP
+   */
+  WifiMacHeader GetDataHeader (Mac48Address to, uint8_t tid) const;
+  /**
+   * \param packet_vlc a packet from the upper layers
+   * \return the TID of the packet, 0 if it has none or without QoS
+   */
+  uint8_t GetTid (Ptr<const Packet> packet_vlc) const;
+  /**
+   * Hand a data frame over to the DCF/EDCAF.
+   *
+   * \param packet the packet to send
+   * \param hdr the MAC header of the packet
+   */
+  void QueueData (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr);
+  /**
+   * Schedule our transmission window in the superframe started by the
+   * beacon we just received: our GTS if the AP allocated one to us, the
+   * contention access period otherwise.
+   *
+   * \param superframe the superframe specification of the beacon
+   * \param beaconIntervalUs the beacon interval in microseconds
+   */
+  void StartSuperframe (const VlcSuperframeHeader &superframe, uint64_t beaconIntervalUs);
+  /**
+   * Leave the superframe mode: the held frames are dropped if we are not
+   * associated anymore and handed over to the DCF/EDCAF otherwise.
+   */
+  void StopSuperframe (void);
+  /**
+   * Start our transmission window.
+   */
+  void OpenTxWindow (void);
+  /**
+   * End our transmission window.
+   */
+  void CloseTxWindow (void);
+  /**
+   * Hand the held frames over to the DCF/EDCAF as long as they can be
+   * sent before the end of our transmission window.
+   */
+  void ReleaseHeldFrames (void);
+  /**
+   * Hold a data frame until our transmission window. The held frames
+   * obey the size and lifetime limits of the DCF queue: the frame is
+   * dropped if that many frames are already held.
+   *
+   * \param packet_vlc the packet
+   * \param hdr the MAC header of the packet
+   */
+  void HoldFrame (Ptr<const Packet> packet_vlc, const WifiMacHeader &hdr);
+  /**
+   * Drop the held frames older than the lifetime of the DCF queue.
+   */
+  void ExpireHeldFrames (void);
+  /**
+   * Drop the held frames which outlived their lifetime before the
+   * transmission queues are reported to have drained.
+   */
+  virtual void NotifyTxQueueDrain (void);
+
+  /**
+   * Record the SNR of the beacons of all the APs we hear, and start a
+   * handover when another AP has been better than ours by the hysteresis
+   * margin for the time-to-trigger. Connected to the MonitorSnifferRx
+   * trace of the PHY.
+   *
+   * \param packet the received frame, with its MAC header
+   * \param channelFreqMhz the frequency of the channel in MHz
+   * \param channelNumber the channel number
+   * \param rate the rate in units of 500 kbps
+   * \param isShortPreamble whether a short preamble was used
+   * \param signalDbm the signal power in dBm
+   * \param noiseDbm the noise power in dBm
+   */
+  void SniffRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                uint32_t rate, bool isShortPreamble, double signalDbm, double noiseDbm);
+  /**
+   * Leave our AP and associate with the given one.
+   *
+   * \param bssid the address of the new AP
+   */
+  void StartHandover (Mac48Address bssid);
+
+  /**
+   * An AP we hear, see SniffRx.
+   */
+  struct ApInfo
+  {
+    Mac48Address bssid; //!< The address of the AP
+    double snr; //!< Smoothed SNR of the beacons of the AP, in dB
+    Time lastSeen; //!< Time of the last beacon of the AP
+    Time betterSince; //!< Time since which the AP is a handover candidate, zero if it is not
+  };
+
+  /**
+   * A data frame held until our transmission window.
+   */
+  struct HeldFrame
+  {
+    Ptr<const Packet> packet; //!< The packet
+    WifiMacHeader hdr; //!< The MAC header of the packet
+    Time tstamp; //!< The time the frame was held
+  };
 
 
   enum MacState m_state;
@@ -187,11 +334,30 @@ private:
   EventId m_beaconWatchdog;
   Time m_beaconWatchdogEnd;
   uint32_t m_maxMissedBeacons;
+  bool m_staticAssociation; //!< Flag if we were associated by SetStaticAssociation
+  bool m_enableHandover; //!< Flag if we hand over to better APs before missing beacons
+  double m_handoverHysteresis; //!< SNR margin of a handover candidate over our AP, in dB
+  Time m_handoverTimeToTrigger; //!< Time a candidate must stay better before the handover
+  Time m_apTableTimeout; //!< Time after which an AP we do not hear anymore is ignored
+  std::vector<ApInfo> m_apTable; //!< The APs we heard within m_apTableTimeout
+  EventId m_handoverEvent; //!< Pending handover
+  bool m_linkLost; //!< Flag if we left the ASSOCIATED state and have not come back yet
+  Mac48Address m_lostBssid; //!< The AP we were associated with before m_linkLostAt
+  Time m_linkLostAt; //!< Time we left the ASSOCIATED state
+
+  bool m_superframe; //!< Flag if the BSS uses superframes
+  bool m_txWindowOpen; //!< Flag if we are in our transmission window
+  Time m_txWindowEnd; //!< End of our current transmission window
+  Time m_txWindowBusyUntil; //!< Estimated end of the frames released in the current window
+  EventId m_txWindowStartEvent; //!< Start of our next transmission window
+  EventId m_txWindowEndEvent; //!< End of our next transmission window
+  std::deque<HeldFrame> m_heldFrames; //!< Data frames waiting for our transmission window
 
   TracedCallback<Mac48Address> m_assocLogger;
   TracedCallback<Mac48Address> m_deAssocLogger;
+  TracedCallback<Mac48Address, Mac48Address, Time> m_handoverLogger;
 };
 
 } // namespace ns3
 
-#endif /* STA_WIFI_MAC_H */
+#endif /* STA_VLC_MAC_H */
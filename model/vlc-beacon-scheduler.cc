@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-beacon-scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("VlcBeaconScheduler");
+
+namespace ns3 {
+
+VlcBeaconScheduler::VlcBeaconScheduler ()
+  : m_tick (MicroSeconds (1)),
+    m_nextId (0)
+{
+}
+
+VlcBeaconScheduler::~VlcBeaconScheduler ()
+{
+  // The simulator is being destroyed along with the pending events, so
+  // there is nothing to cancel.
+}
+
+VlcBeaconScheduler *
+VlcBeaconScheduler::Get (void)
+{
+  return SimulationSingleton<VlcBeaconScheduler>::Get ();
+}
+
+void
+VlcBeaconScheduler::SetTick (Time tick)
+{
+  NS_LOG_FUNCTION (this << tick);
+  NS_ASSERT_MSG (m_groups.empty () || tick == m_tick,
+                 "the tick cannot change while access points are registered");
+  NS_ASSERT (tick.IsStrictlyPositive ());
+  m_tick = tick;
+}
+
+uint32_t
+VlcBeaconScheduler::Add (Time interval, Time delay, Callback<void> beacon)
+{
+  NS_LOG_FUNCTION (this << interval << delay);
+  int64_t tickNs = m_tick.GetNanoSeconds ();
+  int64_t intervalTicks = interval.GetNanoSeconds () / tickNs;
+  NS_ASSERT (intervalTicks > 0);
+  NS_ASSERT (delay < interval);
+  int64_t startTicks = (Simulator::Now () + delay).GetNanoSeconds () / tickNs;
+
+  Entry entry;
+  entry.id = m_nextId++;
+  entry.next = NanoSeconds (startTicks * tickNs);
+  entry.beacon = beacon;
+  Group &group = m_groups[intervalTicks];
+  group.phases[startTicks % intervalTicks].push_back (entry);
+
+  // The new phase may come before the pending dispatch of the group
+  int64_t nowPhase = (Simulator::Now ().GetNanoSeconds () / tickNs) % intervalTicks;
+  ScheduleNext (intervalTicks, nowPhase);
+  return entry.id;
+}
+
+void
+VlcBeaconScheduler::Remove (Time interval, uint32_t id)
+{
+  NS_LOG_FUNCTION (this << interval << id);
+  int64_t intervalTicks = interval.GetNanoSeconds () / m_tick.GetNanoSeconds ();
+  Groups::iterator group = m_groups.find (intervalTicks);
+  if (group == m_groups.end ())
+    {
+      return;
+    }
+  Phases &phases = group->second.phases;
+  for (Phases::iterator i = phases.begin (); i != phases.end (); i++)
+    {
+      for (std::vector<Entry>::iterator j = i->second.begin (); j != i->second.end (); j++)
+        {
+          if (j->id == id)
+            {
+              i->second.erase (j);
+              if (i->second.empty ())
+                {
+                  phases.erase (i);
+                }
+              if (phases.empty ())
+                {
+                  group->second.event.Cancel ();
+                  m_groups.erase (group);
+                }
+              return;
+            }
+        }
+    }
+}
+
+void
+VlcBeaconScheduler::ScheduleNext (int64_t interval, int64_t fromPhase)
+{
+  Group &group = m_groups[interval];
+  group.event.Cancel ();
+  if (group.phases.empty ())
+    {
+      return;
+    }
+  int64_t tickNs = m_tick.GetNanoSeconds ();
+  int64_t intervalNs = interval * tickNs;
+  int64_t positionNs = Simulator::Now ().GetNanoSeconds () % intervalNs;
+  Phases::const_iterator next = group.phases.lower_bound (fromPhase);
+  int64_t delayNs;
+  if (next != group.phases.end ())
+    {
+      delayNs = std::max<int64_t> (0, next->first * tickNs - positionNs);
+    }
+  else
+    {
+      next = group.phases.begin ();
+      delayNs = next->first * tickNs + intervalNs - positionNs;
+    }
+  group.next = next->first;
+  group.event = Simulator::Schedule (NanoSeconds (delayNs), &VlcBeaconScheduler::Dispatch, this, interval);
+}
+
+void
+VlcBeaconScheduler::Dispatch (int64_t interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  Group &group = m_groups[interval];
+  int64_t phase = group.next;
+  Time intervalTime = NanoSeconds (interval * m_tick.GetNanoSeconds ());
+  // Collect the callbacks first: sending a beacon may register or
+  // unregister access points.
+  std::vector<Callback<void> > beacons;
+  Phases::iterator entries = group.phases.find (phase);
+  if (entries != group.phases.end ())
+    {
+      for (std::vector<Entry>::iterator i = entries->second.begin (); i != entries->second.end (); i++)
+        {
+          // An access point registered with a delay of one interval or
+          // which already sent its beacon in this tick waits for the next
+          // occurrence of its phase.
+          if (i->next <= Simulator::Now ())
+            {
+              i->next += intervalTime;
+              beacons.push_back (i->beacon);
+            }
+        }
+    }
+  ScheduleNext (interval, phase + 1);
+  for (std::vector<Callback<void> >::iterator i = beacons.begin (); i != beacons.end (); i++)
+    {
+      (*i) ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_BEACON_SCHEDULER_H
+#define VLC_BEACON_SCHEDULER_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A beacon service shared by all the access points of a simulation.
+ *
+ * Instead of one pending event per access point, the scheduler keeps one
+ * pending event per distinct beacon interval. The access points using
+ * the same interval are sorted by the phase of their beacons within the
+ * interval (which is set by their initial jitter); the event fires at
+ * the next phase, calls every access point with that phase, and is
+ * rescheduled for the following one. Phases are rounded down to a
+ * multiple of the tick so that access points whose jitter falls in the
+ * same tick share one event.
+ *
+ * There is a single instance per simulation, see Get.
+ */
+class VlcBeaconScheduler
+{
+public:
+  VlcBeaconScheduler ();
+  ~VlcBeaconScheduler ();
+
+  /**
+   * \return the scheduler of the simulation
+   */
+  static VlcBeaconScheduler * Get (void);
+
+  /**
+   * \param tick the granularity of the beacon phases, one microsecond by
+   *        default. It can only be changed while no access point is
+   *        registered; setting the current tick again is allowed, so that
+   *        each access point sets it before registering (see the
+   *        BeaconSchedulerTick attribute of ApVlcMac).
+   */
+  void SetTick (Time tick);
+  /**
+   * Register an access point.
+   *
+   * \param interval the beacon interval
+   * \param delay the delay until the first beacon, less than the interval
+   * \param beacon the callback which sends one beacon
+   * \return an identifier to pass to Remove
+   */
+  uint32_t Add (Time interval, Time delay, Callback<void> beacon);
+  /**
+   * Unregister an access point.
+   *
+   * \param interval the beacon interval the access point was registered with
+   * \param id the identifier returned by Add
+   */
+  void Remove (Time interval, uint32_t id);
+
+private:
+  /**
+   * An access point registered with the scheduler.
+   */
+  struct Entry
+  {
+    uint32_t id;             //!< The identifier of the registration
+    Time next;               //!< The time of the next beacon
+    Callback<void> beacon;   //!< Sends one beacon
+  };
+  typedef std::map<int64_t, std::vector<Entry> > Phases; //!< Entries by phase (in ticks)
+  /**
+   * The access points which share the same beacon interval.
+   */
+  struct Group
+  {
+    Phases phases;     //!< The access points by phase
+    EventId event;     //!< The next dispatch
+    int64_t next;      //!< The phase of the next dispatch
+  };
+  typedef std::map<int64_t, Group> Groups; //!< Groups by interval (in ticks)
+
+  /**
+   * Schedule the next dispatch of a group, at the first phase not
+   * before the given one.
+   *
+   * \param interval the interval of the group, in ticks
+   * \param fromPhase the first phase to consider, in ticks
+   */
+  void ScheduleNext (int64_t interval, int64_t fromPhase);
+  /**
+   * Send the beacons of the current phase of a group and schedule the
+   * next dispatch.
+   *
+   * \param interval the interval of the group, in ticks
+   */
+  void Dispatch (int64_t interval);
+
+  Groups m_groups;    //!< The groups by interval
+  Time m_tick;        //!< Granularity of the phases
+  uint32_t m_nextId;  //!< The identifier of the next registration
+};
+
+} // namespace ns3
+
+#endif /* VLC_BEACON_SCHEDULER_H */
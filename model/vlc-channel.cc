@@ -26,7 +26,6 @@
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
 #include "vlc-channel.h"
-#include "ns3/wifi-net-device.h"
 #include "yans-vlc-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
@@ -42,7 +41,7 @@ TypeId
 VlcChannel::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::VlcChannel")
-    .SetParent<Channel> ()
+    .SetParent<WifiChannel> ()
   ;
   return tid;
 }
@@ -20,26 +20,24 @@
 #ifndef VLC_CHANNEL_H
 #define VLC_CHANNEL_H
 
-#include "ns3/channel.h"
+#include "ns3/wifi-channel.h"
 
 namespace ns3 {
 
-class VlcNetDevice;
-class VlcPhy;
-
 /**
  * \brief Vlc Channel interface specification
  * \ingroup wifi
  *
- * This class works in tandem with the ns3::WifiPhy class. If you want to
- * provide a new Wifi PHY layer, you have to subclass both ns3::VlcChannel
- * and ns3::WifiPhy.
+ * This class works in tandem with the ns3::VlcPhy class. If you want to
+ * provide a new VLC PHY layer, you have to subclass both ns3::VlcChannel
+ * and ns3::VlcPhy. It is a ns3::WifiChannel so that the PHYs can be
+ * driven by the MAC layers of the wifi module.
  *
  * Typically, MyWifiChannel will define a Send method whose job is to distribute
  * packets from a MyWifiPhy source to a set of MyWifiPhy destinations. MyWifiPhy
  * also typically defines a Receive method which is invoked by MyWifiPhy.
  */
-class VlcChannel : public Channel
+class VlcChannel : public WifiChannel
 {
 public:
   static TypeId GetTypeId (void);
@@ -48,4 +46,4 @@ public:
 } // namespace ns3
 
 
-#endif /* Vlc_CHANNEL_H */
+#endif /* VLC_CHANNEL_H */
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-compact-llc-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (VlcCompactLlcHeader)
+  ;
+
+VlcCompactLlcHeader::VlcCompactLlcHeader ()
+  : m_etherType (0)
+{
+}
+
+void
+VlcCompactLlcHeader::SetType (uint16_t type)
+{
+  m_etherType = type;
+}
+
+uint16_t
+VlcCompactLlcHeader::GetType (void) const
+{
+  return m_etherType;
+}
+
+bool
+VlcCompactLlcHeader::IsCompact (uint8_t firstByte)
+{
+  // The DSAP of an LLC/SNAP header
+  return firstByte != 0xaa;
+}
+
+bool
+VlcCompactLlcHeader::CanCompact (uint16_t type)
+{
+  return IsCompact (type >> 8);
+}
+
+TypeId
+VlcCompactLlcHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcCompactLlcHeader")
+    .SetParent<Header> ()
+    .AddConstructor<VlcCompactLlcHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+VlcCompactLlcHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+VlcCompactLlcHeader::Print (std::ostream &os) const
+{
+  os << "type 0x";
+  os.setf (std::ios::hex, std::ios::basefield);
+  os << m_etherType;
+  os.setf (std::ios::dec, std::ios::basefield);
+}
+
+uint32_t
+VlcCompactLlcHeader::GetSerializedSize (void) const
+{
+  return 2;
+}
+
+void
+VlcCompactLlcHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU16 (m_etherType);
+}
+
+uint32_t
+VlcCompactLlcHeader::Deserialize (Buffer::Iterator start)
+{
+  m_etherType = start.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_COMPACT_LLC_HEADER_H
+#define VLC_COMPACT_LLC_HEADER_H
+
+#include <stdint.h>
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * The 2-byte header which replaces the 8-byte LLC/SNAP header in the
+ * compact framing mode of VlcNetDevice: the bare ethertype.
+ *
+ * The receiver tells both formats apart from the first byte (see
+ * IsCompact), 0xaa in an LLC/SNAP header, so that a BSS may mix devices
+ * with and without compact framing. No assigned ethertype starts with
+ * 0xaa; the frames of any other ethertype which does keep their LLC/SNAP
+ * header (see CanCompact).
+ */
+class VlcCompactLlcHeader : public Header
+{
+public:
+  VlcCompactLlcHeader ();
+
+  /**
+   * \param type the ethertype of the payload
+   */
+  void SetType (uint16_t type);
+  /**
+   * \return the ethertype of the payload
+   */
+  uint16_t GetType (void) const;
+
+  /**
+   * \param firstByte the first byte of a frame body
+   * \return true if the body starts with a VlcCompactLlcHeader, false if
+   *         it starts with an LLC/SNAP header
+   */
+  static bool IsCompact (uint8_t firstByte);
+  /**
+   * \param type an ethertype
+   * \return true if a frame of this ethertype may carry a
+   *         VlcCompactLlcHeader, false if it would be taken for an
+   *         LLC/SNAP header
+   */
+  static bool CanCompact (uint16_t type);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint16_t m_etherType; //!< The ethertype of the payload
+};
+
+} // namespace ns3
+
+#endif /* VLC_COMPACT_LLC_HEADER_H */
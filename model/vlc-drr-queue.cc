@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-drr-queue.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("VlcDrrQueue");
+
+namespace ns3 {
+
+VlcDrrQueue::VlcDrrQueue ()
+  : m_buckets (MIN_BUCKETS),
+    m_quantum (MicroSeconds (1000)),
+    m_nPackets (0)
+{
+}
+
+void
+VlcDrrQueue::SetQuantum (Time quantum)
+{
+  NS_ASSERT (quantum.IsStrictlyPositive ());
+  m_quantum = quantum;
+}
+
+uint32_t
+VlcDrrQueue::Hash (Mac48Address address) const
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  // The last bytes are the ones which differ between the stations of a
+  // simulation (and between the NICs of a vendor)
+  return ((buffer[3] << 16) | (buffer[4] << 8) | buffer[5]) % m_buckets.size ();
+}
+
+void
+VlcDrrQueue::Rehash (uint32_t nBuckets)
+{
+  NS_LOG_FUNCTION (this << nBuckets);
+  m_buckets.assign (nBuckets, std::vector<uint32_t> ());
+  std::vector<bool> free (m_stations.size (), false);
+  for (std::vector<uint32_t>::const_iterator i = m_freeStations.begin (); i != m_freeStations.end (); i++)
+    {
+      free[*i] = true;
+    }
+  for (uint32_t i = 0; i < m_stations.size (); i++)
+    {
+      if (!free[i])
+        {
+          m_buckets[Hash (m_stations[i].address)].push_back (i);
+        }
+    }
+}
+
+uint32_t
+VlcDrrQueue::Lookup (Mac48Address address)
+{
+  std::vector<uint32_t> &bucket = m_buckets[Hash (address)];
+  for (std::vector<uint32_t>::const_iterator i = bucket.begin (); i != bucket.end (); i++)
+    {
+      if (m_stations[*i].address == address)
+        {
+          return *i;
+        }
+    }
+  if (GetNStations () >= m_buckets.size ())
+    {
+      // Keep at most one station per bucket on average; the cost of the
+      // rehash is amortized over the stations added since the last one.
+      Rehash (2 * m_buckets.size ());
+    }
+  uint32_t index;
+  if (!m_freeStations.empty ())
+    {
+      index = m_freeStations.back ();
+      m_freeStations.pop_back ();
+    }
+  else
+    {
+      index = m_stations.size ();
+      m_stations.push_back (Station ());
+    }
+  Station &sta = m_stations[index];
+  sta.address = address;
+  sta.deficit = Seconds (0);
+  sta.active = false;
+  m_buckets[Hash (address)].push_back (index);
+  return index;
+}
+
+void
+VlcDrrQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr, Time airtime)
+{
+  NS_LOG_FUNCTION (this << packet << hdr.GetAddr1 () << airtime);
+  uint32_t index = Lookup (hdr.GetAddr1 ());
+  Station &sta = m_stations[index];
+  Item item;
+  item.packet = packet;
+  item.hdr = hdr;
+  item.airtime = airtime;
+  sta.queue.push_back (item);
+  m_nPackets++;
+  if (!sta.active)
+    {
+      sta.active = true;
+      sta.deficit = Seconds (0);
+      m_active.push_back (index);
+    }
+}
+
+bool
+VlcDrrQueue::Dequeue (Ptr<const Packet> &packet, WifiMacHeader &hdr)
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_active.empty ())
+    {
+      uint32_t index = m_active.front ();
+      Station &sta = m_stations[index];
+      if (sta.queue.empty ())
+        {
+          sta.active = false;
+          m_active.pop_front ();
+          continue;
+        }
+      const Item &item = sta.queue.front ();
+      if (sta.deficit >= item.airtime)
+        {
+          // The station keeps its turn as long as its deficit covers
+          // the frame at the head of its queue.
+          sta.deficit -= item.airtime;
+          packet = item.packet;
+          hdr = item.hdr;
+          sta.queue.pop_front ();
+          m_nPackets--;
+          if (sta.queue.empty ())
+            {
+              sta.active = false;
+              m_active.pop_front ();
+            }
+          return true;
+        }
+      sta.deficit += m_quantum;
+      m_active.pop_front ();
+      m_active.push_back (index);
+    }
+  return false;
+}
+
+uint32_t
+VlcDrrQueue::RemoveStation (Mac48Address address)
+{
+  std::vector<Ptr<const Packet> > dropped;
+  return RemoveStation (address, dropped);
+}
+
+uint32_t
+VlcDrrQueue::RemoveStation (Mac48Address address, std::vector<Ptr<const Packet> > &dropped)
+{
+  NS_LOG_FUNCTION (this << address);
+  std::vector<uint32_t> &bucket = m_buckets[Hash (address)];
+  for (std::vector<uint32_t>::iterator i = bucket.begin (); i != bucket.end (); i++)
+    {
+      uint32_t index = *i;
+      Station &sta = m_stations[index];
+      if (sta.address == address)
+        {
+          uint32_t n = sta.queue.size ();
+          for (std::deque<Item>::const_iterator j = sta.queue.begin (); j != sta.queue.end (); j++)
+            {
+              dropped.push_back (j->packet);
+            }
+          m_nPackets -= n;
+          sta.queue.clear ();
+          if (sta.active)
+            {
+              m_active.remove (index);
+              sta.active = false;
+            }
+          bucket.erase (i);
+          m_freeStations.push_back (index);
+          return n;
+        }
+    }
+  return 0;
+}
+
+uint32_t
+VlcDrrQueue::GetNPackets (void) const
+{
+  return m_nPackets;
+}
+
+uint32_t
+VlcDrrQueue::GetNStations (void) const
+{
+  return m_stations.size () - m_freeStations.size ();
+}
+
+uint32_t
+VlcDrrQueue::GetMaxBucketSize (void) const
+{
+  uint32_t size = 0;
+  for (std::vector<std::vector<uint32_t> >::const_iterator i = m_buckets.begin (); i != m_buckets.end (); i++)
+    {
+      size = std::max<uint32_t> (size, i->size ());
+    }
+  return size;
+}
+
+} // namespace ns3
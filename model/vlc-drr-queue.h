@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_DRR_QUEUE_H
+#define VLC_DRR_QUEUE_H
+
+#include <stdint.h>
+#include <deque>
+#include <list>
+#include <vector>
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/mac48-address.h"
+#include "ns3/wifi-mac-header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A set of per-station queues served by a deficit round robin scheduler
+ * whose deficits are expressed in airtime, so that a station at a low
+ * rate gets the same share of the medium as the others instead of
+ * blocking them.
+ *
+ * Stations are looked up by address in a hash table which doubles its
+ * number of buckets whenever it holds more stations than buckets, so the
+ * cost of Enqueue does not grow with the number of stations.
+ */
+class VlcDrrQueue
+{
+public:
+  VlcDrrQueue ();
+
+  /**
+   * \param quantum the airtime credited to a station at each round
+   */
+  void SetQuantum (Time quantum);
+  /**
+   * Add a frame to the queue of its receiver (Address 1).
+   *
+   * \param packet the packet
+   * \param hdr the MAC header of the packet
+   * \param airtime the estimated airtime of the frame
+   */
+  void Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr, Time airtime);
+  /**
+   * Remove the next frame chosen by the scheduler.
+   *
+   * \param packet the packet removed
+   * \param hdr the MAC header of the packet removed
+   * \return true if a frame was removed, false if all the queues are empty
+   */
+  bool Dequeue (Ptr<const Packet> &packet, WifiMacHeader &hdr);
+  /**
+   * Drop the queue of the given station.
+   *
+   * \param address the address of the station
+   * \return the number of frames dropped
+   */
+  uint32_t RemoveStation (Mac48Address address);
+  /**
+   * Drop the queue of the given station.
+   *
+   * \param address the address of the station
+   * \param dropped the vector to which the packets dropped are appended
+   * \return the number of frames dropped
+   */
+  uint32_t RemoveStation (Mac48Address address, std::vector<Ptr<const Packet> > &dropped);
+  /**
+   * \return the number of frames queued for all the stations
+   */
+  uint32_t GetNPackets (void) const;
+  /**
+   * \return the number of stations known to the queue
+   */
+  uint32_t GetNStations (void) const;
+  /**
+   * \return the largest number of stations sharing a bucket of the hash
+   *         table, that is the cost of the worst lookup
+   */
+  uint32_t GetMaxBucketSize (void) const;
+
+private:
+  /**
+   * A queued frame.
+   */
+  struct Item
+  {
+    Ptr<const Packet> packet;  //!< The packet
+    WifiMacHeader hdr;         //!< The MAC header of the packet
+    Time airtime;              //!< The estimated airtime of the frame
+  };
+  /**
+   * The state of one station.
+   */
+  struct Station
+  {
+    Mac48Address address;      //!< The address of the station
+    std::deque<Item> queue;    //!< The frames queued for the station
+    Time deficit;              //!< The airtime the station may still use in this round
+    bool active;               //!< Flag if the station is in the active list
+  };
+  /**
+   * Return the index of the given station, creating it if needed.
+   *
+   * \param address the address of the station
+   * \return the index of the station in m_stations
+   */
+  uint32_t Lookup (Mac48Address address);
+  /**
+   * \param address the address of a station
+   * \return the hash table bucket of the station
+   */
+  uint32_t Hash (Mac48Address address) const;
+  /**
+   * Spread the stations over a hash table of the given size.
+   *
+   * \param nBuckets the new number of buckets
+   */
+  void Rehash (uint32_t nBuckets);
+
+  static const uint32_t MIN_BUCKETS = 64;  //!< Initial size of the hash table
+
+  std::vector<Station> m_stations;                 //!< The stations
+  std::vector<uint32_t> m_freeStations;            //!< Indexes of unused entries in m_stations
+  std::vector<std::vector<uint32_t> > m_buckets;   //!< Hash table of the station indexes
+  std::list<uint32_t> m_active;                    //!< Round robin list of the stations with frames
+  Time m_quantum;                                  //!< Airtime credited at each round
+  uint32_t m_nPackets;                             //!< Number of queued frames
+};
+
+} // namespace ns3
+
+#endif /* VLC_DRR_QUEUE_H */
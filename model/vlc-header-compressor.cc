@@ -0,0 +1,673 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-header-compressor.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("VlcHeaderCompressor");
+
+namespace ns3 {
+
+namespace {
+
+const uint8_t ROHC_IR = 0xfd;           //!< Type of an IR header
+const uint8_t ROHC_CO = 0xe0;           //!< Type of a CO header
+const uint8_t ROHC_CO_IPID = 0x01;      //!< Flag of a CO header with IPv4 identification
+const uint16_t IPV4_PROT_NUMBER = 0x0800;
+const uint16_t IPV6_PROT_NUMBER = 0x86dd;
+const uint8_t UDP_PROT_NUMBER = 17;
+const uint32_t IPV4_UDP_HEADERS = 28;   //!< IPv4 header without options and UDP header
+const uint32_t IPV6_UDP_HEADERS = 48;   //!< IPv6 header and UDP header
+
+} // anonymous namespace
+
+NS_OBJECT_ENSURE_REGISTERED (VlcRohcHeader)
+  ;
+
+VlcRohcHeader::VlcRohcHeader ()
+  : m_type (ROHC_CO),
+    m_cid (0),
+    m_version (0),
+    m_msn (0),
+    m_ipId (0),
+    m_crc (0)
+{
+}
+
+void
+VlcRohcHeader::SetIr (uint8_t cid, uint8_t version, uint16_t msn)
+{
+  m_type = ROHC_IR;
+  m_cid = cid;
+  m_version = version;
+  m_msn = msn;
+}
+
+void
+VlcRohcHeader::SetCo (uint8_t cid, uint16_t msn, uint8_t crc)
+{
+  m_type = ROHC_CO;
+  m_cid = cid;
+  m_msn = msn & 0xff;
+  m_crc = crc;
+}
+
+void
+VlcRohcHeader::SetIpId (uint16_t ipId)
+{
+  NS_ASSERT (!IsIr ());
+  m_type |= ROHC_CO_IPID;
+  m_ipId = ipId;
+}
+
+bool
+VlcRohcHeader::IsIr (void) const
+{
+  return m_type == ROHC_IR;
+}
+
+uint8_t
+VlcRohcHeader::GetCid (void) const
+{
+  return m_cid;
+}
+
+uint8_t
+VlcRohcHeader::GetVersion (void) const
+{
+  return m_version;
+}
+
+uint16_t
+VlcRohcHeader::GetMsn (void) const
+{
+  return m_msn;
+}
+
+bool
+VlcRohcHeader::HasIpId (void) const
+{
+  return !IsIr () && (m_type & ROHC_CO_IPID) != 0;
+}
+
+uint16_t
+VlcRohcHeader::GetIpId (void) const
+{
+  return m_ipId;
+}
+
+uint8_t
+VlcRohcHeader::GetCrc (void) const
+{
+  return m_crc;
+}
+
+uint32_t
+VlcRohcHeader::GetHeaderSize (uint8_t firstByte)
+{
+  if (firstByte == ROHC_IR)
+    {
+      return 5;
+    }
+  if ((firstByte & ~ROHC_CO_IPID) == ROHC_CO)
+    {
+      return (firstByte & ROHC_CO_IPID) ? 6 : 4;
+    }
+  return 0;
+}
+
+TypeId
+VlcRohcHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcRohcHeader")
+    .SetParent<Header> ()
+    .AddConstructor<VlcRohcHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+VlcRohcHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+VlcRohcHeader::Print (std::ostream &os) const
+{
+  if (IsIr ())
+    {
+      os << "IR cid=" << (uint32_t)m_cid << " ipv" << (uint32_t)m_version << " msn=" << m_msn;
+    }
+  else
+    {
+      os << "CO cid=" << (uint32_t)m_cid << " msn=" << m_msn << " crc=" << (uint32_t)m_crc;
+      if (HasIpId ())
+        {
+          os << " id=" << m_ipId;
+        }
+    }
+}
+
+uint32_t
+VlcRohcHeader::GetSerializedSize (void) const
+{
+  return GetHeaderSize (m_type);
+}
+
+void
+VlcRohcHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteU8 (m_type);
+  start.WriteU8 (m_cid);
+  if (IsIr ())
+    {
+      start.WriteU8 (m_version);
+      start.WriteHtonU16 (m_msn);
+    }
+  else
+    {
+      start.WriteU8 (m_msn & 0xff);
+      start.WriteU8 (m_crc);
+      if (HasIpId ())
+        {
+          start.WriteHtonU16 (m_ipId);
+        }
+    }
+}
+
+uint32_t
+VlcRohcHeader::Deserialize (Buffer::Iterator start)
+{
+  m_type = start.ReadU8 ();
+  m_cid = start.ReadU8 ();
+  if (IsIr ())
+    {
+      m_version = start.ReadU8 ();
+      m_msn = start.ReadNtohU16 ();
+    }
+  else
+    {
+      m_msn = start.ReadU8 ();
+      m_crc = start.ReadU8 ();
+      if (HasIpId ())
+        {
+          m_ipId = start.ReadNtohU16 ();
+        }
+    }
+  return GetSerializedSize ();
+}
+
+
+const uint16_t VlcHeaderCompressor::PROT_NUMBER = 0x88b5;
+
+NS_OBJECT_ENSURE_REGISTERED (VlcHeaderCompressor)
+  ;
+
+TypeId
+VlcHeaderCompressor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcHeaderCompressor")
+    .SetParent<Object> ()
+    .AddConstructor<VlcHeaderCompressor> ()
+    .AddAttribute ("MaxContexts",
+                   "The maximum number of flows compressed at the same time between two "
+                   "MAC addresses. The least recently used flow loses its context.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&VlcHeaderCompressor::m_maxContexts),
+                   MakeUintegerChecker<uint32_t> (1, 256))
+    .AddAttribute ("RefreshInterval",
+                   "The number of compressed packets of a flow between two IR packets, "
+                   "which resynchronize the decompressor after drops.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&VlcHeaderCompressor::m_refreshInterval),
+                   MakeUintegerChecker<uint32_t> (1, 255))
+    .AddAttribute ("IrRepeat",
+                   "The number of IR packets which start a flow.",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&VlcHeaderCompressor::m_irRepeat),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+VlcHeaderCompressor::VlcHeaderCompressor ()
+  : m_packets (0),
+    m_headerBytes (0),
+    m_compressedBytes (0),
+    m_failures (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+VlcHeaderCompressor::~VlcHeaderCompressor ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VlcHeaderCompressor::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_compressor.clear ();
+  m_decompressor.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+VlcHeaderCompressor::ParseHeaders (Ptr<const Packet> packet, uint16_t protocolNumber,
+                                   Flow &flow, uint16_t &ipId)
+{
+  uint8_t buf[IPV6_UDP_HEADERS];
+  uint32_t size = packet->GetSize ();
+  if (protocolNumber == IPV4_PROT_NUMBER)
+    {
+      if (size < IPV4_UDP_HEADERS)
+        {
+          return 0;
+        }
+      packet->CopyData (buf, IPV4_UDP_HEADERS);
+      uint16_t totalLength = (buf[2] << 8) | buf[3];
+      uint16_t udpLength = (buf[24] << 8) | buf[25];
+      // No options, no fragment, no padding after the datagram
+      if (buf[0] != 0x45 || buf[9] != UDP_PROT_NUMBER
+          || (buf[6] & 0x3f) != 0 || buf[7] != 0
+          || totalLength != size || udpLength != size - 20)
+        {
+          return 0;
+        }
+      flow.version = 4;
+      flow.tos = buf[1];
+      flow.dontFragment = (buf[6] & 0x40) != 0;
+      flow.ttl = buf[8];
+      flow.flowLabel = 0;
+      flow.source4 = Ipv4Address::Deserialize (buf + 12);
+      flow.destination4 = Ipv4Address::Deserialize (buf + 16);
+      flow.sourcePort = (buf[20] << 8) | buf[21];
+      flow.destinationPort = (buf[22] << 8) | buf[23];
+      ipId = (buf[4] << 8) | buf[5];
+      return IPV4_UDP_HEADERS;
+    }
+  if (protocolNumber == IPV6_PROT_NUMBER)
+    {
+      if (size < IPV6_UDP_HEADERS)
+        {
+          return 0;
+        }
+      packet->CopyData (buf, IPV6_UDP_HEADERS);
+      uint16_t payloadLength = (buf[4] << 8) | buf[5];
+      uint16_t udpLength = (buf[44] << 8) | buf[45];
+      // No extension header, no padding after the datagram
+      if ((buf[0] >> 4) != 6 || buf[6] != UDP_PROT_NUMBER
+          || payloadLength != size - 40 || udpLength != size - 40)
+        {
+          return 0;
+        }
+      flow.version = 6;
+      flow.tos = ((buf[0] & 0x0f) << 4) | (buf[1] >> 4);
+      flow.flowLabel = ((buf[1] & 0x0f) << 16) | (buf[2] << 8) | buf[3];
+      flow.ttl = buf[7];
+      flow.dontFragment = false;
+      flow.source6 = Ipv6Address (buf + 8);
+      flow.destination6 = Ipv6Address (buf + 24);
+      flow.sourcePort = (buf[40] << 8) | buf[41];
+      flow.destinationPort = (buf[42] << 8) | buf[43];
+      ipId = 0;
+      return IPV6_UDP_HEADERS;
+    }
+  return 0;
+}
+
+bool
+VlcHeaderCompressor::IsSameFlow (const Flow &a, const Flow &b)
+{
+  if (a.version != b.version || a.tos != b.tos || a.ttl != b.ttl
+      || a.sourcePort != b.sourcePort || a.destinationPort != b.destinationPort)
+    {
+      return false;
+    }
+  if (a.version == 4)
+    {
+      return a.source4 == b.source4 && a.destination4 == b.destination4
+             && a.dontFragment == b.dontFragment;
+    }
+  return a.source6 == b.source6 && a.destination6 == b.destination6
+         && a.flowLabel == b.flowLabel;
+}
+
+uint8_t
+VlcHeaderCompressor::ComputeCrc (const Flow &flow)
+{
+  uint8_t buf[42];
+  uint32_t size = 0;
+  buf[size++] = flow.version;
+  buf[size++] = flow.tos;
+  buf[size++] = flow.ttl;
+  if (flow.version == 4)
+    {
+      flow.source4.Serialize (buf + size);
+      flow.destination4.Serialize (buf + size + 4);
+      size += 8;
+      buf[size++] = flow.dontFragment;
+    }
+  else
+    {
+      flow.source6.Serialize (buf + size);
+      flow.destination6.Serialize (buf + size + 16);
+      size += 32;
+      buf[size++] = (flow.flowLabel >> 16) & 0xff;
+      buf[size++] = (flow.flowLabel >> 8) & 0xff;
+      buf[size++] = flow.flowLabel & 0xff;
+    }
+  buf[size++] = flow.sourcePort >> 8;
+  buf[size++] = flow.sourcePort & 0xff;
+  buf[size++] = flow.destinationPort >> 8;
+  buf[size++] = flow.destinationPort & 0xff;
+
+  // The 8-bit CRC of ROHC (RFC 3095, section 5.9.1): polynomial
+  // 1 + x + x^2 + x^8, all ones initially, least significant bit first.
+  uint8_t crc = 0xff;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      crc ^= buf[i];
+      for (uint32_t bit = 0; bit < 8; bit++)
+        {
+          crc = (crc & 1) ? (crc >> 1) ^ 0xe0 : crc >> 1;
+        }
+    }
+  return crc;
+}
+
+VlcHeaderCompressor::Context &
+VlcHeaderCompressor::GetContext (Contexts &contexts, const Flow &flow, bool &created)
+{
+  Contexts::iterator lru = contexts.end ();
+  for (Contexts::iterator i = contexts.begin (); i != contexts.end (); i++)
+    {
+      if (IsSameFlow (i->flow, flow))
+        {
+          created = false;
+          return *i;
+        }
+      if (lru == contexts.end () || i->lastUse < lru->lastUse)
+        {
+          lru = i;
+        }
+    }
+  created = true;
+  Context context;
+  context.flow = flow;
+  context.crc = ComputeCrc (flow);
+  context.msn = 0;
+  context.ipIdOffset = 0;
+  context.sinceIr = 0;
+  context.irSent = 0;
+  if (contexts.size () < m_maxContexts)
+    {
+      context.cid = contexts.size ();
+      contexts.push_back (context);
+      return contexts.back ();
+    }
+  NS_LOG_DEBUG ("reuse context " << (uint32_t)lru->cid);
+  context.cid = lru->cid;
+  context.msn = lru->msn;
+  *lru = context;
+  return *lru;
+}
+
+VlcHeaderCompressor::Context *
+VlcHeaderCompressor::FindContext (Contexts &contexts, uint8_t cid)
+{
+  for (Contexts::iterator i = contexts.begin (); i != contexts.end (); i++)
+    {
+      if (i->cid == cid)
+        {
+          return &(*i);
+        }
+    }
+  return 0;
+}
+
+void
+VlcHeaderCompressor::Compress (Ptr<Packet> packet, uint16_t &protocolNumber,
+                               Mac48Address from, Mac48Address to)
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber << from << to);
+  Flow flow;
+  uint16_t ipId;
+  uint32_t headerSize = ParseHeaders (packet, protocolNumber, flow, ipId);
+  if (headerSize == 0)
+    {
+      return;
+    }
+  bool created;
+  Context &context = GetContext (m_compressor[std::make_pair (from, to)], flow, created);
+  context.msn++;
+  context.lastUse = Simulator::Now ();
+
+  VlcRohcHeader rohc;
+  if (context.irSent < m_irRepeat || context.sinceIr >= m_refreshInterval)
+    {
+      // The full headers stay in the packet
+      rohc.SetIr (context.cid, flow.version, context.msn);
+      context.ipIdOffset = ipId - context.msn;
+      context.sinceIr = 0;
+      context.irSent++;
+      m_compressedBytes += rohc.GetSerializedSize () + headerSize;
+    }
+  else
+    {
+      rohc.SetCo (context.cid, context.msn, context.crc);
+      if (flow.version == 4)
+        {
+          uint16_t ipIdOffset = ipId - context.msn;
+          if (ipIdOffset != context.ipIdOffset)
+            {
+              rohc.SetIpId (ipId);
+              context.ipIdOffset = ipIdOffset;
+            }
+          Ipv4Header ip;
+          packet->RemoveHeader (ip);
+        }
+      else
+        {
+          Ipv6Header ip;
+          packet->RemoveHeader (ip);
+        }
+      UdpHeader udp;
+      packet->RemoveHeader (udp);
+      context.sinceIr++;
+      m_compressedBytes += rohc.GetSerializedSize ();
+    }
+  NS_LOG_DEBUG (rohc);
+  packet->AddHeader (rohc);
+  protocolNumber = PROT_NUMBER;
+  m_packets++;
+  m_headerBytes += headerSize;
+}
+
+bool
+VlcHeaderCompressor::Decompress (Ptr<Packet> packet, uint16_t &protocolNumber,
+                                 Mac48Address from, Mac48Address to)
+{
+  NS_LOG_FUNCTION (this << packet << from << to);
+  uint8_t type;
+  uint32_t size = 0;
+  if (packet->CopyData (&type, 1) == 1)
+    {
+      size = VlcRohcHeader::GetHeaderSize (type);
+    }
+  if (size == 0 || packet->GetSize () < size)
+    {
+      NS_LOG_DEBUG ("malformed packet");
+      m_failures++;
+      return false;
+    }
+  VlcRohcHeader rohc;
+  packet->RemoveHeader (rohc);
+  NS_LOG_DEBUG (rohc);
+  Contexts &contexts = m_decompressor[std::make_pair (from, to)];
+  Context *context = FindContext (contexts, rohc.GetCid ());
+
+  if (rohc.IsIr ())
+    {
+      protocolNumber = rohc.GetVersion () == 4 ? IPV4_PROT_NUMBER : IPV6_PROT_NUMBER;
+      Flow flow;
+      uint16_t ipId;
+      if (ParseHeaders (packet, protocolNumber, flow, ipId) == 0)
+        {
+          NS_LOG_DEBUG ("malformed IR packet");
+          m_failures++;
+          return false;
+        }
+      if (context == 0)
+        {
+          contexts.push_back (Context ());
+          context = &contexts.back ();
+          context->cid = rohc.GetCid ();
+        }
+      context->flow = flow;
+      context->crc = ComputeCrc (flow);
+      context->msn = rohc.GetMsn ();
+      context->ipIdOffset = ipId - context->msn;
+      context->lastUse = Simulator::Now ();
+      return true;
+    }
+
+  if (context == 0)
+    {
+      // The IR packets of the flow were lost: wait for the next one
+      NS_LOG_DEBUG ("no context " << (uint32_t)rohc.GetCid ());
+      m_failures++;
+      return false;
+    }
+  if (rohc.GetCrc () != context->crc)
+    {
+      // The context was given to another flow whose IR packets were
+      // lost: do not rebuild the packet with the headers of the old flow
+      NS_LOG_DEBUG ("CRC mismatch on context " << (uint32_t)rohc.GetCid ());
+      m_failures++;
+      return false;
+    }
+  // The MSN always increases, by less than 256 unless that many packets
+  // were lost.
+  context->msn += (uint8_t)(rohc.GetMsn () - (context->msn & 0xff));
+  context->lastUse = Simulator::Now ();
+  const Flow &flow = context->flow;
+
+  UdpHeader udp;
+  udp.SetSourcePort (flow.sourcePort);
+  udp.SetDestinationPort (flow.destinationPort);
+  if (Node::ChecksumEnabled ())
+    {
+      udp.EnableChecksums ();
+      if (flow.version == 4)
+        {
+          udp.InitializeChecksum (flow.source4, flow.destination4, UDP_PROT_NUMBER);
+        }
+      else
+        {
+          udp.InitializeChecksum (flow.source6, flow.destination6, UDP_PROT_NUMBER);
+        }
+    }
+  packet->AddHeader (udp);
+
+  if (flow.version == 4)
+    {
+      if (rohc.HasIpId ())
+        {
+          context->ipIdOffset = rohc.GetIpId () - context->msn;
+        }
+      Ipv4Header ip;
+      ip.SetSource (flow.source4);
+      ip.SetDestination (flow.destination4);
+      ip.SetProtocol (UDP_PROT_NUMBER);
+      ip.SetPayloadSize (packet->GetSize ());
+      ip.SetTtl (flow.ttl);
+      ip.SetTos (flow.tos);
+      ip.SetIdentification (context->ipIdOffset + context->msn);
+      if (flow.dontFragment)
+        {
+          ip.SetDontFragment ();
+        }
+      else
+        {
+          ip.SetMayFragment ();
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          ip.EnableChecksum ();
+        }
+      packet->AddHeader (ip);
+      protocolNumber = IPV4_PROT_NUMBER;
+    }
+  else
+    {
+      Ipv6Header ip;
+      ip.SetSourceAddress (flow.source6);
+      ip.SetDestinationAddress (flow.destination6);
+      ip.SetNextHeader (UDP_PROT_NUMBER);
+      ip.SetPayloadLength (packet->GetSize ());
+      ip.SetHopLimit (flow.ttl);
+      ip.SetTrafficClass (flow.tos);
+      ip.SetFlowLabel (flow.flowLabel);
+      packet->AddHeader (ip);
+      protocolNumber = IPV6_PROT_NUMBER;
+    }
+  return true;
+}
+
+uint64_t
+VlcHeaderCompressor::GetCompressedPackets (void) const
+{
+  return m_packets;
+}
+
+uint64_t
+VlcHeaderCompressor::GetHeaderBytes (void) const
+{
+  return m_headerBytes;
+}
+
+uint64_t
+VlcHeaderCompressor::GetCompressedHeaderBytes (void) const
+{
+  return m_compressedBytes;
+}
+
+double
+VlcHeaderCompressor::GetCompressionRatio (void) const
+{
+  if (m_headerBytes == 0)
+    {
+      return 1.0;
+    }
+  return (double)m_compressedBytes / m_headerBytes;
+}
+
+uint64_t
+VlcHeaderCompressor::GetDecompressionFailures (void) const
+{
+  return m_failures;
+}
+
+} // namespace ns3
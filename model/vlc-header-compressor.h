@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_HEADER_COMPRESSOR_H
+#define VLC_HEADER_COMPRESSOR_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/header.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * The header of the packets compressed by VlcHeaderCompressor: an IR
+ * header (type, context identifier, profile and MSN), which precedes the
+ * full IP/UDP headers, or a CO header (type, context identifier, 8 bits of
+ * MSN, CRC of the static fields of the flow and the optional IPv4
+ * identification), which replaces them.
+ */
+class VlcRohcHeader : public Header
+{
+public:
+  VlcRohcHeader ();
+
+  /**
+   * Make this header an IR header.
+   *
+   * \param cid the context identifier
+   * \param version the IP version of the flow, 4 or 6
+   * \param msn the message sequence number
+   */
+  void SetIr (uint8_t cid, uint8_t version, uint16_t msn);
+  /**
+   * Make this header a CO header without IPv4 identification.
+   *
+   * \param cid the context identifier
+   * \param msn the message sequence number, of which only the 8 least
+   *        significant bits are sent
+   * \param crc the CRC of the static fields of the flow
+   */
+  void SetCo (uint8_t cid, uint16_t msn, uint8_t crc);
+  /**
+   * Add the IPv4 identification to a CO header.
+   *
+   * \param ipId the IPv4 identification
+   */
+  void SetIpId (uint16_t ipId);
+
+  /**
+   * \return true for an IR header, false for a CO header
+   */
+  bool IsIr (void) const;
+  /**
+   * \return the context identifier
+   */
+  uint8_t GetCid (void) const;
+  /**
+   * \return the IP version of the flow, for an IR header
+   */
+  uint8_t GetVersion (void) const;
+  /**
+   * \return the MSN of an IR header, or its 8 least significant bits for
+   *         a CO header
+   */
+  uint16_t GetMsn (void) const;
+  /**
+   * \return true if the CO header holds the IPv4 identification
+   */
+  bool HasIpId (void) const;
+  /**
+   * \return the IPv4 identification
+   */
+  uint16_t GetIpId (void) const;
+  /**
+   * \return the CRC of the static fields of the flow, for a CO header
+   */
+  uint8_t GetCrc (void) const;
+
+  /**
+   * \param firstByte the first byte of a compressed packet
+   * \return the size of the header starting with this byte, or 0 if it
+   *         is not a valid IR or CO header
+   */
+  static uint32_t GetHeaderSize (uint8_t firstByte);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_type;    //!< IR, or CO and its flags
+  uint8_t m_cid;     //!< Context identifier
+  uint8_t m_version; //!< IP version of the flow (IR)
+  uint16_t m_msn;    //!< Message sequence number
+  uint16_t m_ipId;   //!< IPv4 identification (CO)
+  uint8_t m_crc;     //!< CRC of the static fields of the flow (CO)
+};
+
+/**
+ * \brief link-layer compression of the IP/UDP headers
+ * \ingroup wifi
+ *
+ * A compressor/decompressor in the spirit of ROHC (RFC 3095) in
+ * unidirectional mode, used by VlcNetDevice for IPv4/UDP and IPv6/UDP
+ * datagrams without options, extension headers or fragmentation.
+ *
+ * For every flow between two MAC addresses, the compressor keeps a
+ * context with the static fields of the headers (addresses, ports, TTL or
+ * hop limit, TOS or traffic class, flow label) and a 16-bit message
+ * sequence number (MSN). The first packets of a flow, and then one packet
+ * every RefreshInterval, are sent as IR packets: the full headers
+ * preceded by a 5-byte IR header which lets the decompressor (re)create
+ * the context. The others are sent as 4-byte CO packets holding the 8
+ * least significant bits of the MSN and an 8-bit CRC of the static fields,
+ * plus the IPv4 identification when it does not follow the MSN. The lengths are inferred from the size of the
+ * frame and the checksums are computed again by the decompressor when
+ * checksums are enabled (see Node::ChecksumEnabled), the FCS of the frame
+ * protecting the payload on the link.
+ *
+ * The periodic IR packets resynchronize the decompressor after drops: a
+ * CO packet for an unknown context is dropped, and the MSN is decoded
+ * correctly as long as fewer than 256 consecutive packets of the flow are
+ * lost. A CO packet whose CRC does not match its context, because the
+ * context was given to a new flow whose IR packets were lost, is dropped
+ * as well instead of being rebuilt with the headers of the old flow.
+ *
+ * Compressed packets are carried with the ethertype PROT_NUMBER.
+ */
+class VlcHeaderCompressor : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcHeaderCompressor ();
+  virtual ~VlcHeaderCompressor ();
+
+  /**
+   * The ethertype of the compressed packets (IEEE 802 local experimental
+   * ethertype 1).
+   */
+  static const uint16_t PROT_NUMBER;
+
+  /**
+   * Compress the headers of a packet, if it is an IPv4/UDP or IPv6/UDP
+   * datagram that can be compressed.
+   *
+   * \param packet the packet, starting with the IP header
+   * \param protocolNumber the ethertype of the packet, set to
+   *        PROT_NUMBER if the packet is compressed
+   * \param from the source MAC address of the frame
+   * \param to the destination MAC address of the frame
+   */
+  void Compress (Ptr<Packet> packet, uint16_t &protocolNumber,
+                 Mac48Address from, Mac48Address to);
+  /**
+   * Restore the headers of a packet received with the ethertype
+   * PROT_NUMBER.
+   *
+   * \param packet the packet, starting with the compression header
+   * \param protocolNumber set to the ethertype of the restored packet
+   * \param from the source MAC address of the frame
+   * \param to the destination MAC address of the frame
+   * \return false if the packet refers to an unknown context or is
+   *         malformed, in which case it must be dropped
+   */
+  bool Decompress (Ptr<Packet> packet, uint16_t &protocolNumber,
+                   Mac48Address from, Mac48Address to);
+
+  /**
+   * \return the number of packets compressed, as IR or CO packets
+   */
+  uint64_t GetCompressedPackets (void) const;
+  /**
+   * \return the number of bytes of the IP/UDP headers of the compressed
+   *         packets
+   */
+  uint64_t GetHeaderBytes (void) const;
+  /**
+   * \return the number of bytes which replaced these headers on the link
+   */
+  uint64_t GetCompressedHeaderBytes (void) const;
+  /**
+   * \return GetCompressedHeaderBytes () / GetHeaderBytes (), or 1 if no
+   *         packet was compressed
+   */
+  double GetCompressionRatio (void) const;
+  /**
+   * \return the number of received packets dropped because they referred
+   *         to an unknown context or were malformed
+   */
+  uint64_t GetDecompressionFailures (void) const;
+
+private:
+  /**
+   * The headers of a flow.
+   */
+  struct Flow
+  {
+    uint8_t version;         //!< IP version, 4 or 6
+    Ipv4Address source4;     //!< IPv4 source address
+    Ipv4Address destination4; //!< IPv4 destination address
+    Ipv6Address source6;     //!< IPv6 source address
+    Ipv6Address destination6; //!< IPv6 destination address
+    uint8_t tos;             //!< TOS or traffic class
+    uint8_t ttl;             //!< TTL or hop limit
+    uint32_t flowLabel;      //!< IPv6 flow label
+    bool dontFragment;       //!< IPv4 DF flag
+    uint16_t sourcePort;     //!< UDP source port
+    uint16_t destinationPort; //!< UDP destination port
+  };
+  /**
+   * The state of a flow, on either side of the link.
+   */
+  struct Context
+  {
+    Flow flow;               //!< Static fields
+    uint8_t cid;             //!< Context identifier
+    uint8_t crc;             //!< CRC of the static fields
+    uint16_t msn;            //!< Last message sequence number
+    uint16_t ipIdOffset;     //!< IPv4 identification minus MSN
+    uint32_t sinceIr;        //!< Packets sent since the last IR packet
+    uint32_t irSent;         //!< IR packets sent since the context was created
+    Time lastUse;            //!< Last packet of the context
+  };
+  typedef std::pair<Mac48Address, Mac48Address> Link; //!< Source and destination of the frames
+  typedef std::vector<Context> Contexts; //!< Contexts of a link
+  typedef std::map<Link, Contexts> LinkContexts; //!< Contexts of all the links
+
+  virtual void DoDispose (void);
+
+  /**
+   * Parse the IP and UDP headers at the start of a packet.
+   *
+   * \param packet the packet
+   * \param protocolNumber the ethertype of the packet
+   * \param flow the parsed static fields
+   * \param ipId the parsed IPv4 identification
+   * \return the size of the headers, or 0 if they cannot be compressed
+   */
+  static uint32_t ParseHeaders (Ptr<const Packet> packet, uint16_t protocolNumber,
+                                Flow &flow, uint16_t &ipId);
+  /**
+   * \param a a flow
+   * \param b a flow
+   * \return true if the static fields of both flows are equal
+   */
+  static bool IsSameFlow (const Flow &a, const Flow &b);
+  /**
+   * \param flow a flow
+   * \return the 8-bit CRC of ROHC over the static fields of the flow
+   */
+  static uint8_t ComputeCrc (const Flow &flow);
+  /**
+   * Find the context of a flow on a link, or create it, reusing the
+   * least recently used context when the link has MaxContexts of them.
+   *
+   * \param contexts the contexts of the link
+   * \param flow the flow
+   * \param created set to true if the context is new
+   * \return the context
+   */
+  Context & GetContext (Contexts &contexts, const Flow &flow, bool &created);
+  /**
+   * \param contexts the contexts of a link
+   * \param cid a context identifier
+   * \return the context, or 0 if the link has none with this identifier
+   */
+  static Context * FindContext (Contexts &contexts, uint8_t cid);
+
+  LinkContexts m_compressor;   //!< Contexts of the flows we send
+  LinkContexts m_decompressor; //!< Contexts of the flows we receive
+  uint32_t m_maxContexts;      //!< Maximum number of contexts per link
+  uint32_t m_refreshInterval;  //!< Packets between two IR packets of a flow
+  uint32_t m_irRepeat;         //!< IR packets sent when a context is created
+  uint64_t m_packets;          //!< Packets compressed
+  uint64_t m_headerBytes;      //!< Bytes of the headers compressed
+  uint64_t m_compressedBytes;  //!< Bytes of the compressed headers
+  uint64_t m_failures;         //!< Packets which could not be decompressed
+};
+
+} // namespace ns3
+
+#endif /* VLC_HEADER_COMPRESSOR_H */
@@ -18,403 +18,452 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "vlc-mac.h"
-#include "ns3/dcf.h"
-#include "ns3/uinteger.h"
+#include "vlc-phy.h"
+#include "ns3/dca-txop.h"
+#include "ns3/edca-txop-n.h"
+#include "ns3/dcf-manager.h"
+#include "ns3/mac-low.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/nstime.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("VlcMac");
 
 namespace ns3 {
 
+/**
+ * Listener of the exchanges of the frames VlcMac sends itself to
+ * continue a TXOP.
+ */
+class VlcTxopListener : public MacLowTransmissionListener
+{
+public:
+  VlcTxopListener (VlcMac *mac)
+    : MacLowTransmissionListener (),
+      m_mac (mac)
+  {
+  }
+  virtual ~VlcTxopListener ()
+  {
+  }
+
+  virtual void GotCts (double snr, WifiMode txMode)
+  {
+  }
+  virtual void MissedCts (void)
+  {
+  }
+  virtual void GotAck (double snr, WifiMode txMode)
+  {
+    m_mac->TxopGotAck ();
+  }
+  virtual void MissedAck (void)
+  {
+    m_mac->TxopFailed ();
+  }
+  virtual void StartNext (void)
+  {
+  }
+  virtual void Cancel (void)
+  {
+    m_mac->TxopFailed ();
+  }
+  virtual void EndTxNoAck (void)
+  {
+  }
+
+private:
+  VlcMac *m_mac;
+};
+
 NS_OBJECT_ENSURE_REGISTERED (VlcMac)
   ;
-  
 
-Time
-VlcMac::GetDefaultMaxPropagationDelay (void)
-{
-  // 1000m
-  return Seconds (1000.0 / 300000000.0);
-}
-Time
-VlcMac::GetDefaultSlot (void)
-{
-  // 802.11-a specific
-  return MicroSeconds (9);
-}
-Time
-VlcMac::GetDefaultSifs (void)
-{
-  // 802.11-a specific
-  return MicroSeconds (16);
-}
-Time 
-VlcMac::GetDefaultRifs (void)
+TypeId
+VlcMac::GetTypeId (void)
 {
-  //802.11n specific
-  return MicroSeconds (2);
+  static TypeId tid = TypeId ("ns3::VlcMac")
+    .SetParent<RegularWifiMac> ()
+    .AddTraceSource ("MacTxBatch",
+                     "A burst of packets has been received from higher layers: the number of packets "
+                     "and their total size in bytes. MacTx is also fired for each packet of the burst.",
+                     MakeTraceSourceAccessor (&VlcMac::m_macTxBatchTrace))
+    .AddAttribute ("BE_TxopLimit",
+                   "The TXOP limit of the best effort access category. A zero value "
+                   "allows a single frame per channel access.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&VlcMac::m_beTxopLimit),
+                   MakeTimeChecker ())
+    .AddAttribute ("BK_TxopLimit",
+                   "The TXOP limit of the background access category.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&VlcMac::m_bkTxopLimit),
+                   MakeTimeChecker ())
+    .AddAttribute ("VI_TxopLimit",
+                   "The TXOP limit of the video access category; the default EDCA "
+                   "parameter set of 802.11 uses 3.008 ms.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&VlcMac::m_viTxopLimit),
+                   MakeTimeChecker ())
+    .AddAttribute ("VO_TxopLimit",
+                   "The TXOP limit of the voice access category; the default EDCA "
+                   "parameter set of 802.11 uses 1.504 ms.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&VlcMac::m_voTxopLimit),
+                   MakeTimeChecker ())
+  ;
+  return tid;
 }
-Time
-VlcMac::GetDefaultEifsNoDifs (void)
+
+VlcMac::VlcMac ()
+  : m_inTxop (false),
+    m_txopAc (AC_BE)
 {
-  return GetDefaultSifs () + GetDefaultCtsAckDelay ();
+  NS_LOG_FUNCTION (this);
+  m_txopListener = new VlcTxopListener (this);
 }
-Time
-VlcMac::GetDefaultCtsAckDelay (void)
+
+VlcMac::~VlcMac ()
 {
-  // 802.11-a specific: 6mb/s
-  return MicroSeconds (44);
-}
-Time
-VlcMac::GetDefaultCtsAckTimeout (void)
-{
-  /* Cts_Timeout and Ack_Timeout are specified in the Annex C
-     (Formal description of MAC operation, see details on the
-     Trsp timer setting at page 346)
-  */
-  Time ctsTimeout = GetDefaultSifs ();
-  ctsTimeout += GetDefaultCtsAckDelay ();
-  ctsTimeout += MicroSeconds (GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2);
-  ctsTimeout += GetDefaultSlot ();
-  return ctsTimeout;
+  NS_LOG_FUNCTION (this);
 }
 
-Time
-VlcMac::GetDefaultBasicBlockAckDelay (void)
-{
-  // This value must be rivisited
-  return MicroSeconds (250);
+void
+VlcMac::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_txQueueLifetimeEvent.Cancel ();
+  m_txopEvent.Cancel ();
+  m_txopPacket = 0;
+  m_txQueueCallback = MakeNullCallback<void> ();
+  Ptr<VlcPhy> phy = DynamicCast<VlcPhy> (m_phy);
+  if (phy != 0)
+    {
+      // RegularWifiMac::DoDispose deletes the DcfManager
+      phy->RegisterDcfManager (0);
+    }
+  RegularWifiMac::DoDispose ();
+  // MacLow is disposed of above and no longer calls the listener
+  delete m_txopListener;
+  m_txopListener = 0;
 }
-Time
-VlcMac::GetDefaultCompressedBlockAckDelay (void)
+
+void
+VlcMac::SetWifiPhy (Ptr<WifiPhy> phy)
 {
-  // This value must be rivisited was 68. 
- //CompressedBlockAckSize 32* 8*time it takes to transfer at the lowest rate (6Mb/s)+ aPhy-StartDelay(33)
-  return MicroSeconds (76);
+  NS_LOG_FUNCTION (this << phy);
+  Ptr<VlcPhy> vlcPhy = DynamicCast<VlcPhy> (phy);
+  if (vlcPhy != 0)
+    {
+      // Same as RegularWifiMac::SetWifiPhy, except that the DcfManager is
+      // notified by direct calls instead of through a WifiPhyListener:
+      // registering both would notify it twice of every event.
+      m_phy = phy;
+      vlcPhy->RegisterDcfManager (m_dcfManager);
+      m_low->SetPhy (phy);
+    }
+  else
+    {
+      RegularWifiMac::SetWifiPhy (phy);
+    }
+  phy->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcMac::PhyTxBegin, this));
 }
-Time
-VlcMac::GetDefaultBasicBlockAckTimeout (void)
+
+void
+VlcMac::TxOk (const WifiMacHeader &hdr)
 {
-  Time blockAckTimeout = GetDefaultSifs ();
-  blockAckTimeout += GetDefaultBasicBlockAckDelay ();
-  blockAckTimeout += MicroSeconds (GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2);
-  blockAckTimeout += GetDefaultSlot ();
-  return blockAckTimeout;
+  RegularWifiMac::TxOk (hdr);
+  NotifyTxQueueDrain ();
+  if (m_qosSupported && hdr.IsQosData () && !hdr.GetAddr1 ().IsGroup ())
+    {
+      ContinueTxop (QosUtilsMapTidToAc (hdr.GetQosTid ()));
+    }
 }
-Time
-VlcMac::GetDefaultCompressedBlockAckTimeout (void)
+
+void
+VlcMac::TxFailed (const WifiMacHeader &hdr)
 {
-  Time blockAckTimeout = GetDefaultSifs ();
-  blockAckTimeout += GetDefaultCompressedBlockAckDelay ();
-  blockAckTimeout += MicroSeconds (GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2);
-  blockAckTimeout += GetDefaultSlot ();
-  return blockAckTimeout;
+  m_counters.retryDrop++;
+  RegularWifiMac::TxFailed (hdr);
+  NotifyTxQueueDrain ();
 }
 
 void
-VlcMac::SetBasicBlockAckTimeout (Time blockAckTimeout)
+VlcMac::PhyTxBegin (Ptr<const Packet> packet)
 {
-  //this method must be implemented by QoS WifiMacs
+  m_lastTxBegin = Simulator::Now ();
+  NotifyTxQueueDrain ();
 }
 
-Time
-VlcMac::GetBasicBlockAckTimeout (void) const
+void
+VlcMac::ContinueTxop (enum AcIndex ac)
 {
-  //this method must be implemented by QoS WifiMacs
-  return MicroSeconds (0);
+  NS_LOG_FUNCTION (this << ac);
+  if (GetTxopLimit (ac).IsZero () || m_txopEvent.IsRunning ())
+    {
+      return;
+    }
+  if (!m_inTxop || m_txopAc != ac)
+    {
+      // The TXOP started with the transmission of the frame just
+      // acknowledged, after the backoff of its EDCAF.
+      m_inTxop = true;
+      m_txopAc = ac;
+      m_txopStart = m_lastTxBegin;
+    }
+  m_txopEvent = Simulator::Schedule (GetSifs (), &VlcMac::SendNextInTxop, this);
 }
 
 void
-VlcMac::SetCompressedBlockAckTimeout (Time blockAckTimeout)
-{
-  //this methos must be implemented by QoS WifiMacs
+VlcMac::SendNextInTxop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<WifiMacQueue> queue = m_edca[m_txopAc]->GetQueue ();
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = queue->Peek (&hdr);
+  // The frames of a block ack agreement are left to the EDCAF, which
+  // keeps the state of the agreement.
+  if (packet == 0
+      || !hdr.IsQosData ()
+      || hdr.GetAddr1 ().IsGroup ()
+      || m_edca[m_txopAc]->GetBaAgreementExists (hdr.GetAddr1 (), hdr.GetQosTid ())
+      || !m_phy->IsStateIdle ()
+      || Simulator::Now () + GetExchangeDuration (packet, hdr) > m_txopStart + GetTxopLimit (m_txopAc))
+    {
+      NS_LOG_DEBUG ("end of the TXOP of AC " << m_txopAc);
+      m_inTxop = false;
+      return;
+    }
+  packet = queue->Dequeue (&hdr);
+  hdr.SetSequenceNumber (m_txMiddle->GetNextSequenceNumberfor (&hdr));
+  hdr.SetFragmentNumber (0);
+  hdr.SetNoMoreFragments ();
+  hdr.SetNoRetry ();
+
+  // The first exchange of the TXOP set the NAV of the other stations,
+  // so the frame is sent without RTS.
+  MacLowTransmissionParameters params;
+  params.EnableAck ();
+  params.DisableRts ();
+  params.DisableNextData ();
+  params.DisableOverrideDurationId ();
+  m_low->StartTransmission (packet, &hdr, params, m_txopListener);
+  m_txopPacket = packet;
+  m_txopHdr = hdr;
 }
 
 Time
-VlcMac::GetCompressedBlockAckTimeout (void) const
-{
-  //this method must be implemented by QoS WifiMacs
-  return MicroSeconds (0);
+VlcMac::GetExchangeDuration (Ptr<const Packet> packet, const WifiMacHeader &hdr)
+{
+  uint32_t size = packet->GetSize () + hdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+  WifiTxVector txVector = m_stationManager->GetDataTxVector (hdr.GetAddr1 (), &hdr, packet, size);
+  WifiTxVector ackTxVector = txVector;
+  ackTxVector.SetMode (m_stationManager->GetAckMode (hdr.GetAddr1 (), txVector.GetMode ()));
+  WifiMacHeader ack;
+  ack.SetType (WIFI_MAC_CTL_ACK);
+  return VlcPhy::CalculateTxDuration (size, txVector, WIFI_PREAMBLE_LONG)
+         + GetSifs ()
+         + VlcPhy::CalculateTxDuration (ack.GetSize () + WIFI_MAC_FCS_LENGTH, ackTxVector, WIFI_PREAMBLE_LONG);
 }
 
-TypeId
-VlcMac::GetTypeId (void)
+void
+VlcMac::TxopGotAck (void)
 {
-  static TypeId tid = TypeId ("ns3::WifiMac")
-    .SetParent<Object> ()
-    .AddAttribute ("CtsTimeout", "When this timeout expires, the RTS/CTS handshake has failed.",
-                   TimeValue (GetDefaultCtsAckTimeout ()),
-                   MakeTimeAccessor (&VlcMac::SetCtsTimeout,
-                                     &VlcMac::GetCtsTimeout),
-                   MakeTimeChecker ())
-    .AddAttribute ("AckTimeout", "When this timeout expires, the DATA/ACK handshake has failed.",
-                   TimeValue (GetDefaultCtsAckTimeout ()),
-                   MakeTimeAccessor (&VlcMac::GetAckTimeout,
-                                     &VlcMac::SetAckTimeout),
-                   MakeTimeChecker ())
-    .AddAttribute ("BasicBlockAckTimeout", "When this timeout expires, the BASIC_BLOCK_ACK_REQ/BASIC_BLOCK_ACK handshake has failed.",
-                   TimeValue (GetDefaultBasicBlockAckTimeout ()),
-                   MakeTimeAccessor (&VlcMac::GetBasicBlockAckTimeout,
-                                     &VlcMac::SetBasicBlockAckTimeout),
-                   MakeTimeChecker ())
-    .AddAttribute ("CompressedBlockAckTimeout", "When this timeout expires, the COMPRESSED_BLOCK_ACK_REQ/COMPRESSED_BLOCK_ACK handshake has failed.",
-                   TimeValue (GetDefaultCompressedBlockAckTimeout ()),
-                   MakeTimeAccessor (&VlcMac::GetCompressedBlockAckTimeout,
-                                     &VlcMac::SetCompressedBlockAckTimeout),
-                   MakeTimeChecker ())
-    .AddAttribute ("Sifs", "The value of the SIFS constant.",
-                   TimeValue (GetDefaultSifs ()),
-                   MakeTimeAccessor (&VlcMac::SetSifs,
-                                     &VlcMac::GetSifs),
-                   MakeTimeChecker ())
-    .AddAttribute ("EifsNoDifs", "The value of EIFS-DIFS",
-                   TimeValue (GetDefaultEifsNoDifs ()),
-                   MakeTimeAccessor (&VlcMac::SetEifsNoDifs,
-                                     &VlcMac::GetEifsNoDifs),
-                   MakeTimeChecker ())
-    .AddAttribute ("Slot", "The duration of a Slot.",
-                   TimeValue (GetDefaultSlot ()),
-                   MakeTimeAccessor (&VlcMac::SetSlot,
-                                     &VlcMac::GetSlot),
-                   MakeTimeChecker ())
-    .AddAttribute ("Pifs", "The value of the PIFS constant.",
-                   TimeValue (GetDefaultSifs () + GetDefaultSlot ()),
-                   MakeTimeAccessor (&VlcMac::SetPifs,
-                                     &VlcMac::GetPifs),
-                   MakeTimeChecker ())
-.AddAttribute ("Rifs", "The value of the RIFS constant.",
-                   TimeValue (GetDefaultRifs ()),
-                   MakeTimeAccessor (&VlcMac::SetRifs,
-                                     &VlcMac::GetRifs),
-                   MakeTimeChecker ())
-
-    .AddAttribute ("MaxPropagationDelay", "The maximum propagation delay. Unused for now.",
-                   TimeValue (GetDefaultMaxPropagationDelay ()),
-                   MakeTimeAccessor (&VlcMac::m_maxPropagationDelay),
-                   MakeTimeChecker ())
-    .AddAttribute ("Ssid", "The ssid we want to belong to.",
-                   SsidValue (Ssid ("default")),
-                   MakeSsidAccessor (&VlcMac::GetSsid,
-                                     &VlcMac::SetSsid),
-                   MakeSsidChecker ())
-    .AddTraceSource ("MacTx",
-                     "A packet has been received from higher layers and is being processed in preparation for "
-                     "queueing for transmission.",
-                     MakeTraceSourceAccessor (&VlcMac::m_macTxTrace))
-    .AddTraceSource ("MacTxDrop",
-                     "A packet has been dropped in the MAC layer before being queued for transmission.",
-                     MakeTraceSourceAccessor (&VlcMac::m_macTxDropTrace))
-    .AddTraceSource ("MacPromiscRx",
-                     "A packet has been received by this device, has been passed up from the physical layer "
-                     "and is being forwarded up the local protocol stack.  This is a promiscuous trace,",
-                     MakeTraceSourceAccessor (&VlcMac::m_macPromiscRxTrace))
-    .AddTraceSource ("MacRx",
-                     "A packet has been received by this device, has been passed up from the physical layer "
-                     "and is being forwarded up the local protocol stack.  This is a non-promiscuous trace,",
-                     MakeTraceSourceAccessor (&VlcMac::m_macRxTrace))
-    .AddTraceSource ("MacRxDrop",
-                     "A packet has been dropped in the MAC layer after it has been passed up from the physical "
-                     "layer.",
-                     MakeTraceSourceAccessor (&VlcMac::m_macRxDropTrace))
-#if 0
-    // Not currently implemented in this device
-    .AddTraceSource ("Sniffer",
-                     "Trace source simulating a non-promiscuous packet sniffer attached to the device",
-                     MakeTraceSourceAccessor (&WifiMac::m_snifferTrace))
-#endif
-  ;
-
-  return tid;
+  NS_LOG_FUNCTION (this);
+  WifiMacHeader hdr = m_txopHdr;
+  m_txopPacket = 0;
+  // Reported as any acknowledged frame; continues the TXOP.
+  TxOk (hdr);
 }
 
 void
-VlcMac::SetMaxPropagationDelay (Time delay)
+VlcMac::TxopFailed (void)
 {
-  m_maxPropagationDelay = delay;
+  NS_LOG_FUNCTION (this);
+  // MacLow cancels the exchange of the previous frame when it starts the
+  // next one, after it was acknowledged.
+  if (m_txopPacket == 0)
+    {
+      return;
+    }
+  // The EDCAF retries the frame after a backoff.
+  m_edca[m_txopAc]->PushFront (m_txopPacket, m_txopHdr);
+  m_txopPacket = 0;
+  m_inTxop = false;
 }
 
 Time
-VlcMac::GetMsduLifetime (void) const
+VlcMac::GetTxopLimit (enum AcIndex ac) const
 {
-  return Seconds (10);
+  switch (ac)
+    {
+    case AC_BE:
+      return m_beTxopLimit;
+    case AC_BK:
+      return m_bkTxopLimit;
+    case AC_VI:
+      return m_viTxopLimit;
+    case AC_VO:
+      return m_voTxopLimit;
+    default:
+      NS_ASSERT (false);
+      return Seconds (0);
+    }
 }
-Time
-VlcMac::GetMaxPropagationDelay (void) const
+
+uint8_t
+VlcMac::GetQosTxopLimit (enum AcIndex ac) const
 {
-  return m_maxPropagationDelay;
+  int64_t units = (GetTxopLimit (ac).GetMicroSeconds () + 31) / 32;
+  return std::min<int64_t> (units, 255);
 }
 
-void
-VlcMac::NotifyTx (Ptr<const Packet> packet_vlc)
+Time
+VlcMac::GetDataAirtime (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
-  m_macTxTrace (packet_vlc);
+  uint32_t size = packet->GetSize () + hdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+  WifiTxVector txVector = m_stationManager->GetDataTxVector (hdr.GetAddr1 (), &hdr, packet, size);
+  return VlcPhy::CalculateTxDuration (size, txVector, WIFI_PREAMBLE_LONG);
 }
 
 void
-VlcMac::NotifyTxDrop (Ptr<const Packet> packet_vlc)
+VlcMac::NotifyTxQueueDrain (void)
 {
-  m_macTxDropTrace (packet_vlc);
+  if (m_txQueueCallback.IsNull ())
+    {
+      return;
+    }
+  m_txQueueCallback ();
+  if (!m_txQueueLifetimeEvent.IsRunning ())
+    {
+      m_txQueueLifetimeEvent = Simulator::Schedule (m_dca->GetQueue ()->GetMaxDelay (),
+                                                    &VlcMac::TxQueueLifetimeExpired, this);
+    }
 }
 
 void
-VlcMac::NotifyRx (Ptr<const Packet> packet_vlc)
+VlcMac::TxQueueLifetimeExpired (void)
 {
-  m_macRxTrace (packet_vlc);
+  NS_LOG_FUNCTION (this);
+  // GetTxQueueSize drops the expired frames of the DCF and EDCAF queues.
+  // The check is not rescheduled once the MAC is empty, so that an idle
+  // MAC leaves no event behind.
+  if (GetTxQueueSize () > 0)
+    {
+      NotifyTxQueueDrain ();
+    }
+  else if (!m_txQueueCallback.IsNull ())
+    {
+      m_txQueueCallback ();
+    }
 }
 
 void
-VlcMac::NotifyPromiscRx (Ptr<const Packet> packet_vlc)
+VlcMac::NotifyTx (Ptr<const Packet> packet)
 {
-  m_macPromiscRxTrace (packet_vlc);
+  m_counters.tx++;
+  m_counters.txBytes += packet->GetSize ();
+  WifiMac::NotifyTx (packet);
 }
 
 void
-VlcMac::NotifyRxDrop (Ptr<const Packet> packet_vlc)
+VlcMac::NotifyTxBatch (const PacketBatch &packets)
 {
-  m_macRxDropTrace (packet_vlc);
+  uint32_t bytes = 0;
+  for (PacketBatch::const_iterator i = packets.begin (); i != packets.end (); i++)
+    {
+      WifiMac::NotifyTx (i->first);
+      bytes += i->first->GetSize ();
+    }
+  m_counters.tx += packets.size ();
+  m_counters.txBytes += bytes;
+  m_macTxBatchTrace (packets.size (), bytes);
 }
 
 void
-VlcMac::ConfigureStandard (enum WifiPhyStandard standard)
+VlcMac::EnqueueBatch (const PacketBatch &packets)
 {
-  switch (standard)
+  for (PacketBatch::const_iterator i = packets.begin (); i != packets.end (); i++)
     {
-    case WIFI_PHY_STANDARD_80211a:
-      Configure80211a ();
-      break;
-    case WIFI_PHY_STANDARD_80211b:
-      Configure80211b ();
-      break;
-    case WIFI_PHY_STANDARD_80211g:
-      Configure80211g ();
-      break;
-    case WIFI_PHY_STANDARD_80211_10MHZ:
-      Configure80211_10Mhz ();
-      break;
-    case WIFI_PHY_STANDARD_80211_5MHZ:
-      Configure80211_5Mhz ();
-      break;
-    case WIFI_PHY_STANDARD_holland:
-      Configure80211a ();
-      break;
-    case WIFI_PHY_STANDARD_80211n_2_4GHZ:
-      Configure80211n_2_4Ghz ();
-      break;
-    case WIFI_PHY_STANDARD_80211n_5GHZ:
-      Configure80211n_5Ghz ();
-      break;
-    default:
-      NS_ASSERT (false);
-      break;
+      Enqueue (i->first, i->second);
     }
-  FinishConfigureStandard (standard);
 }
 
-void
-VlcMac::Configure80211a (void)
-{
-  SetSifs (MicroSeconds (16));
-  SetSlot (MicroSeconds (9));
-  SetEifsNoDifs (MicroSeconds (16 + 44));
-  SetPifs (MicroSeconds (16 + 9));
-  SetCtsTimeout (MicroSeconds (16 + 44 + 9 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (16 + 44 + 9 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+uint32_t
+VlcMac::GetTxQueueSize (void) const
+{
+  return 0;
 }
 
 void
-VlcMac::Configure80211b (void)
-{
-  SetSifs (MicroSeconds (10));
-  SetSlot (MicroSeconds (20));
-  SetEifsNoDifs (MicroSeconds (10 + 304));
-  SetPifs (MicroSeconds (10 + 20));
-  SetCtsTimeout (MicroSeconds (10 + 304 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (10 + 304 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+VlcMac::SetTxQueueCallback (Callback<void> callback)
+{
+  NS_LOG_FUNCTION (this);
+  m_txQueueCallback = callback;
 }
 
 void
-VlcMac::Configure80211g (void)
-{
-  SetSifs (MicroSeconds (10));
-  // Note no support for Short Slot Time as yet
-  SetSlot (MicroSeconds (20));
-  SetEifsNoDifs (MicroSeconds (10 + 304));
-  SetPifs (MicroSeconds (10 + 20));
-  SetCtsTimeout (MicroSeconds (10 + 304 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (10 + 304 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+VlcMac::NotifyTxDrop (Ptr<const Packet> packet)
+{
+  m_counters.txDrop++;
+  WifiMac::NotifyTxDrop (packet);
 }
 
 void
-VlcMac::Configure80211_10Mhz (void)
-{
-  SetSifs (MicroSeconds (32));
-  SetSlot (MicroSeconds (13));
-  SetEifsNoDifs (MicroSeconds (32 + 88));
-  SetPifs (MicroSeconds (32 + 13));
-  SetCtsTimeout (MicroSeconds (32 + 88 + 13 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (32 + 88 + 13 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+VlcMac::NotifyTxLifetimeDrop (Ptr<const Packet> packet)
+{
+  m_counters.lifetimeDrop++;
+  WifiMac::NotifyTxDrop (packet);
 }
 
 void
-VlcMac::Configure80211_5Mhz (void)
-{
-  SetSifs (MicroSeconds (64));
-  SetSlot (MicroSeconds (21));
-  SetEifsNoDifs (MicroSeconds (64 + 176));
-  SetPifs (MicroSeconds (64 + 21));
-  SetCtsTimeout (MicroSeconds (64 + 176 + 21 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (64 + 176 + 21 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+VlcMac::NotifyRx (Ptr<const Packet> packet)
+{
+  m_counters.rx++;
+  m_counters.rxBytes += packet->GetSize ();
+  WifiMac::NotifyRx (packet);
 }
 
 void
-VlcMac::Configure80211n_2_4Ghz (void)
+VlcMac::NotifyPromiscRx (Ptr<const Packet> packet)
 {
-  Configure80211g ();
-  SetRifs(MicroSeconds (2));
-  SetCtsTimeout (MicroSeconds (10 + 52 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (10 + 52 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+  m_counters.promiscRx++;
+  WifiMac::NotifyPromiscRx (packet);
 }
+
 void
-VlcMac::Configure80211n_5Ghz (void)
+VlcMac::NotifyRxDrop (Ptr<const Packet> packet)
+{
+  m_counters.rxDrop++;
+  WifiMac::NotifyRxDrop (packet);
+}
+
+VlcMac::Counters::Counters ()
+  : tx (0),
+    txBytes (0),
+    txDrop (0),
+    retryDrop (0),
+    lifetimeDrop (0),
+    rx (0),
+    rxBytes (0),
+    promiscRx (0),
+    rxDrop (0)
 {
-  Configure80211a ();
-  SetRifs(MicroSeconds (2));
-  SetCtsTimeout (MicroSeconds (10 + 52 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
-  SetAckTimeout (MicroSeconds (10 + 52 + 20 + GetDefaultMaxPropagationDelay ().GetMicroSeconds () * 2));
+}
+
+const VlcMac::Counters &
+VlcMac::GetCounters (void) const
+{
+  return m_counters;
 }
 
 void
-VlcMac::ConfigureDcf (Ptr<Dcf> dcf, uint32_t cwmin, uint32_t cwmax, enum AcIndex ac)
+VlcMac::ResetCounters (void)
 {
-  /* see IEE802.11 section 7.3.2.29 */
-  switch (ac)
-    {
-    case AC_VO:
-      dcf->SetMinCw ((cwmin + 1) / 4 - 1);
-      dcf->SetMaxCw ((cwmin + 1) / 2 - 1);
-      dcf->SetAifsn (2);
-      break;
-    case AC_VI:
-      dcf->SetMinCw ((cwmin + 1) / 2 - 1);
-      dcf->SetMaxCw (cwmin);
-      dcf->SetAifsn (2);
-      break;
-    case AC_BE:
-      dcf->SetMinCw (cwmin);
-      dcf->SetMaxCw (cwmax);
-      dcf->SetAifsn (3);
-      break;
-    case AC_BK:
-      dcf->SetMinCw (cwmin);
-      dcf->SetMaxCw (cwmax);
-      dcf->SetAifsn (7);
-      break;
-    case AC_BE_NQOS:
-      dcf->SetMinCw (cwmin);
-      dcf->SetMaxCw (cwmax);
-      dcf->SetAifsn (2);
-      break;
-    case AC_UNDEF:
-      NS_FATAL_ERROR ("I don't know what to do with this");
-      break;
-    }
+  m_counters = Counters ();
 }
+
 } // namespace ns3
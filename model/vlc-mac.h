@@ -17,434 +17,276 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
-#ifndef WIFI_MAC_H
-#define WIFI_MAC_H
+#ifndef VLC_MAC_H
+#define VLC_MAC_H
 
+#include "ns3/regular-wifi-mac.h"
+#include "ns3/qos-utils.h"
 #include "ns3/packet.h"
 #include "ns3/mac48-address.h"
-
-#include "vlc-phy.h"
-#include "ns3/wifi-remote-station-manager.h"
-#include "ssid.h"
-#include "ns3/qos-utils.h"
+#include "ns3/traced-callback.h"
+#include "ns3/event-id.h"
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
-class Dcf;
+class VlcTxopListener;
 
 /**
- * \brief base class for all MAC-level wifi objects.
+ * \brief base class for the VLC MAC layers.
  * \ingroup wifi
  *
- * This class encapsulates all the low-level MAC functionality
- * DCA, EDCA, etc) and all the high-level MAC functionality
- * (association/disassociation state machines).
+ * The VLC MACs are ns3::RegularWifiMac, so that they reuse the DCF, EDCA,
+ * MacLow and block ack machinery of the wifi module on top of a
+ * ns3::VlcPhy. This class adds what the ns3::VlcNetDevice needs beyond
+ * the ns3::WifiMac interface: the enqueueing of a burst of packets at
+ * once, the state of the transmission queues, and plain counters of the
+ * packets seen by the Notify methods.
  *
+ * With QoS, the MAC also continues the TXOP of an access category whose
+ * TXOP limit is not zero: once a unicast QoS data frame is acknowledged,
+ * the next frame of the same EDCAF queue is sent a SIFS later, without a
+ * new backoff, as long as its exchange ends within the limit. The DCF of
+ * a non-QoS MAC has no TXOP and always sends one frame per access.
  */
-class VlcMac : public Object
+class VlcMac : public RegularWifiMac
 {
 public:
   static TypeId GetTypeId (void);
 
-  /**
-   * \param slotTime the slot duration
-   */
-  virtual void SetSlot (Time slotTime) = 0;
-  /**
-   * \param sifs the sifs duration
-   */
-  virtual void SetSifs (Time sifs) = 0;
-  /**
-   * \param eifsNoDifs the duration of an EIFS minus DIFS.
-   *
-   * This value is used to calculate the EIFS depending
-   * on AIFSN.
-   */
-  virtual void SetEifsNoDifs (Time eifsNoDifs) = 0;
-  /**
-   * \param pifs the pifs duration.
-   */
-  virtual void SetPifs (Time pifs) = 0;
-/**
-   * \param rifs the rifs duration.
-   */
+  VlcMac ();
+  virtual ~VlcMac ();
 
-  virtual void SetRifs (Time rifs) = 0;
-  /**
-   * \param ctsTimeout the duration of a CTS timeout.
-   */
-  virtual void SetCtsTimeout (Time ctsTimeout) = 0;
-  /**
-   * \param ackTimeout the duration of an ACK timeout.
-   */
-  virtual void SetAckTimeout (Time ackTimeout) = 0;
   /**
-   * \param delay the max propagation delay.
+   * \param phy the physical layer attached to this MAC.
    *
-   * Unused for now.
-   */
-  void SetMaxPropagationDelay (Time delay);
-/**
-   * \return the current RIFS duration.
+   * A ns3::VlcPhy notifies the DcfManager of the MAC directly (see
+   * VlcPhy::RegisterDcfManager); any other PHY notifies it through a
+   * WifiPhyListener, as in RegularWifiMac.
    */
+  virtual void SetWifiPhy (Ptr<WifiPhy> phy);
 
-  virtual Time GetRifs (void) const = 0;
-
-  /**
-   * \return the current PIFS duration.
-   */
-  virtual Time GetPifs (void) const = 0;
-  /**
-   * \return the current SIFS duration.
-   */
-  virtual Time GetSifs (void) const = 0;
-  /**
-   * \return the current slot duration.
-   */
-  virtual Time GetSlot (void) const = 0;
-  /**
-   * \return the current EIFS minus DIFS duration
-   */
-  virtual Time GetEifsNoDifs (void) const = 0;
   /**
-   * \return the current CTS timeout duration.
-   */
-  virtual Time GetCtsTimeout (void) const = 0;
-  /**
-   * \return the current ACK timeout duration.
-   */
-  virtual Time GetAckTimeout (void) const = 0;
-  /**
-   * \return the maximum lifetime of an MSDU.
+   * Plain counters of the packets seen by the Notify methods, for the
+   * statistics which do not need a trace sink invoked per packet.
    *
-   * Unused for now.
-   */
-  Time GetMsduLifetime (void) const;
-  /**
-   * \return the maximum propagation delay.
-   * 
-   * Unused for now.
-   */
-  Time GetMaxPropagationDelay (void) const;
+   * The frames which outlive their lifetime in the DCF and EDCAF queues
+   * are dropped silently by ns3::WifiMacQueue and are not counted; only
+   * the frames the MAC holds itself (see StaVlcMac) are counted in
+   * lifetimeDrop.
+   */
+  struct Counters
+  {
+    Counters ();
 
-  /**
-   * \return the MAC address associated to this MAC layer.
-   */
-  virtual Mac48Address GetAddress (void) const = 0;
-  /**
-   * \return the ssid which this MAC layer is going to try to stay in.
-   */
-  virtual Ssid GetSsid (void) const = 0;
-  /**
-   * \param address the current address of this MAC layer.
-   */
-  virtual void SetAddress (Mac48Address address) = 0;
-  /**
-   * \param ssid the current ssid of this MAC layer.
-   */
-  virtual void SetSsid (Ssid ssid) = 0;
-  /**
-   * \return the bssid of the network this device belongs to.
-   */
-  virtual Mac48Address GetBssid (void) const = 0;
-  /**
-   * \brief Sets the interface in promiscuous mode.
-   *
-   * Enables promiscuous mode on the interface. Note that any further
-   * filtering on the incoming frame path may affect the overall
-   * behavior.
-   */
-  virtual void SetPromisc (void) = 0;
+    uint64_t tx;           //!< Packets accepted for transmission (MacTx)
+    uint64_t txBytes;      //!< Bytes of these packets
+    uint64_t txDrop;       //!< Packets dropped before transmission (MacTxDrop)
+    uint64_t retryDrop;    //!< Frames dropped after their last retry
+    uint64_t lifetimeDrop; //!< Packets held by the MAC past their lifetime (MacTxDrop)
+    uint64_t rx;           //!< Packets forwarded up (MacRx)
+    uint64_t rxBytes;      //!< Bytes of these packets
+    uint64_t promiscRx;    //!< Packets forwarded up promiscuously (MacPromiscRx)
+    uint64_t rxDrop;       //!< Packets dropped during reception (MacRxDrop)
+  };
 
   /**
-   * \param packet the packet to send.
-   * \param to the address to which the packet should be sent.
-   * \param from the address from which the packet should be sent.
-   *
-   * The packet should be enqueued in a tx queue, and should be
-   * dequeued as soon as the DCF function determines that
-   * access it granted to this MAC.  The extra parameter "from" allows
-   * this device to operate in a bridged mode, forwarding received
-   * frames without altering the source address.
+   * A burst of packets with their destinations.
    */
-  virtual void Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to, Mac48Address from) = 0;
+  typedef std::vector<std::pair<Ptr<const Packet>, Mac48Address> > PacketBatch;
   /**
-   * \param packet the packet to send.
-   * \param to the address to which the packet should be sent.
+   * \param packets the packets to send with their destinations.
    *
-   * The packet should be enqueued in a tx queue, and should be
-   * dequeued as soon as the DCF function determines that
-   * access it granted to this MAC.
+   * Enqueue a burst of packets at once. The default implementation
+   * calls Enqueue for each packet; the MACs override it to build the
+   * MAC header once per destination and TID of the burst.
    */
-  virtual void Enqueue (Ptr<const Packet> packet_vlc, Mac48Address to) = 0;
+  virtual void EnqueueBatch (const PacketBatch &packets);
   /**
-   * \return if this MAC supports sending from arbitrary address.
+   * \return the number of frames waiting for transmission in the MAC.
    *
-   * The interface may or may not support sending from arbitrary address.
-   * This function returns true if sending from arbitrary address is supported,
-   * false otherwise.
-   */
-  virtual bool SupportsSendFrom (void) const = 0;
-  /**
-   * \param phy the physical layer attached to this MAC.
-   */
-  virtual void SetVlcPhy (Ptr<VlcPhy> phy) = 0;
-  /**
-   * \param stationManager the station manager attached to this MAC.
-   */
-  virtual void SetWifiRemoteStationManager (Ptr<WifiRemoteStationManager> stationManager) = 0;
-  /**
-   * \param upCallback the callback to invoke when a packet must be forwarded up the stack.
-   */
-  virtual void SetForwardUpCallback (Callback<void,Ptr<Packet>, Mac48Address, Mac48Address> upCallback) = 0;
-  /**
-   * \param linkUp the callback to invoke when the link becomes up.
+   * The default implementation reports an empty MAC.
    */
-  virtual void SetLinkUpCallback (Callback<void> linkUp) = 0;
+  virtual uint32_t GetTxQueueSize (void) const;
   /**
-   * \param linkDown the callback to invoke when the link becomes down.
-   */
-  virtual void SetLinkDownCallback (Callback<void> linkDown) = 0;
-  /* Next functions are not pure virtual so non Qos WifiMacs are not
-   * forced to implement them.
+   * \param callback the callback to invoke when frames may have left the
+   *        transmission queues of the MAC, so that the device can resume
+   *        a stopped queue.
+   *
+   * See NotifyTxQueueDrain for the events which invoke the callback.
    */
+  void SetTxQueueCallback (Callback<void> callback);
 
   /**
-   * \param blockAckTimeout the duration for basic block ACK timeout.
+   * \param packet the packet being enqueued
    *
-   * Sets the timeout for basic block ACK.
-   */
-  virtual void SetBasicBlockAckTimeout (Time blockAckTimeout);
-  /**
-   * \return the current basic block ACK timeout duration.
+   * Count the packet and fire the MacTx trace of ns3::WifiMac.
    */
-  virtual Time GetBasicBlockAckTimeout (void) const;
+  void NotifyTx (Ptr<const Packet> packet);
   /**
-   * \param blockAckTimeout
+   * \param packets the packets being enqueued
    *
-   * Sets the timeout for compressed block ACK.
-   */
-  virtual void SetCompressedBlockAckTimeout (Time blockAckTimeout);
-  /**
-   * \return the current compressed block ACK timeout duration.
+   * Count the packets, fire the MacTx trace of ns3::WifiMac for each of
+   * them, as NotifyTx does for a single packet, and fire the MacTxBatch
+   * trace once for the burst. The MacTx sinks thus see the same packets
+   * whether the device sends them one by one or in a burst; a sink
+   * connected to both traces sees each packet of a burst twice, and
+   * should only count the packets from one of them.
    */
-  virtual Time GetCompressedBlockAckTimeout (void) const;
-
+  void NotifyTxBatch (const PacketBatch &packets);
   /**
-   * \param packet the packet being enqueued
+   * \param packet the packet being dropped
    *
-   * Public method used to fire a MacTx trace.  Implemented for encapsulation
-   * purposes.  Note this trace indicates that the packet was accepted by the
-   * device only.  The packet may be dropped later (e.g. if the queue is full).
+   * Count the packet and fire the MacTxDrop trace of ns3::WifiMac.
    */
-  void NotifyTx (Ptr<const Packet> packet_vlc);
-
+  void NotifyTxDrop (Ptr<const Packet> packet);
   /**
-   * \param packet the packet being dropped
-   * 
-   * Public method used to fire a MacTxDrop trace.  Implemented for encapsulation
-   * purposes.  This trace indicates that the packet was dropped before it was
-   * transmitted (e.g. when a STA is not associated with an AP).
+   * \param packet the packet held by the MAC past its lifetime
+   *
+   * Count the packet as expired and fire the MacTxDrop trace of
+   * ns3::WifiMac.
    */
-  void NotifyTxDrop (Ptr<const Packet> packet_vlc);
-
+  void NotifyTxLifetimeDrop (Ptr<const Packet> packet);
   /**
    * \param packet the packet we received
-   * 
-   * Public method used to fire a MacRx trace.  Implemented for encapsulation
-   * purposes.
+   *
+   * Count the packet and fire the MacRx trace of ns3::WifiMac.
    */
-  void NotifyRx (Ptr<const Packet> packet_vlc);
-
+  void NotifyRx (Ptr<const Packet> packet);
   /**
    * \param packet the packet we received promiscuously
    *
-   * Public method used to fire a MacPromiscRx trace.  Implemented for encapsulation
-   * purposes.
+   * Count the packet and fire the MacPromiscRx trace of ns3::WifiMac.
    */
-  void NotifyPromiscRx (Ptr<const Packet> packet_vlc);
-
+  void NotifyPromiscRx (Ptr<const Packet> packet);
   /**
    * \param packet the packet we received but is not destined for us
-   * 
-   * Public method used to fire a MacRxDrop trace.  Implemented for encapsulation
-   * purposes.
-   */
-  void NotifyRxDrop (Ptr<const Packet> packet_vlc);
-  /**
-   * \param standard the wifi standard to be configured
-   */
-  void ConfigureStandard (enum WifiPhyStandard standard);
-
-protected:
-  /**
-   * \param dcf the DCF to be configured
-   * \param cwmin the minimum congestion window for the DCF
-   * \param cwmax the maximum congestion window for the DCF
-   * \param ac the access category for the DCF
    *
-   * Configure the DCF with appropriate values depending on the given access category.
+   * Count the packet and fire the MacRxDrop trace of ns3::WifiMac.
    */
-  void ConfigureDcf (Ptr<Dcf> dcf, uint32_t cwmin, uint32_t cwmax, enum AcIndex ac);
-private:
-  /**
-   * \return the default maximum propagation delay
-   *
-   * By default, we get the maximum propagation delay from 1000 m and speed of light
-   * (3e8 m/s).
-   */
-  static Time GetDefaultMaxPropagationDelay (void);
+  void NotifyRxDrop (Ptr<const Packet> packet);
   /**
-   * \return the default slot duration
-   * 
-   * Return a default slot value for 802.11a (9 microseconds).
+   * \return the counters updated by the Notify methods
    */
-  static Time GetDefaultSlot (void);
+  const Counters & GetCounters (void) const;
   /**
-   * \return the default short interframe space (SIFS)
-   * 
-   * Return a default SIFS value for 802.11a (16 microseconds).
+   * Set all the counters to zero.
    */
-  static Time GetDefaultSifs (void);
-  /**
-   * \return the default reduced interframe space (RIFS)
-   * 
-   * Return a default RIFS value for 802.11n (2 microseconds).
-   */
-  static Time GetDefaultRifs (void);
-  /**
-   * \return the default extended interframe space (EIFS) without
-   *          DCF interframe space (DIFS)
-   * 
-   * Return default SIFS + default CTS-ACK delay
-   */
-  static Time GetDefaultEifsNoDifs (void);
-  /**
-   * \return the default CTS-ACK delay
-   * 
-   * Return a default value for 802.11a at 6Mbps (44 microseconds)
-   */
-  static Time GetDefaultCtsAckDelay (void);
+  void ResetCounters (void);
+
+protected:
+  virtual void DoDispose (void);
   /**
-   * \return the default CTS and ACK timeout
-   * 
-   * Return the default CTS and ACK timeout.
-   * Cts_Timeout and Ack_Timeout are specified in the Annex C
-   * (Formal description of MAC operation, see details on the
-   * Trsp timer setting at page 346)
+   * \param hdr the header of the frame whose exchange succeeded
    */
-  static Time GetDefaultCtsAckTimeout (void);
+  virtual void TxOk (const WifiMacHeader &hdr);
   /**
-   * Return the default basic block ACK delay.
-   * Currently it returns 250 microseconds.
+   * \param hdr the header of the frame dropped after its last retry
    *
-   * \return the default basic block ACK delay
+   * Counts the frame in the retryDrop counter.
    */
-  static Time GetDefaultBasicBlockAckDelay (void);
+  virtual void TxFailed (const WifiMacHeader &hdr);
   /**
-   * Return the default basic block ACK timeout.
-   *
-   * \return the default basic block ACK timeout
+   * \param ac the access category
+   * \return the TXOP limit of the access category
    */
-  static Time GetDefaultBasicBlockAckTimeout (void);
+  Time GetTxopLimit (enum AcIndex ac) const;
   /**
-   * Return the default compressed block ACK delay.
-   * Currently it returns 76 microseconds.
-   *
-   * \return the default compressed block ACK delay
+   * \param ac the access category
+   * \return the TXOP limit of the access category in the units of the
+   *         QoS control field (32 us)
    */
-  static Time GetDefaultCompressedBlockAckDelay (void);
+  uint8_t GetQosTxopLimit (enum AcIndex ac) const;
   /**
-   * Return the default compressed block ACK timeout.
+   * Estimate the airtime of a data frame at the current rate of its
+   * receiver.
    *
-   * \return the default compressed block ACK timeout
+   * \param packet the packet
+   * \param hdr the MAC header of the packet
+   * \return the estimated airtime
    */
-  static Time GetDefaultCompressedBlockAckTimeout (void);
+  Time GetDataAirtime (Ptr<const Packet> packet, const WifiMacHeader &hdr);
   /**
-   * \param standard the phy standard to be used
-   *
-   * This method is called by ns3::WifiMac::ConfigureStandard to complete
-   * the configuration process for a requested phy standard. Subclasses should
-   * implement this method to configure their dcf queues according to the
-   * requested standard.
+   * Called whenever frames may have left the transmission queues: when
+   * the PHY starts transmitting a frame, which covers the frames sent
+   * without an ACK and those acknowledged by a block ack, when the DCF or
+   * an EDCAF reports the end of an exchange, and when queued frames may
+   * have outlived the lifetime of the DCF queue. Invokes the callback set
+   * with SetTxQueueCallback; subclasses which hold frames outside of the
+   * DCF and EDCAF queues override it to refill them first.
    */
-  virtual void FinishConfigureStandard (enum WifiPhyStandard standard) = 0;
+  virtual void NotifyTxQueueDrain (void);
 
-  Time m_maxPropagationDelay;
+private:
+  friend class VlcTxopListener;
 
   /**
-   * Configure appropriate timing parameters for 802.11a.
-   */
-  void Configure80211a (void);
-  /**
-   * Configure appropriate timing parameters for 802.11b.
-   */
-  void Configure80211b (void);
-  /**
-   * Configure appropriate timing parameters for 802.11g.
-   */
-  void Configure80211g (void);
-  /**
-   * Configure appropriate timing parameters for 802.11 with 10Mhz channel spacing.
+   * \param ac the access category of the frame just acknowledged
+   *
+   * Schedule the next frame of the TXOP of the access category a SIFS
+   * from now, if its TXOP limit is not zero. The TXOP starts with the
+   * first frame acknowledged outside of a TXOP.
    */
-  void Configure80211_10Mhz (void);
+  void ContinueTxop (enum AcIndex ac);
   /**
-   * Configure appropriate timing parameters for 802.11 with 5Mhz channel spacing.
+   * Send the frame at the head of the EDCAF queue of the current TXOP,
+   * or end the TXOP if the queue is empty, if the frame is group
+   * addressed or covered by a block ack agreement, if the medium is
+   * not idle, or if its exchange would end past the TXOP limit.
    */
-  void Configure80211_5Mhz ();
+  void SendNextInTxop (void);
   /**
-   * Configure appropriate timing parameters for 802.11n operating at 2.4Ghz.
+   * \param packet the packet
+   * \param hdr the MAC header of the packet
+   * \return the duration of the data frame, a SIFS and the ACK
    */
-  void Configure80211n_2_4Ghz (void);
+  Time GetExchangeDuration (Ptr<const Packet> packet, const WifiMacHeader &hdr);
   /**
-   * Configure appropriate timing parameters for 802.11n operating at 5Ghz.
+   * The frame sent in the TXOP was acknowledged.
    */
-  void Configure80211n_5Ghz (void);
-
+  void TxopGotAck (void);
   /**
-   * The trace source fired when packets come into the "top" of the device
-   * at the L3/L2 transition, before being queued for transmission.
-   *
-   * \see class CallBackTraceSource
+   * The frame sent in the TXOP was not acknowledged, or its exchange
+   * was cancelled: give it back to its EDCAF and end the TXOP.
    */
-  TracedCallback<Ptr<const Packet> > m_macTxTrace;
-
+  void TxopFailed (void);
   /**
-   * The trace source fired when packets coming into the "top" of the device
-   * are dropped at the MAC layer during transmission.
-   *
-   * \see class CallBackTraceSource
+   * \param packet the frame the PHY starts transmitting
    */
-  TracedCallback<Ptr<const Packet> > m_macTxDropTrace;
-
+  void PhyTxBegin (Ptr<const Packet> packet);
   /**
-   * The trace source fired for packets successfully received by the device
-   * immediately before being forwarded up to higher layers (at the L2/L3
-   * transition).  This is a promiscuous trace.
-   *
-   * \see class CallBackTraceSource
+   * Check the queues again once the frames queued so far have outlived
+   * their lifetime, since the DCF queue drops them silently.
    */
-  TracedCallback<Ptr<const Packet> > m_macPromiscRxTrace;
+  void TxQueueLifetimeExpired (void);
 
   /**
-   * The trace source fired for packets successfully received by the device
-   * immediately before being forwarded up to higher layers (at the L2/L3
-   * transition).  This is a non- promiscuous trace.
+   * The trace source fired once per burst of packets accepted by
+   * EnqueueBatch, with the number of packets and their total size.
    *
    * \see class CallBackTraceSource
    */
-  TracedCallback<Ptr<const Packet> > m_macRxTrace;
+  TracedCallback<uint32_t, uint32_t> m_macTxBatchTrace;
 
-  /**
-   * The trace source fired when packets coming into the "top" of the device
-   * are dropped at the MAC layer during reception.
-   *
-   * \see class CallBackTraceSource
-   */
-  TracedCallback<Ptr<const Packet> > m_macRxDropTrace;
+  Counters m_counters; //!< Counters updated by the Notify methods
+  Callback<void> m_txQueueCallback; //!< Invoked when frames may have left the MAC
+  EventId m_txQueueLifetimeEvent;   //!< Next check of the expired frames
 
+  Time m_beTxopLimit; //!< TXOP limit of AC_BE
+  Time m_bkTxopLimit; //!< TXOP limit of AC_BK
+  Time m_viTxopLimit; //!< TXOP limit of AC_VI
+  Time m_voTxopLimit; //!< TXOP limit of AC_VO
+  bool m_inTxop;               //!< Flag if a TXOP is being continued
+  enum AcIndex m_txopAc;       //!< Access category of the current TXOP
+  Time m_txopStart;            //!< Start of the current TXOP
+  Time m_lastTxBegin;          //!< Start of the last frame transmitted
+  EventId m_txopEvent;         //!< Next frame of the current TXOP
+  Ptr<const Packet> m_txopPacket; //!< Frame sent in the TXOP, until its exchange ends
+  WifiMacHeader m_txopHdr;     //!< MAC header of m_txopPacket
+  VlcTxopListener *m_txopListener; //!< Listener of the exchanges of the TXOP
 };
 
 } // namespace ns3
 
-#endif /* WIFI_MAC_H */
+#endif /* VLC_MAC_H */
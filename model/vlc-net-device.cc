@@ -23,12 +23,19 @@
 #include "ns3/wifi-remote-station-manager.h"
 #include "vlc-channel.h"
 #include "ns3/llc-snap-header.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "vlc-compact-llc-header.h"
+#include "vlc-header-compressor.h"
+#include "ns3/boolean.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/enum.h"
 #include "ns3/node.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("vlcNetDevice");
 
@@ -43,11 +50,14 @@ VlcNetDevice::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::VlcNetDevice")
     .SetParent<NetDevice> ()
     .AddConstructor<VlcNetDevice> ()
-    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit",
+    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit. Values above the "
+                   "802.11 limit of 2296 bytes enable jumbo frames, and raise the fragmentation "
+                   "threshold of the remote station manager to match. The frames must also fit "
+                   "the PLCP header of the PHY: 4057 bytes for the non-HT PHYs.",
                    UintegerValue (MAX_MSDU_SIZE - LLC_SNAP_HEADER_LENGTH),
                    MakeUintegerAccessor (&VlcNetDevice::SetMtu,
                                          &VlcNetDevice::GetMtu),
-                   MakeUintegerChecker<uint16_t> (1,MAX_MSDU_SIZE - LLC_SNAP_HEADER_LENGTH))
+                   MakeUintegerChecker<uint16_t> (1,MAX_JUMBO_MSDU_SIZE - LLC_SNAP_HEADER_LENGTH))
     .AddAttribute ("Channel", "The channel attached to this device",
                    PointerValue (),
                    MakePointerAccessor (&VlcNetDevice::DoGetChannel),
@@ -56,7 +66,7 @@ VlcNetDevice::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&VlcNetDevice::GetPhy,
                                         &VlcNetDevice::SetPhy),
-                   MakePointerChecker<WifiPhy> ())
+                   MakePointerChecker<VlcPhy> ())
     .AddAttribute ("Mac", "The MAC layer attached to this device.",
                    PointerValue (),
                    MakePointerAccessor (&VlcNetDevice::GetMac,
@@ -67,14 +77,64 @@ VlcNetDevice::GetTypeId (void)
                    MakePointerAccessor (&VlcNetDevice::SetRemoteStationManager,
                                         &VlcNetDevice::GetRemoteStationManager),
                    MakePointerChecker<WifiRemoteStationManager> ())
+    .AddAttribute ("UplinkDevice", "The device carrying the uplink of a hybrid link.",
+                   PointerValue (),
+                   MakePointerAccessor (&VlcNetDevice::SetUplinkDevice,
+                                        &VlcNetDevice::GetUplinkDevice),
+                   MakePointerChecker<NetDevice> ())
+    .AddAttribute ("HybridMode",
+                   "How the traffic is shared with the uplink device: Off sends and "
+                   "receives everything over VLC, Ap sends over VLC and also receives "
+                   "from the uplink device, Sta receives over VLC and sends over the "
+                   "uplink device.",
+                   EnumValue (HYBRID_OFF),
+                   MakeEnumAccessor (&VlcNetDevice::m_hybridMode),
+                   MakeEnumChecker (HYBRID_OFF, "Off",
+                                    HYBRID_AP, "Ap",
+                                    HYBRID_STA, "Sta"))
+    .AddAttribute ("CompactFraming",
+                   "If true, the 8-byte LLC/SNAP header of the frames we send is replaced "
+                   "by a 2-byte ethertype, except for the ethertypes starting with 0xaa. "
+                   "Frames in both formats are always accepted.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&VlcNetDevice::m_compactFraming),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HeaderCompression",
+                   "If true, the IP/UDP headers of the packets we send are compressed. "
+                   "Compressed packets are always accepted.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&VlcNetDevice::m_headerCompression),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HeaderCompressor", "The IP/UDP header compressor of this device.",
+                   PointerValue (),
+                   MakePointerAccessor (&VlcNetDevice::GetHeaderCompressor),
+                   MakePointerChecker<VlcHeaderCompressor> ())
+    .AddAttribute ("MaxQueuedPackets",
+                   "The number of frames waiting in the MAC from which Send refuses packets "
+                   "(and returns false) until the MAC drains. Zero disables the flow control.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&VlcNetDevice::m_maxQueuedPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("WakeQueuedPackets",
+                   "The number of frames waiting in the MAC at or below which a stopped device "
+                   "accepts packets again. Zero means half of MaxQueuedPackets.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&VlcNetDevice::m_wakeQueuedPackets),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 VlcNetDevice::VlcNetDevice ()
-  : m_configComplete (false)
+  : m_hybridMode (HYBRID_OFF),
+    m_compactFraming (false),
+    m_headerCompression (false),
+    m_queueStopped (false),
+    m_savedFragmentationThreshold (0),
+    m_configComplete (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_compressor = CreateObject<VlcHeaderCompressor> ();
 }
 VlcNetDevice::~VlcNetDevice ()
 {
@@ -89,9 +149,12 @@ VlcNetDevice::DoDispose (void)
   m_mac->Dispose ();
   m_phy->Dispose ();
   m_stationManager->Dispose ();
+  m_compressor->Dispose ();
+  m_compressor = 0;
   m_mac = 0;
   m_phy = 0;
   m_stationManager = 0;
+  m_uplink = 0;
   // chain up.
   NetDevice::DoDispose ();
 }
@@ -117,11 +180,18 @@ VlcNetDevice::CompleteConfig (void)
       return;
     }
   m_mac->SetWifiRemoteStationManager (m_stationManager);
-  m_mac->SetVlcPhy (m_phy);
+  m_mac->SetWifiPhy (m_phy);
   m_mac->SetForwardUpCallback (MakeCallback (&VlcNetDevice::ForwardUp, this));
   m_mac->SetLinkUpCallback (MakeCallback (&VlcNetDevice::LinkUp, this));
   m_mac->SetLinkDownCallback (MakeCallback (&VlcNetDevice::LinkDown, this));
+  m_mac->SetTxQueueCallback (MakeCallback (&VlcNetDevice::UpdateQueueState, this));
   m_stationManager->SetupPhy (m_phy);
+  if (m_mtu > GetMaxMtu ())
+    {
+      NS_LOG_WARN ("mtu=" << m_mtu << " does not fit the PHY, lowered to " << GetMaxMtu ());
+      m_mtu = GetMaxMtu ();
+    }
+  UpdateFragmentationThreshold ();
   m_configComplete = true;
 }
 
@@ -129,6 +199,7 @@ void
 VlcNetDevice::SetMac (Ptr<VlcMac> mac)
 {
   m_mac = mac;
+  UpdateUplinkAddress ();
   CompleteConfig ();
 }
 void
@@ -158,6 +229,44 @@ VlcNetDevice::GetRemoteStationManager (void) const
 {
   return m_stationManager;
 }
+void
+VlcNetDevice::SetUplinkDevice (Ptr<NetDevice> device)
+{
+  m_uplink = device;
+  if (m_uplink == 0)
+    {
+      return;
+    }
+  UpdateUplinkAddress ();
+  m_uplink->SetReceiveCallback (MakeCallback (&VlcNetDevice::ReceiveFromUplink, this));
+}
+void
+VlcNetDevice::UpdateUplinkAddress (void)
+{
+  // A single address for both directions: the peer answers the frames
+  // received over the uplink to the address of this device. The uplink
+  // device keeps its own address, which the VLC MAC takes.
+  if (m_uplink == 0 || m_mac == 0)
+    {
+      return;
+    }
+  Mac48Address address = Mac48Address::ConvertFrom (m_uplink->GetAddress ());
+  if (m_mac->GetAddress () != address)
+    {
+      m_mac->SetAddress (address);
+    }
+}
+Ptr<NetDevice>
+VlcNetDevice::GetUplinkDevice (void) const
+{
+  return m_uplink;
+}
+
+Ptr<VlcHeaderCompressor>
+VlcNetDevice::GetHeaderCompressor (void) const
+{
+  return m_compressor;
+}
 
 void
 VlcNetDevice::SetIfIndex (const uint32_t index)
@@ -177,28 +286,90 @@ VlcNetDevice::GetChannel (void) const
 Ptr<VlcChannel>
 VlcNetDevice::DoGetChannel (void) const
 {
-  return m_phy->GetChannel ();
+  return DynamicCast<VlcChannel> (m_phy->GetChannel ());
 }
 void
 VlcNetDevice::SetAddress (Address address)
 {
   m_mac->SetAddress (Mac48Address::ConvertFrom (address));
+  UpdateUplinkAddress ();
 }
 Address
 VlcNetDevice::GetAddress (void) const
 {
+  if (m_uplink != 0)
+    {
+      return m_uplink->GetAddress ();
+    }
   return m_mac->GetAddress ();
 }
 bool
 VlcNetDevice::SetMtu (const uint16_t mtu)
 {
-  if (mtu > MAX_MSDU_SIZE - LLC_SNAP_HEADER_LENGTH)
+  if (mtu > GetMaxMtu ())
     {
       return false;
     }
   m_mtu = mtu;
+  UpdateFragmentationThreshold ();
   return true;
 }
+
+uint16_t
+VlcNetDevice::GetMaxMtu (void) const
+{
+  uint32_t maxMsdu = MAX_JUMBO_MSDU_SIZE;
+  if (m_phy != 0)
+    {
+      // The LENGTH field of the PLCP header of the DSSS and OFDM PHYs has
+      // 12 bits, the one of the HT-SIG field 16 bits.
+      uint32_t maxPsdu = m_phy->GetNMcs () > 0 ? 65535 : 4095;
+      WifiMacHeader hdr;
+      hdr.SetType (WIFI_MAC_QOSDATA);
+      maxMsdu = std::min (maxMsdu, maxPsdu - hdr.GetSize () - WIFI_MAC_FCS_LENGTH);
+    }
+  return maxMsdu - LLC_SNAP_HEADER_LENGTH;
+}
+
+void
+VlcNetDevice::UpdateFragmentationThreshold (void)
+{
+  if (m_stationManager == 0)
+    {
+      return;
+    }
+  uint32_t threshold = 0;
+  if (m_mtu > MAX_MSDU_SIZE - LLC_SNAP_HEADER_LENGTH)
+    {
+      WifiMacHeader hdr;
+      hdr.SetType (WIFI_MAC_QOSDATA);
+      threshold = m_mtu + LLC_SNAP_HEADER_LENGTH + hdr.GetSize () + WIFI_MAC_FCS_LENGTH;
+      // The station manager only accepts even thresholds
+      threshold += threshold % 2;
+    }
+  if (m_savedFragmentationThreshold != 0)
+    {
+      // We raised the threshold for a larger MTU: follow the new MTU, but
+      // never go below the threshold we found.
+      if (threshold <= m_savedFragmentationThreshold)
+        {
+          NS_LOG_DEBUG ("fragmentation threshold restored to " << m_savedFragmentationThreshold << " for mtu=" << m_mtu);
+          m_stationManager->SetFragmentationThreshold (m_savedFragmentationThreshold);
+          m_savedFragmentationThreshold = 0;
+        }
+      else
+        {
+          NS_LOG_DEBUG ("fragmentation threshold set to " << threshold << " for mtu=" << m_mtu);
+          m_stationManager->SetFragmentationThreshold (threshold);
+        }
+    }
+  else if (m_stationManager->GetFragmentationThreshold () < threshold)
+    {
+      NS_LOG_DEBUG ("fragmentation threshold raised to " << threshold << " for mtu=" << m_mtu);
+      m_savedFragmentationThreshold = m_stationManager->GetFragmentationThreshold ();
+      m_stationManager->SetFragmentationThreshold (threshold);
+    }
+}
 uint16_t
 VlcNetDevice::GetMtu (void) const
 {
@@ -255,14 +426,137 @@ VlcNetDevice::Send (Ptr<Packet> packet_vlc, const Address& dest, uint16_t protoc
 
   Mac48Address realTo = Mac48Address::ConvertFrom (dest);
 
-  LlcSnapHeader llc;
-  llc.SetType (protocolNumber);
-  packet_vlc->AddHeader (llc);
+  UpdateUplinkAddress ();
+  if (m_hybridMode == HYBRID_STA && m_uplink != 0)
+    {
+      return m_uplink->Send (packet_vlc, dest, protocolNumber);
+    }
+  if (!IsQueueAvailable ())
+    {
+      m_mac->NotifyTxDrop (packet_vlc);
+      return false;
+    }
+
+  if (m_headerCompression)
+    {
+      m_compressor->Compress (packet_vlc, protocolNumber, m_mac->GetAddress (), realTo);
+    }
+  AddLlcHeader (packet_vlc, protocolNumber);
 
   m_mac->NotifyTx (packet_vlc);
   m_mac->Enqueue (packet_vlc, realTo);
+  UpdateQueueState ();
   return true;
 }
+uint32_t
+VlcNetDevice::GetQueuedPackets (void) const
+{
+  return m_mac->GetTxQueueSize ();
+}
+
+bool
+VlcNetDevice::IsQueueStopped (void) const
+{
+  return m_queueStopped;
+}
+
+void
+VlcNetDevice::SetQueueStopCallback (Callback<void> callback)
+{
+  m_queueStop = callback;
+}
+
+void
+VlcNetDevice::SetQueueWakeCallback (Callback<void> callback)
+{
+  m_queueWake = callback;
+}
+
+void
+VlcNetDevice::UpdateQueueState (void)
+{
+  if (m_maxQueuedPackets == 0)
+    {
+      return;
+    }
+  uint32_t queued = m_mac->GetTxQueueSize ();
+  uint32_t wake = m_wakeQueuedPackets != 0 ? m_wakeQueuedPackets : m_maxQueuedPackets / 2;
+  if (!m_queueStopped && queued >= m_maxQueuedPackets)
+    {
+      NS_LOG_DEBUG ("stop queue, " << queued << " frames in the MAC");
+      m_queueStopped = true;
+      if (!m_queueStop.IsNull ())
+        {
+          m_queueStop ();
+        }
+    }
+  else if (m_queueStopped && queued <= wake)
+    {
+      NS_LOG_DEBUG ("wake queue, " << queued << " frames in the MAC");
+      m_queueStopped = false;
+      if (!m_queueWake.IsNull ())
+        {
+          m_queueWake ();
+        }
+    }
+}
+
+bool
+VlcNetDevice::IsQueueAvailable (void)
+{
+  if (m_maxQueuedPackets == 0)
+    {
+      return true;
+    }
+  // Frames may also leave the MAC without a TxOk/TxFailed (e.g. when
+  // their lifetime expires), so check again before refusing.
+  UpdateQueueState ();
+  return !m_queueStopped;
+}
+
+bool
+VlcNetDevice::SendBatch (const std::vector<std::pair<Ptr<Packet>, Address> > &packets, uint16_t protocolNumber)
+{
+  UpdateUplinkAddress ();
+  if (m_hybridMode == HYBRID_STA && m_uplink != 0)
+    {
+      bool sent = true;
+      for (std::vector<std::pair<Ptr<Packet>, Address> >::const_iterator i = packets.begin (); i != packets.end (); i++)
+        {
+          sent = m_uplink->Send (i->first, i->second, protocolNumber) && sent;
+        }
+      return sent;
+    }
+  if (!IsQueueAvailable ())
+    {
+      for (std::vector<std::pair<Ptr<Packet>, Address> >::const_iterator i = packets.begin (); i != packets.end (); i++)
+        {
+          m_mac->NotifyTxDrop (i->first);
+        }
+      return false;
+    }
+
+  VlcMac::PacketBatch batch;
+  batch.reserve (packets.size ());
+  for (std::vector<std::pair<Ptr<Packet>, Address> >::const_iterator i = packets.begin (); i != packets.end (); i++)
+    {
+      NS_ASSERT (Mac48Address::IsMatchingType (i->second));
+      Mac48Address to = Mac48Address::ConvertFrom (i->second);
+      uint16_t protocol = protocolNumber;
+      if (m_headerCompression)
+        {
+          m_compressor->Compress (i->first, protocol, m_mac->GetAddress (), to);
+        }
+      AddLlcHeader (i->first, protocol);
+      batch.push_back (std::make_pair (Ptr<const Packet> (i->first), to));
+    }
+
+  m_mac->NotifyTxBatch (batch);
+  m_mac->EnqueueBatch (batch);
+  UpdateQueueState ();
+  return true;
+}
+
 Ptr<Node>
 VlcNetDevice::GetNode (void) const
 {
@@ -286,10 +580,52 @@ VlcNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
 }
 
 void
-VlcNetDevice::ForwardUp (Ptr<Packet> packet, Mac48Address from, Mac48Address to)
+VlcNetDevice::AddLlcHeader (Ptr<Packet> packet, uint16_t protocolNumber) const
 {
+  // The receiver tells the two formats apart from the first byte, which
+  // is always 0xaa with LLC/SNAP: an ethertype starting with 0xaa keeps
+  // its LLC/SNAP header.
+  if (m_compactFraming && VlcCompactLlcHeader::CanCompact (protocolNumber))
+    {
+      VlcCompactLlcHeader llc;
+      llc.SetType (protocolNumber);
+      packet->AddHeader (llc);
+    }
+  else
+    {
+      LlcSnapHeader llc;
+      llc.SetType (protocolNumber);
+      packet->AddHeader (llc);
+    }
+}
+
+uint16_t
+VlcNetDevice::RemoveLlcHeader (Ptr<Packet> packet) const
+{
+  // The sender may or may not use compact framing
+  uint8_t firstByte = 0xaa;
+  packet->CopyData (&firstByte, 1);
+  if (VlcCompactLlcHeader::IsCompact (firstByte))
+    {
+      VlcCompactLlcHeader llc;
+      packet->RemoveHeader (llc);
+      return llc.GetType ();
+    }
   LlcSnapHeader llc;
   packet->RemoveHeader (llc);
+  return llc.GetType ();
+}
+
+void
+VlcNetDevice::ForwardUp (Ptr<Packet> packet, Mac48Address from, Mac48Address to)
+{
+  uint16_t protocol = RemoveLlcHeader (packet);
+  if (protocol == VlcHeaderCompressor::PROT_NUMBER
+      && !m_compressor->Decompress (packet, protocol, from, to))
+    {
+      m_mac->NotifyRxDrop (packet);
+      return;
+    }
   enum NetDevice::PacketType type;
   if (to.IsBroadcast ())
     {
@@ -311,14 +647,27 @@ VlcNetDevice::ForwardUp (Ptr<Packet> packet, Mac48Address from, Mac48Address to)
   if (type != NetDevice::PACKET_OTHERHOST)
     {
       m_mac->NotifyRx (packet);
-      m_forwardUp (this, packet, llc.GetType (), from);
+      m_forwardUp (this, packet, protocol, from);
     }
 
   if (!m_promiscRx.IsNull ())
     {
       m_mac->NotifyPromiscRx (packet);
-      m_promiscRx (this, packet, llc.GetType (), from, to, type);
+      m_promiscRx (this, packet, protocol, from, to, type);
+    }
+}
+
+bool
+VlcNetDevice::ReceiveFromUplink (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                 const Address &from)
+{
+  NS_LOG_FUNCTION (this << device << packet << protocol << from);
+  if (m_hybridMode == HYBRID_OFF || m_forwardUp.IsNull ())
+    {
+      return false;
     }
+  m_mac->NotifyRx (packet);
+  return m_forwardUp (this, packet, protocol, from);
 }
 
 void
@@ -343,12 +692,26 @@ VlcNetDevice::SendFrom (Ptr<Packet> packet_vlc, const Address& source, const Add
   Mac48Address realTo = Mac48Address::ConvertFrom (dest);
   Mac48Address realFrom = Mac48Address::ConvertFrom (source);
 
-  LlcSnapHeader llc;
-  llc.SetType (protocolNumber);
-  packet_vlc->AddHeader (llc);
+  UpdateUplinkAddress ();
+  if (m_hybridMode == HYBRID_STA && m_uplink != 0)
+    {
+      return m_uplink->SendFrom (packet_vlc, source, dest, protocolNumber);
+    }
+  if (!IsQueueAvailable ())
+    {
+      m_mac->NotifyTxDrop (packet_vlc);
+      return false;
+    }
+
+  if (m_headerCompression)
+    {
+      m_compressor->Compress (packet_vlc, protocolNumber, realFrom, realTo);
+    }
+  AddLlcHeader (packet_vlc, protocolNumber);
 
   m_mac->NotifyTx (packet_vlc);
   m_mac->Enqueue (packet_vlc, realTo, realFrom);
+  UpdateQueueState ();
 
   return true;
 }
@@ -363,6 +726,10 @@ VlcNetDevice::SetPromiscReceiveCallback (PromiscReceiveCallback cb)
 bool
 VlcNetDevice::SupportsSendFrom (void) const
 {
+  if (m_hybridMode == HYBRID_STA && m_uplink != 0)
+    {
+      return m_uplink->SupportsSendFrom ();
+    }
   return m_mac->SupportsSendFrom ();
 }
 
@@ -18,14 +18,16 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
-#ifndef WIFI_NET_DEVICE_H
-#define WIFI_NET_DEVICE_H
+#ifndef VLC_NET_DEVICE_H
+#define VLC_NET_DEVICE_H
 
 #include "ns3/net-device.h"
 #include "ns3/packet.h"
 #include "ns3/traced-callback.h"
 #include "ns3/mac48-address.h"
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
@@ -33,6 +35,7 @@ class WifiRemoteStationManager;
 class VlcChannel;
 class VlcPhy;
 class VlcMac;
+class VlcHeaderCompressor;
 
 /**
  * \defgroup wifi Wifi Models
@@ -45,14 +48,33 @@ class VlcMac;
  * \brief Hold together all Wifi-related objects.
  * \ingroup wifi
  *
- * This class holds together ns3::WifiChannel, ns3::WifiPhy,
- * ns3::WifiMac, and, ns3::WifiRemoteStationManager.
+ * This class holds together ns3::VlcChannel, ns3::VlcPhy,
+ * ns3::VlcMac, and, ns3::WifiRemoteStationManager.
  */
 class VlcNetDevice : public NetDevice
 {
 public:
   static TypeId GetTypeId (void);
 
+  /**
+   * How the device shares the traffic with its uplink device.
+   */
+  enum HybridMode
+  {
+    /** All the frames go over the VLC PHY. */
+    HYBRID_OFF,
+    /** The frames are sent over the VLC PHY and also received from the
+        uplink device (the AP side of a hybrid link). */
+    HYBRID_AP,
+    /** The frames are received from the VLC PHY and the frames of the
+        upper layers are sent over the uplink device (the STA side of a
+        hybrid link). The split is made above the MAC: the MAC-level
+        acknowledgments of the downlink, and the probe and association
+        requests unless the STA is bound with VlcStaticAssociationHelper,
+        still use the VLC PHY. */
+    HYBRID_STA
+  };
+
   VlcNetDevice ();
   virtual ~VlcNetDevice ();
 
@@ -80,6 +102,55 @@ public:
    * \returns the remote station manager we are currently using.
    */
   Ptr<WifiRemoteStationManager> GetRemoteStationManager (void) const;
+  /**
+   * Attach the companion device (typically an RF NetDevice) which carries
+   * the uplink of a hybrid link, see HybridMode. The uplink device keeps
+   * its queue, its MAC and its address, which is also the address of
+   * this device: the VLC MAC takes it when the uplink device is attached,
+   * when this device is given a MAC or an address, and again before each
+   * packet is sent, so that the uplink device may get its address before
+   * or after this call. The STA must be associated once both addresses
+   * are set.
+   *
+   * This call takes over the receive callback of the uplink device: the
+   * frames it receives are passed up the stack as if this device received
+   * them, and a receive callback set on the uplink device afterwards
+   * detaches it from this device. The uplink device must thus be added to
+   * its node and must not be configured with an address of its own at
+   * the network layer.
+   *
+   * \param device the uplink device
+   */
+  void SetUplinkDevice (Ptr<NetDevice> device);
+  /**
+   * \returns the uplink device, if any.
+   */
+  Ptr<NetDevice> GetUplinkDevice (void) const;
+  /**
+   * \returns the IP/UDP header compressor of this device, whose counters
+   *          give the compression ratio achieved, see the HeaderCompression
+   *          attribute.
+   */
+  Ptr<VlcHeaderCompressor> GetHeaderCompressor (void) const;
+  /**
+   * \returns the number of frames waiting for transmission in the MAC.
+   */
+  uint32_t GetQueuedPackets (void) const;
+  /**
+   * \returns true if the device refuses packets until its MAC drains,
+   *          see the MaxQueuedPackets attribute.
+   */
+  bool IsQueueStopped (void) const;
+  /**
+   * \param callback the callback to invoke when the device stops
+   *        accepting packets because the MAC holds MaxQueuedPackets frames.
+   */
+  void SetQueueStopCallback (Callback<void> callback);
+  /**
+   * \param callback the callback to invoke when the device accepts
+   *        packets again.
+   */
+  void SetQueueWakeCallback (Callback<void> callback);
 
 
   // inherited from NetDevice base class.
@@ -107,6 +178,14 @@ public:
   virtual Address GetMulticast (Ipv6Address addr) const;
 
   virtual bool SendFrom (Ptr<Packet> packet_vlc, const Address& source, const Address& dest, uint16_t protocolNumber);
+  /**
+   * Send a burst of packets of the same protocol, see Send.
+   *
+   * \param packets the packets with their destinations
+   * \param protocolNumber the protocol number of the packets
+   * \return true if the packets were handed over to the MAC
+   */
+  bool SendBatch (const std::vector<std::pair<Ptr<Packet>, Address> > &packets, uint16_t protocolNumber);
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 protected:
@@ -121,9 +200,24 @@ protected:
    * \param to
    */
    void ForwardUp (Ptr<Packet> packet_vlc, Mac48Address from, Mac48Address to);
+  /**
+   * Receive a packet from the uplink device and pass it up the stack.
+   *
+   * \param device the uplink device
+   * \param packet the packet received
+   * \param protocol the protocol number of the packet
+   * \param from the address of the sender
+   * \return true
+   */
+  bool ReceiveFromUplink (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                          const Address &from);
 private:
   // This value conforms to the 802.11 specification
   static const uint16_t MAX_MSDU_SIZE = 2304;
+  // The largest MSDU of a jumbo MTU: the usual 9216-byte jumbo frame,
+  // whose RTS/CTS exchange at 6 Mbit/s still fits the 15-bit duration
+  // field of the MAC header.
+  static const uint16_t MAX_JUMBO_MSDU_SIZE = 9216;
 
   /**
    * Set that the link is up. A link is always up in ad-hoc mode.
@@ -135,9 +229,51 @@ private:
    */
   void LinkDown (void);
   /**
-   * Return the WifiChannel this device is connected to.
+   * With an MTU larger than the 802.11 MSDU, raise the fragmentation
+   * threshold of the remote station manager if needed, so that the MAC
+   * does not fragment the MSDUs again. When the MTU goes back down, the
+   * threshold the device found is restored.
+   */
+  void UpdateFragmentationThreshold (void);
+  /**
+   * \returns the largest MTU whose frames fit both MAX_JUMBO_MSDU_SIZE
+   *          and the PLCP header of the PHY, if it is set.
+   */
+  uint16_t GetMaxMtu (void) const;
+  /**
+   * Add the LLC header of a packet sent down, compact or LLC/SNAP
+   * depending on the CompactFraming attribute and on the ethertype (see
+   * VlcCompactLlcHeader::CanCompact).
+   *
+   * \param packet the packet
+   * \param protocolNumber the ethertype of the packet
+   */
+  void AddLlcHeader (Ptr<Packet> packet, uint16_t protocolNumber) const;
+  /**
+   * Remove the LLC header, compact or LLC/SNAP, of a received packet.
+   *
+   * \param packet the packet
+   * \return the ethertype of the packet
+   */
+  uint16_t RemoveLlcHeader (Ptr<Packet> packet) const;
+  /**
+   * Give the VLC MAC the current address of the uplink device, if any.
+   */
+  void UpdateUplinkAddress (void);
+  /**
+   * Stop or wake the queue according to the number of frames in the MAC.
+   * Called after each packet handed over to the MAC and each frame
+   * leaving it.
+   */
+  void UpdateQueueState (void);
+  /**
+   * \return true if the device may hand one more packet over to the MAC
+   */
+  bool IsQueueAvailable (void);
+  /**
+   * Return the VlcChannel this device is connected to.
    *
-   * \return WifiChannel
+   * \return VlcChannel
    */
   Ptr<VlcChannel> DoGetChannel (void) const;
   /**
@@ -150,6 +286,16 @@ private:
   Ptr<VlcPhy> m_phy;
   Ptr<VlcMac> m_mac;
   Ptr<WifiRemoteStationManager> m_stationManager;
+  Ptr<NetDevice> m_uplink; //!< The device carrying the uplink of a hybrid link
+  enum HybridMode m_hybridMode; //!< How the traffic is shared with m_uplink
+  bool m_compactFraming; //!< Flag if the frames we send carry a VlcCompactLlcHeader
+  bool m_headerCompression; //!< Flag if the IP/UDP headers of the packets we send are compressed
+  Ptr<VlcHeaderCompressor> m_compressor; //!< Compressor of the packets we send, decompressor of those we receive
+  uint32_t m_maxQueuedPackets; //!< Number of frames in the MAC which stops the queue, 0 to disable
+  uint32_t m_wakeQueuedPackets; //!< Number of frames in the MAC which wakes the queue
+  bool m_queueStopped; //!< Flag if the queue is stopped
+  Callback<void> m_queueStop; //!< Invoked when the queue stops
+  Callback<void> m_queueWake; //!< Invoked when the queue wakes
   NetDevice::ReceiveCallback m_forwardUp;
   NetDevice::PromiscReceiveCallback m_promiscRx;
 
@@ -160,9 +306,10 @@ private:
   bool m_linkUp;
   TracedCallback<> m_linkChanges;
   mutable uint16_t m_mtu;
+  uint32_t m_savedFragmentationThreshold; //!< Fragmentation threshold before it was raised for the MTU, or 0
   bool m_configComplete;
 };
 
 } // namespace ns3
 
-#endif /* WIFI_NET_DEVICE_H */
+#endif /* VLC_NET_DEVICE_H */
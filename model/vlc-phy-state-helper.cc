@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "vlc-phy-state-helper.h"
+#include "ns3/dcf-manager.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
@@ -51,18 +52,21 @@ VlcPhyStateHelper::GetTypeId (void)
 }
 
 VlcPhyStateHelper::VlcPhyStateHelper ()
-  : m_rxing (false),
-    m_endTx (Seconds (0)),
+  : m_endTx (Seconds (0)),
     m_endRx (Seconds (0)),
     m_endCcaBusy (Seconds (0)),
     m_endSwitching (Seconds (0)),
-    m_startTx (Seconds (0)),
     m_startRx (Seconds (0)),
     m_startCcaBusy (Seconds (0)),
-    m_startSwitching (Seconds (0)),
-    m_previousStateChangeTime (Seconds (0))
+    m_previousStateChangeTime (Seconds (0)),
+    m_statsResetTime (Seconds (0)),
+    m_predictedCcaBusyEnd (Seconds (0)),
+    m_dcfManager (0),
+    m_rxing (false),
+    m_ccaBusyPredictionValid (true)
 {
   NS_LOG_FUNCTION (this);
+  ResetAirtimeStats ();
 }
 
 void
@@ -78,7 +82,41 @@ VlcPhyStateHelper::SetReceiveErrorCallback (VlcPhy::RxErrorCallback callback)
 void
 VlcPhyStateHelper::RegisterListener (WifiPhyListener *listener)
 {
-  m_listeners.push_back (listener);
+  RegisterListener (listener, VlcPhy::ALL_NOTIFICATIONS);
+}
+void
+VlcPhyStateHelper::RegisterListener (WifiPhyListener *listener, uint32_t notifications)
+{
+  Subscription subscription;
+  subscription.listener = listener;
+  subscription.notifications = notifications;
+  m_listeners.push_back (subscription);
+}
+uint32_t
+VlcPhyStateHelper::GetNListeners (void) const
+{
+  return m_listeners.size ();
+}
+void
+VlcPhyStateHelper::RegisterDcfManager (DcfManager *manager)
+{
+  NS_ASSERT (manager == 0 || m_dcfManager == 0 || m_dcfManager == manager);
+  m_dcfManager = manager;
+}
+DcfManager *
+VlcPhyStateHelper::GetDcfManager (void) const
+{
+  return m_dcfManager;
+}
+void
+VlcPhyStateHelper::SetStateRecorder (Ptr<VlcPhyStateRecorder> recorder)
+{
+  m_recorder = recorder;
+}
+Ptr<VlcPhyStateRecorder>
+VlcPhyStateHelper::GetStateRecorder (void) const
+{
+  return m_recorder;
 }
 
 bool
@@ -186,49 +224,91 @@ VlcPhyStateHelper::GetState (void)
 void
 VlcPhyStateHelper::NotifyTxStart (Time duration)
 {
+  if (m_dcfManager != 0)
+    {
+      m_dcfManager->NotifyTxStartNow (duration);
+    }
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
-      (*i)->NotifyTxStart (duration);
+      if (i->notifications & VlcPhy::TX_START)
+        {
+          i->listener->NotifyTxStart (duration);
+        }
     }
 }
 void
 VlcPhyStateHelper::NotifyRxStart (Time duration)
 {
+  if (m_dcfManager != 0)
+    {
+      m_dcfManager->NotifyRxStartNow (duration);
+    }
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
-      (*i)->NotifyRxStart (duration);
+      if (i->notifications & VlcPhy::RX_START)
+        {
+          i->listener->NotifyRxStart (duration);
+        }
     }
 }
 void
 VlcPhyStateHelper::NotifyRxEndOk (void)
 {
+  if (m_dcfManager != 0)
+    {
+      m_dcfManager->NotifyRxEndOkNow ();
+    }
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
-      (*i)->NotifyRxEndOk ();
+      if (i->notifications & VlcPhy::RX_END_OK)
+        {
+          i->listener->NotifyRxEndOk ();
+        }
     }
 }
 void
 VlcPhyStateHelper::NotifyRxEndError (void)
 {
+  if (m_dcfManager != 0)
+    {
+      m_dcfManager->NotifyRxEndErrorNow ();
+    }
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
-      (*i)->NotifyRxEndError ();
+      if (i->notifications & VlcPhy::RX_END_ERROR)
+        {
+          i->listener->NotifyRxEndError ();
+        }
     }
 }
 void
 VlcPhyStateHelper::NotifyMaybeCcaBusyStart (Time duration)
 {
+  if (m_dcfManager != 0)
+    {
+      m_dcfManager->NotifyMaybeCcaBusyStartNow (duration);
+    }
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
-      (*i)->NotifyMaybeCcaBusyStart (duration);
+      if (i->notifications & VlcPhy::MAYBE_CCA_BUSY_START)
+        {
+          i->listener->NotifyMaybeCcaBusyStart (duration);
+        }
     }
 }
 void
 VlcPhyStateHelper::NotifySwitchingStart (Time duration)
 {
+  if (m_dcfManager != 0)
+    {
+      m_dcfManager->NotifySwitchingStartNow (duration);
+    }
   for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
     {
-      (*i)->NotifySwitchingStart (duration);
+      if (i->notifications & VlcPhy::SWITCHING_START)
+        {
+          i->listener->NotifySwitchingStart (duration);
+        }
     }
 }
 
@@ -247,9 +327,153 @@ VlcPhyStateHelper::LogPreviousIdleAndCcaBusyStates (void)
       Time ccaBusyStart = Max (m_endTx, m_endRx);
       ccaBusyStart = Max (ccaBusyStart, m_startCcaBusy);
       ccaBusyStart = Max (ccaBusyStart, m_endSwitching);
-      m_stateLogger (ccaBusyStart, idleStart - ccaBusyStart, VlcPhy::CCA_BUSY);
+      LogState (ccaBusyStart, idleStart - ccaBusyStart, VlcPhy::CCA_BUSY);
+    }
+  LogState (idleStart, now - idleStart, VlcPhy::IDLE);
+}
+
+bool
+VlcPhyStateHelper::IsCcaBusyPredictionValid (Time signalEnd) const
+{
+  return m_ccaBusyPredictionValid && signalEnd <= m_predictedCcaBusyEnd;
+}
+
+void
+VlcPhyStateHelper::SetCcaBusyPrediction (Time end)
+{
+  m_predictedCcaBusyEnd = end;
+  m_ccaBusyPredictionValid = true;
+}
+
+void
+VlcPhyStateHelper::InvalidateCcaBusyPrediction (void)
+{
+  m_ccaBusyPredictionValid = false;
+}
+
+Time
+VlcPhyStateHelper::GetPredictedCcaBusyEnd (void) const
+{
+  return m_predictedCcaBusyEnd;
+}
+
+void
+VlcPhyStateHelper::LogState (Time start, Time duration, enum VlcPhy::State state)
+{
+  Time end = start + duration;
+  if (end > m_statsResetTime)
+    {
+      AccountState (m_airtime, end - Max (start, m_statsResetTime), state);
+    }
+  if (m_recorder != 0)
+    {
+      m_recorder->Record (start, duration, state);
+    }
+  m_stateLogger (start, duration, state);
+}
+
+void
+VlcPhyStateHelper::AccountState (AirtimeStats &stats, Time duration, enum VlcPhy::State state)
+{
+  switch (state)
+    {
+    case VlcPhy::IDLE:
+      stats.idleTime += duration;
+      break;
+    case VlcPhy::CCA_BUSY:
+      stats.ccaBusyTime += duration;
+      break;
+    case VlcPhy::TX:
+      stats.txTime += duration;
+      break;
+    case VlcPhy::RX:
+      stats.rxTime += duration;
+      break;
+    case VlcPhy::SWITCHING:
+      stats.switchingTime += duration;
+      break;
+    }
+}
+
+VlcPhyStateHelper::AirtimeStats
+VlcPhyStateHelper::GetAirtimeStats (void)
+{
+  Time now = Simulator::Now ();
+  AirtimeStats stats = m_airtime;
+  // TX and SWITCHING are accounted for their whole duration when they
+  // start, so remove the part which has not elapsed yet.
+  if (m_endTx > now)
+    {
+      stats.txTime -= m_endTx - now;
+    }
+  if (m_endSwitching > now)
+    {
+      stats.switchingTime -= m_endSwitching - now;
+    }
+  // RX, CCA_BUSY and IDLE are accounted when they end, so add the part of
+  // the current state which has already elapsed.
+  switch (GetState ())
+    {
+    case VlcPhy::RX:
+      AccountState (stats, now - Max (m_startRx, m_statsResetTime), VlcPhy::RX);
+      break;
+    case VlcPhy::CCA_BUSY:
+      {
+        Time ccaStart = Max (m_endRx, m_endTx);
+        ccaStart = Max (ccaStart, m_startCcaBusy);
+        ccaStart = Max (ccaStart, m_endSwitching);
+        AccountState (stats, now - Max (ccaStart, m_statsResetTime), VlcPhy::CCA_BUSY);
+      } break;
+    case VlcPhy::IDLE:
+      {
+        Time idleStart = Max (m_endCcaBusy, m_endRx);
+        idleStart = Max (idleStart, m_endTx);
+        idleStart = Max (idleStart, m_endSwitching);
+        if (m_endCcaBusy > m_endRx
+            && m_endCcaBusy > m_endSwitching
+            && m_endCcaBusy > m_endTx)
+          {
+            Time ccaBusyStart = Max (m_endTx, m_endRx);
+            ccaBusyStart = Max (ccaBusyStart, m_startCcaBusy);
+            ccaBusyStart = Max (ccaBusyStart, m_endSwitching);
+            if (idleStart > m_statsResetTime)
+              {
+                AccountState (stats, idleStart - Max (ccaBusyStart, m_statsResetTime), VlcPhy::CCA_BUSY);
+              }
+          }
+        AccountState (stats, now - Max (idleStart, m_statsResetTime), VlcPhy::IDLE);
+      } break;
+    case VlcPhy::TX:
+    case VlcPhy::SWITCHING:
+      break;
+    }
+  return stats;
+}
+
+void
+VlcPhyStateHelper::ResetAirtimeStats (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  m_statsResetTime = now;
+  m_airtime.idleTime = Seconds (0);
+  m_airtime.ccaBusyTime = Seconds (0);
+  m_airtime.txTime = Seconds (0);
+  m_airtime.rxTime = Seconds (0);
+  m_airtime.switchingTime = Seconds (0);
+  m_airtime.txFrames = 0;
+  m_airtime.rxOkFrames = 0;
+  m_airtime.rxErrorFrames = 0;
+  // The remaining part of an ongoing TX or SWITCHING state has already
+  // been logged and will not be logged again.
+  if (m_endTx > now)
+    {
+      m_airtime.txTime = m_endTx - now;
+    }
+  if (m_endSwitching > now)
+    {
+      m_airtime.switchingTime = m_endSwitching - now;
     }
-  m_stateLogger (idleStart, now - idleStart, VlcPhy::IDLE);
 }
 
 void
@@ -257,6 +481,7 @@ VlcPhyStateHelper::SwitchToTx (Time txDuration_vlc, Ptr<const Packet> packet_vlc
                                 WifiPreamble preamble_vlc, uint8_t txPower_vlc)
 {
   m_txTrace (packet_vlc, txMode_vlc, preamble_vlc, txPower_vlc);
+  m_airtime.txFrames++;
   NotifyTxStart (txDuration_vlc);
   Time now = Simulator::Now ();
   switch (GetState ())
@@ -266,7 +491,7 @@ VlcPhyStateHelper::SwitchToTx (Time txDuration_vlc, Ptr<const Packet> packet_vlc
        * as its endRx event are cancelled by the caller.
        */
       m_rxing = false;
-      m_stateLogger (m_startRx, now - m_startRx, VlcPhy::RX);
+      LogState (m_startRx, now - m_startRx, VlcPhy::RX);
       m_endRx = now;
       break;
     case VlcPhy::CCA_BUSY:
@@ -274,7 +499,7 @@ VlcPhyStateHelper::SwitchToTx (Time txDuration_vlc, Ptr<const Packet> packet_vlc
         Time ccaStart = Max (m_endRx, m_endTx);
         ccaStart = Max (ccaStart, m_startCcaBusy);
         ccaStart = Max (ccaStart, m_endSwitching);
-        m_stateLogger (ccaStart, now - ccaStart, VlcPhy::CCA_BUSY);
+        LogState (ccaStart, now - ccaStart, VlcPhy::CCA_BUSY);
       } break;
     case VlcPhy::IDLE:
       LogPreviousIdleAndCcaBusyStates ();
@@ -284,10 +509,9 @@ VlcPhyStateHelper::SwitchToTx (Time txDuration_vlc, Ptr<const Packet> packet_vlc
       NS_FATAL_ERROR ("Invalid WifiPhy state.");
       break;
     }
-  m_stateLogger (now, txDuration_vlc, VlcPhy::TX);
+  LogState (now, txDuration_vlc, VlcPhy::TX);
   m_previousStateChangeTime = now;
   m_endTx = now + txDuration_vlc;
-  m_startTx = now;
 }
 void
 VlcPhyStateHelper::SwitchToRx (Time rxDuration)
@@ -306,7 +530,7 @@ VlcPhyStateHelper::SwitchToRx (Time rxDuration)
         Time ccaStart = Max (m_endRx, m_endTx);
         ccaStart = Max (ccaStart, m_startCcaBusy);
         ccaStart = Max (ccaStart, m_endSwitching);
-        m_stateLogger (ccaStart, now - ccaStart, VlcPhy::CCA_BUSY);
+        LogState (ccaStart, now - ccaStart, VlcPhy::CCA_BUSY);
       } break;
     case VlcPhy::SWITCHING:
     case VlcPhy::RX:
@@ -333,7 +557,7 @@ VlcPhyStateHelper::SwitchToChannelSwitching (Time switchingDuration)
        * as its endRx event are cancelled by the caller.
        */
       m_rxing = false;
-      m_stateLogger (m_startRx, now - m_startRx, VlcPhy::RX);
+      LogState (m_startRx, now - m_startRx, VlcPhy::RX);
       m_endRx = now;
       break;
     case VlcPhy::CCA_BUSY:
@@ -341,7 +565,7 @@ VlcPhyStateHelper::SwitchToChannelSwitching (Time switchingDuration)
         Time ccaStart = Max (m_endRx, m_endTx);
         ccaStart = Max (ccaStart, m_startCcaBusy);
         ccaStart = Max (ccaStart, m_endSwitching);
-        m_stateLogger (ccaStart, now - ccaStart, VlcPhy::CCA_BUSY);
+        LogState (ccaStart, now - ccaStart, VlcPhy::CCA_BUSY);
       } break;
     case VlcPhy::IDLE:
       LogPreviousIdleAndCcaBusyStates ();
@@ -358,9 +582,8 @@ VlcPhyStateHelper::SwitchToChannelSwitching (Time switchingDuration)
       m_endCcaBusy = now;
     }
 
-  m_stateLogger (now, switchingDuration, VlcPhy::SWITCHING);
+  LogState (now, switchingDuration, VlcPhy::SWITCHING);
   m_previousStateChangeTime = now;
-  m_startSwitching = now;
   m_endSwitching = now + switchingDuration;
   NS_ASSERT (IsStateSwitching ());
 }
@@ -369,6 +592,7 @@ void
 VlcPhyStateHelper::SwitchFromRxEndOk (Ptr<Packet> packet_vlc, double snr_vlc, WifiMode mode_vlc, enum WifiPreamble preamble_vlc)
 {
   m_rxOkTrace (packet_vlc, snr_vlc, mode_vlc, preamble_vlc);
+  m_airtime.rxOkFrames++;
   NotifyRxEndOk ();
   DoSwitchFromRx ();
   if (!m_rxOkCallback.IsNull ())
@@ -381,6 +605,7 @@ void
 VlcPhyStateHelper::SwitchFromRxEndError (Ptr<const Packet> packet_vlc, double snr_vlc)
 {
   m_rxErrorTrace (packet_vlc, snr_vlc);
+  m_airtime.rxErrorFrames++;
   NotifyRxEndError ();
   DoSwitchFromRx ();
   if (!m_rxErrorCallback.IsNull ())
@@ -396,7 +621,7 @@ VlcPhyStateHelper::DoSwitchFromRx (void)
   NS_ASSERT (m_rxing);
 
   Time now = Simulator::Now ();
-  m_stateLogger (m_startRx, now - m_startRx, VlcPhy::RX);
+  LogState (m_startRx, now - m_startRx, VlcPhy::RX);
   m_previousStateChangeTime = now;
   m_rxing = false;
 
@@ -17,16 +17,19 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
-#ifndef WIFI_PHY_STATE_HELPER_H
-#define WIFI_PHY_STATE_HELPER_H
+#ifndef VLC_PHY_STATE_HELPER_H
+#define VLC_PHY_STATE_HELPER_H
 
 #include "vlc-phy.h"
+#include "vlc-phy-state-recorder.h"
 #include "ns3/traced-callback.h"
 #include "ns3/object.h"
 #include <vector>
 
 namespace ns3 {
 
+class DcfManager;
+
 /**
  * \ingroup wifi
  *
@@ -35,6 +38,22 @@ namespace ns3 {
 class VlcPhyStateHelper : public Object
 {
 public:
+  /**
+   * Cumulative time spent in each PHY state and number of frames
+   * handled since the statistics were last reset.
+   */
+  struct AirtimeStats
+  {
+    Time idleTime;          //!< Time spent in IDLE
+    Time ccaBusyTime;       //!< Time spent in CCA_BUSY
+    Time txTime;            //!< Time spent in TX
+    Time rxTime;            //!< Time spent in RX
+    Time switchingTime;     //!< Time spent in SWITCHING
+    uint32_t txFrames;      //!< Number of frames transmitted
+    uint32_t rxOkFrames;    //!< Number of frames successfully received
+    uint32_t rxErrorFrames; //!< Number of frames received with errors
+  };
+
   static TypeId GetTypeId (void);
 
   VlcPhyStateHelper ();
@@ -57,6 +76,41 @@ public:
    * \param listener
    */
   void RegisterListener (WifiPhyListener *listener);
+  /**
+   * Register WifiPhyListener to this WifiPhyStateHelper for the given
+   * notifications only.
+   *
+   * \param listener
+   * \param notifications a mask of VlcPhy::Notification values
+   */
+  void RegisterListener (WifiPhyListener *listener, uint32_t notifications);
+  /**
+   * \return the number of WifiPhyListener registered
+   */
+  uint32_t GetNListeners (void) const;
+  /**
+   * Register a DcfManager which is notified of every state change through
+   * direct (non-virtual) calls. Only one DcfManager can be registered;
+   * it is unregistered by registering 0.
+   *
+   * \param manager
+   */
+  void RegisterDcfManager (DcfManager *manager);
+  /**
+   * \return the DcfManager registered, or 0
+   */
+  DcfManager * GetDcfManager (void) const;
+  /**
+   * Record every state interval in the given binary state recorder, in
+   * addition to reporting it through the State trace source.
+   *
+   * \param recorder the recorder, or 0 to disable recording
+   */
+  void SetStateRecorder (Ptr<VlcPhyStateRecorder> recorder);
+  /**
+   * \return the state recorder, or 0
+   */
+  Ptr<VlcPhyStateRecorder> GetStateRecorder (void) const;
   /**
    * Return the current state of WifiPhy.
    *
@@ -163,17 +217,85 @@ public:
    */
   void SwitchMaybeToCcaBusy (Time duration);
 
+  /**
+   * Check whether the cached prediction of the end of the CCA busy state
+   * still holds after a signal ending at the given time is added to the
+   * medium. Adding energy which ends before the predicted end cannot
+   * move it, so there is no need to recompute it in that case.
+   *
+   * \param signalEnd the time at which the new signal ends
+   * \return true if the prediction is still valid, false otherwise
+   */
+  bool IsCcaBusyPredictionValid (Time signalEnd) const;
+  /**
+   * Record the result of a scan of the medium energy.
+   *
+   * \param end the time at which the aggregate energy falls below the
+   *        CCA threshold
+   */
+  void SetCcaBusyPrediction (Time end);
+  /**
+   * Mark the cached prediction as stale, e.g. because a signal ending
+   * after the predicted end was added to the medium.
+   */
+  void InvalidateCcaBusyPrediction (void);
+  /**
+   * \return the cached prediction of the time at which the aggregate
+   *         energy falls below the CCA threshold
+   */
+  Time GetPredictedCcaBusyEnd (void) const;
+
+  /**
+   * Return the airtime accounted in each state up to now, including the
+   * state which is currently in progress. This does not require any
+   * subscription to the State trace source.
+   *
+   * \return a snapshot of the airtime statistics
+   */
+  AirtimeStats GetAirtimeStats (void);
+  /**
+   * Clear all airtime counters. Time spent before this call is no longer
+   * accounted, including the part of the current state already elapsed.
+   */
+  void ResetAirtimeStats (void);
+
   TracedCallback<Time,Time,enum VlcPhy::State> m_stateLogger;
 private:
   /**
-   * typedef for a list of WifiPhyListeners
+   * A WifiPhyListener along with the mask of the notifications it
+   * subscribed to.
+   */
+  struct Subscription
+  {
+    WifiPhyListener *listener;  //!< The listener
+    uint32_t notifications;     //!< Mask of VlcPhy::Notification values
+  };
+  /**
+   * typedef for a list of WifiPhyListener subscriptions
    */
-  typedef std::vector<WifiPhyListener *> Listeners;
+  typedef std::vector<Subscription> Listeners;
 
   /**
    * Log the ideal and CCA states.
    */
   void LogPreviousIdleAndCcaBusyStates (void);
+  /**
+   * Account the given state interval in the airtime counters and fire
+   * the State trace source.
+   *
+   * \param start the time at which the state started
+   * \param duration the duration of the state
+   * \param state the state
+   */
+  void LogState (Time start, Time duration, enum VlcPhy::State state);
+  /**
+   * Add the given duration to the airtime counter of the given state.
+   *
+   * \param stats the counters to update
+   * \param duration the duration to add
+   * \param state the state
+   */
+  static void AccountState (AirtimeStats &stats, Time duration, enum VlcPhy::State state);
 
   /**
    * Notify all WifiPhyListener that the transmission has started for the given duration.
@@ -214,25 +336,35 @@ private:
    */
   void DoSwitchFromRx (void);
 
-  bool m_rxing;
+  // The start of the TX and SWITCHING states is never needed: they are
+  // logged when they start, with their whole duration.
   Time m_endTx;
   Time m_endRx;
   Time m_endCcaBusy;
   Time m_endSwitching;
-  Time m_startTx;
   Time m_startRx;
   Time m_startCcaBusy;
-  Time m_startSwitching;
   Time m_previousStateChangeTime;
+  Time m_statsResetTime;
+  Time m_predictedCcaBusyEnd;
+  AirtimeStats m_airtime;
 
+  // A single list with per-listener masks: there are only a few
+  // listeners per PHY and one vector per notification type costs more
+  // memory than the mask tests cost time.
   Listeners m_listeners;
+  DcfManager *m_dcfManager;
+  Ptr<VlcPhyStateRecorder> m_recorder;
   TracedCallback<Ptr<const Packet>, double, WifiMode, enum WifiPreamble> m_rxOkTrace;
   TracedCallback<Ptr<const Packet>, double> m_rxErrorTrace;
   TracedCallback<Ptr<const Packet>,WifiMode,WifiPreamble,uint8_t> m_txTrace;
   VlcPhy::RxOkCallback m_rxOkCallback;
   VlcPhy::RxErrorCallback m_rxErrorCallback;
+  // the flags are kept last to avoid padding between the Time members
+  bool m_rxing;
+  bool m_ccaBusyPredictionValid;
 };
 
 } // namespace ns3
 
-#endif /* WIFI_PHY_STATE_HELPER_H */
+#endif /* VLC_PHY_STATE_HELPER_H */
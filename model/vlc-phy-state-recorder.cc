@@ -0,0 +1,327 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-phy-state-recorder.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+NS_LOG_COMPONENT_DEFINE ("VlcPhyStateRecorder");
+
+namespace ns3 {
+
+/****************************************************************
+ *       The binary state log file
+ ****************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (VlcPhyStateRecordFile)
+  ;
+
+TypeId
+VlcPhyStateRecordFile::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcPhyStateRecordFile")
+    .SetParent<Object> ()
+    .AddConstructor<VlcPhyStateRecordFile> ()
+  ;
+  return tid;
+}
+
+VlcPhyStateRecordFile::VlcPhyStateRecordFile ()
+  : m_fd (-1),
+    m_map (0),
+    m_mapSize (0),
+    m_used (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+VlcPhyStateRecordFile::~VlcPhyStateRecordFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+VlcPhyStateRecordFile::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+VlcPhyStateRecordFile::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_fd = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (m_fd < 0)
+    {
+      NS_FATAL_ERROR ("Unable to open state log " << filename << ": " << std::strerror (errno));
+    }
+  m_used = 0;
+  m_nRecords = 0;
+
+  VlcPhyStateRecordFileHeader header;
+  std::memcpy (header.magic, "VLCSTATE", sizeof (header.magic));
+  header.version = 1;
+  header.recordSize = sizeof (VlcPhyStateRecord);
+  Reserve (sizeof (header));
+  std::memcpy (m_map, &header, sizeof (header));
+  m_used = sizeof (header);
+}
+
+void
+VlcPhyStateRecordFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_fd < 0)
+    {
+      return;
+    }
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapSize);
+      m_map = 0;
+    }
+  // drop the unused part of the last chunk
+  if (ftruncate (m_fd, m_used) != 0)
+    {
+      NS_LOG_WARN ("Unable to truncate state log: " << std::strerror (errno));
+    }
+  close (m_fd);
+  m_fd = -1;
+  m_mapSize = 0;
+}
+
+bool
+VlcPhyStateRecordFile::IsOpen (void) const
+{
+  return m_fd >= 0;
+}
+
+void
+VlcPhyStateRecordFile::Reserve (uint64_t size)
+{
+  if (size <= m_mapSize)
+    {
+      return;
+    }
+  // Grow by doubling so that the number of remappings stays logarithmic
+  // in the size of the log.
+  uint64_t newSize = std::max<uint64_t> (m_mapSize, 1 << 20);
+  while (newSize < size)
+    {
+      newSize *= 2;
+    }
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapSize);
+      m_map = 0;
+    }
+  if (ftruncate (m_fd, newSize) != 0)
+    {
+      NS_FATAL_ERROR ("Unable to grow state log: " << std::strerror (errno));
+    }
+  void *map = mmap (0, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("Unable to map state log: " << std::strerror (errno));
+    }
+  m_map = static_cast<uint8_t *> (map);
+  m_mapSize = newSize;
+}
+
+void
+VlcPhyStateRecordFile::Append (const VlcPhyStateRecord *records, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_ASSERT (IsOpen ());
+  uint64_t size = static_cast<uint64_t> (n) * sizeof (VlcPhyStateRecord);
+  Reserve (m_used + size);
+  std::memcpy (m_map + m_used, records, size);
+  m_used += size;
+  m_nRecords += n;
+}
+
+uint64_t
+VlcPhyStateRecordFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+bool
+VlcPhyStateRecordFile::Read (std::string filename, std::vector<VlcPhyStateRecord> &records)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  VlcPhyStateRecordFileHeader header;
+  in.read (reinterpret_cast<char *> (&header), sizeof (header));
+  if (!in
+      || std::memcmp (header.magic, "VLCSTATE", sizeof (header.magic)) != 0
+      || header.recordSize != sizeof (VlcPhyStateRecord))
+    {
+      return false;
+    }
+  VlcPhyStateRecord record;
+  while (in.read (reinterpret_cast<char *> (&record), sizeof (record)))
+    {
+      records.push_back (record);
+    }
+  return true;
+}
+
+/****************************************************************
+ *       The per-PHY recorder
+ ****************************************************************/
+
+NS_OBJECT_ENSURE_REGISTERED (VlcPhyStateRecorder)
+  ;
+
+TypeId
+VlcPhyStateRecorder::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcPhyStateRecorder")
+    .SetParent<Object> ()
+    .AddConstructor<VlcPhyStateRecorder> ()
+    .AddAttribute ("BufferSize",
+                   "The number of records buffered before they are flushed to the file.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&VlcPhyStateRecorder::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FlushInterval",
+                   "The interval between two periodic flushes of the buffer. "
+                   "A zero value disables periodic flushes.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&VlcPhyStateRecorder::m_flushInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+VlcPhyStateRecorder::VlcPhyStateRecorder ()
+  : m_head (0),
+    m_count (0),
+    m_phyId (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+VlcPhyStateRecorder::~VlcPhyStateRecorder ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VlcPhyStateRecorder::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flushEvent.Cancel ();
+  Flush ();
+  m_file = 0;
+  m_buffer.clear ();
+  Object::DoDispose ();
+}
+
+void
+VlcPhyStateRecorder::SetFile (Ptr<VlcPhyStateRecordFile> file)
+{
+  NS_LOG_FUNCTION (this << file);
+  m_file = file;
+}
+
+void
+VlcPhyStateRecorder::SetPhyId (uint32_t phyId)
+{
+  m_phyId = phyId;
+}
+
+uint32_t
+VlcPhyStateRecorder::GetPhyId (void) const
+{
+  return m_phyId;
+}
+
+void
+VlcPhyStateRecorder::Record (Time start, Time duration, enum VlcPhy::State state)
+{
+  if (m_buffer.size () != m_bufferSize)
+    {
+      Flush ();
+      m_buffer.resize (m_bufferSize);
+      m_head = 0;
+      m_count = 0;
+    }
+  if (m_count == m_bufferSize)
+    {
+      Flush ();
+    }
+  uint32_t index = (m_head + m_count) % m_bufferSize;
+  if (m_count == m_bufferSize)
+    {
+      // No file to flush to: keep the most recent records only.
+      m_head = (m_head + 1) % m_bufferSize;
+    }
+  else
+    {
+      m_count++;
+    }
+  VlcPhyStateRecord &record = m_buffer[index];
+  record.phyId = m_phyId;
+  record.state = state;
+  record.start = start.GetNanoSeconds ();
+  record.duration = duration.GetNanoSeconds ();
+  if (m_file != 0 && !m_flushInterval.IsZero () && !m_flushEvent.IsRunning ())
+    {
+      m_flushEvent = Simulator::Schedule (m_flushInterval, &VlcPhyStateRecorder::PeriodicFlush, this);
+    }
+}
+
+void
+VlcPhyStateRecorder::Flush (void)
+{
+  NS_LOG_FUNCTION (this << m_count);
+  if (m_count == 0 || m_file == 0 || !m_file->IsOpen ())
+    {
+      return;
+    }
+  uint32_t first = std::min (m_count, static_cast<uint32_t> (m_buffer.size ()) - m_head);
+  m_file->Append (&m_buffer[m_head], first);
+  if (first < m_count)
+    {
+      m_file->Append (&m_buffer[0], m_count - first);
+    }
+  m_head = 0;
+  m_count = 0;
+}
+
+void
+VlcPhyStateRecorder::PeriodicFlush (void)
+{
+  // The next flush is scheduled by the next record.
+  Flush ();
+}
+
+} // namespace ns3
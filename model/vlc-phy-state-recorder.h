@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_PHY_STATE_RECORDER_H
+#define VLC_PHY_STATE_RECORDER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "vlc-phy.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * A fixed-size record of one PHY state interval, as stored in a binary
+ * state log. Times are expressed in nanoseconds.
+ */
+struct VlcPhyStateRecord
+{
+  uint32_t phyId;    //!< Identifier of the PHY, see VlcPhyStateRecorder::SetPhyId
+  uint32_t state;    //!< The VlcPhy::State of the interval
+  int64_t start;     //!< Start of the interval (ns)
+  int64_t duration;  //!< Duration of the interval (ns)
+};
+
+/**
+ * \ingroup wifi
+ *
+ * The header found at the beginning of a binary state log.
+ */
+struct VlcPhyStateRecordFileHeader
+{
+  char magic[8];        //!< Always "VLCSTATE"
+  uint32_t version;     //!< Version of the file format
+  uint32_t recordSize;  //!< Size of one VlcPhyStateRecord in bytes
+};
+
+/**
+ * \ingroup wifi
+ *
+ * A binary state log backed by a memory-mapped file. Records are copied
+ * into the mapping and written back to disk by the kernel, so appending
+ * records never blocks on disk I/O. A single file is usually shared by
+ * all the VlcPhyStateRecorder objects of a simulation.
+ */
+class VlcPhyStateRecordFile : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcPhyStateRecordFile ();
+  virtual ~VlcPhyStateRecordFile ();
+
+  /**
+   * Create (or truncate) the given file and write the file header.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+  /**
+   * Unmap the file and truncate it to the size of the records written.
+   */
+  void Close (void);
+  /**
+   * \return true if the file is open, false otherwise
+   */
+  bool IsOpen (void) const;
+  /**
+   * Append records to the file, growing the mapping as needed.
+   *
+   * \param records the records to append
+   * \param n the number of records
+   */
+  void Append (const VlcPhyStateRecord *records, uint32_t n);
+  /**
+   * \return the number of records written to the file
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * Read all the records of a closed binary state log.
+   *
+   * \param filename the name of the file
+   * \param records the vector the records are appended to
+   * \return true if the file is a binary state log, false otherwise
+   */
+  static bool Read (std::string filename, std::vector<VlcPhyStateRecord> &records);
+
+private:
+  virtual void DoDispose (void);
+  /**
+   * Grow the file and its mapping so that it can hold at least the
+   * given number of bytes.
+   *
+   * \param size the required size in bytes
+   */
+  void Reserve (uint64_t size);
+
+  int m_fd;              //!< File descriptor of the log
+  uint8_t *m_map;        //!< Start of the mapping
+  uint64_t m_mapSize;    //!< Size of the mapping (and of the file) in bytes
+  uint64_t m_used;       //!< Number of bytes written so far
+  uint64_t m_nRecords;   //!< Number of records written so far
+};
+
+/**
+ * \ingroup wifi
+ *
+ * Record the state intervals of one PHY in a ring buffer and flush them
+ * to a VlcPhyStateRecordFile when the buffer is full, FlushInterval
+ * after the first record buffered since the last flush, and when the
+ * recorder is disposed. No event is scheduled while the buffer is empty,
+ * so the recorder does not keep the simulation running.
+ *
+ * The recorder is fed directly by VlcPhyStateHelper, and is usually
+ * attached through the StateRecorder attribute of ns3::YansVlcPhy, so no
+ * trace sink is involved.
+ */
+class VlcPhyStateRecorder : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcPhyStateRecorder ();
+  virtual ~VlcPhyStateRecorder ();
+
+  /**
+   * Set the file the records are flushed to.
+   *
+   * \param file the file the records are flushed to
+   */
+  void SetFile (Ptr<VlcPhyStateRecordFile> file);
+  /**
+   * \param phyId the identifier stored in every record of this recorder
+   */
+  void SetPhyId (uint32_t phyId);
+  /**
+   * \return the identifier stored in every record of this recorder
+   */
+  uint32_t GetPhyId (void) const;
+  /**
+   * Add a state interval to the ring buffer.
+   *
+   * \param start the time at which the state started
+   * \param duration the duration of the state
+   * \param state the state
+   */
+  void Record (Time start, Time duration, enum VlcPhy::State state);
+  /**
+   * Write all buffered records to the file.
+   */
+  void Flush (void);
+
+private:
+  virtual void DoDispose (void);
+  /**
+   * Flush the buffer, FlushInterval after the first record was buffered.
+   */
+  void PeriodicFlush (void);
+
+  Ptr<VlcPhyStateRecordFile> m_file;        //!< The file records are flushed to
+  std::vector<VlcPhyStateRecord> m_buffer;  //!< The ring buffer
+  uint32_t m_bufferSize;                    //!< Capacity of the ring buffer
+  uint32_t m_head;                          //!< Index of the oldest buffered record
+  uint32_t m_count;                         //!< Number of buffered records
+  uint32_t m_phyId;                         //!< Identifier of the PHY
+  Time m_flushInterval;                     //!< Interval between two periodic flushes
+  EventId m_flushEvent;                     //!< Next periodic flush, if records are buffered
+};
+
+} // namespace ns3
+
+#endif /* VLC_PHY_STATE_RECORDER_H */
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-propagation-loss-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("VlcPropagationLossModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (VlcLambertianPropagationLossModel)
+  ;
+
+TypeId
+VlcLambertianPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcLambertianPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<VlcLambertianPropagationLossModel> ()
+    .AddAttribute ("SemiAngle",
+                   "The semi-angle at half power of the emitter, in degrees.",
+                   DoubleValue (60.0),
+                   MakeDoubleAccessor (&VlcLambertianPropagationLossModel::SetSemiAngle,
+                                       &VlcLambertianPropagationLossModel::GetSemiAngle),
+                   MakeDoubleChecker<double> (1.0, 89.0))
+    .AddAttribute ("DetectorArea",
+                   "The area of the detector, in square meters.",
+                   DoubleValue (1e-4),
+                   MakeDoubleAccessor (&VlcLambertianPropagationLossModel::m_area),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("FieldOfView",
+                   "The field of view (half angle) of the detector, in degrees.",
+                   DoubleValue (70.0),
+                   MakeDoubleAccessor (&VlcLambertianPropagationLossModel::m_fieldOfView),
+                   MakeDoubleChecker<double> (0, 90.0))
+  ;
+  return tid;
+}
+
+VlcLambertianPropagationLossModel::VlcLambertianPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VlcLambertianPropagationLossModel::SetSemiAngle (double semiAngle)
+{
+  NS_LOG_FUNCTION (this << semiAngle);
+  m_semiAngle = semiAngle;
+  m_order = -std::log (2.0) / std::log (std::cos (semiAngle * M_PI / 180.0));
+}
+
+double
+VlcLambertianPropagationLossModel::GetSemiAngle (void) const
+{
+  return m_semiAngle;
+}
+
+double
+VlcLambertianPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                                  Ptr<MobilityModel> a,
+                                                  Ptr<MobilityModel> b) const
+{
+  Vector pa = a->GetPosition ();
+  Vector pb = b->GetPosition ();
+  double distance = a->GetDistanceFrom (b);
+  if (distance == 0)
+    {
+      return txPowerDbm;
+    }
+  double cosAngle = std::fabs (pa.z - pb.z) / distance;
+  // Nodes at the same height (cosAngle == 0) always fall here: without
+  // the reflections, STAs do not hear each other, nor do luminaires.
+  if (cosAngle <= std::cos (m_fieldOfView * M_PI / 180.0))
+    {
+      NS_LOG_DEBUG ("outside of the field of view, angle=" << std::acos (cosAngle) * 180.0 / M_PI);
+      return -1000;
+    }
+  double gain = (m_order + 1) * m_area / (2 * M_PI * distance * distance)
+    * std::pow (cosAngle, m_order) * cosAngle;
+  return txPowerDbm + 10 * std::log10 (gain);
+}
+
+int64_t
+VlcLambertianPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (VlcBlockerPropagationLossModel)
+  ;
+
+TypeId
+VlcBlockerPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcBlockerPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<VlcBlockerPropagationLossModel> ()
+    .AddAttribute ("Attenuation",
+                   "The attenuation, in dB, of a link crossing an obstacle.",
+                   DoubleValue (100.0),
+                   MakeDoubleAccessor (&VlcBlockerPropagationLossModel::m_attenuation),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+VlcBlockerPropagationLossModel::VlcBlockerPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VlcBlockerPropagationLossModel::AddBlocker (Box blocker)
+{
+  NS_LOG_FUNCTION (this << blocker);
+  m_blockers.push_back (blocker);
+}
+
+uint32_t
+VlcBlockerPropagationLossModel::GetNBlockers (void) const
+{
+  return m_blockers.size ();
+}
+
+Box
+VlcBlockerPropagationLossModel::GetBlocker (uint32_t i) const
+{
+  NS_ASSERT (i < m_blockers.size ());
+  return m_blockers[i];
+}
+
+bool
+VlcBlockerPropagationLossModel::IsBlocked (Vector a, Vector b) const
+{
+  double origin[3] = { a.x, a.y, a.z };
+  double direction[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+  for (std::vector<Box>::const_iterator i = m_blockers.begin (); i != m_blockers.end (); ++i)
+    {
+      double low[3] = { i->xMin, i->yMin, i->zMin };
+      double high[3] = { i->xMax, i->yMax, i->zMax };
+      // clip the segment, parametrized by t in [0, 1], against the three
+      // slabs of the box: it crosses the box if something is left.
+      double tMin = 0;
+      double tMax = 1;
+      bool outside = false;
+      for (uint32_t k = 0; k < 3 && !outside; k++)
+        {
+          if (direction[k] == 0)
+            {
+              outside = origin[k] < low[k] || origin[k] > high[k];
+              continue;
+            }
+          double t1 = (low[k] - origin[k]) / direction[k];
+          double t2 = (high[k] - origin[k]) / direction[k];
+          tMin = std::max (tMin, std::min (t1, t2));
+          tMax = std::min (tMax, std::max (t1, t2));
+          outside = tMin > tMax;
+        }
+      if (!outside)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+double
+VlcBlockerPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                               Ptr<MobilityModel> a,
+                                               Ptr<MobilityModel> b) const
+{
+  if (IsBlocked (a->GetPosition (), b->GetPosition ()))
+    {
+      return txPowerDbm - m_attenuation;
+    }
+  return txPowerDbm;
+}
+
+int64_t
+VlcBlockerPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_PROPAGATION_LOSS_MODEL_H
+#define VLC_PROPAGATION_LOSS_MODEL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/propagation-loss-model.h"
+#include "ns3/box.h"
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \brief line of sight gain of a Lambertian emitter
+ *
+ * The DC gain of the line of sight optical link between a Lambertian
+ * emitter and a photodiode:
+ *
+ *   H = (m + 1) A / (2 pi d^2) cos^m (phi) cos (psi)
+ *
+ * with m the Lambertian order of the emitter, derived from its semi-angle
+ * at half power, A the area of the detector, phi the irradiance angle and
+ * psi the incidence angle. The gain is zero when psi exceeds the field of
+ * view of the detector.
+ *
+ * Luminaires are mounted facing down and the receivers on the desks
+ * facing up, so the higher of the two nodes is taken as facing down and
+ * the lower one as facing up: both angles are then the angle between the
+ * link and the vertical, and the gain is the same in both directions.
+ *
+ * Only the line of sight between the ceiling and the desks is modeled:
+ * two nodes at the same height, such as two STAs on their desks or two
+ * luminaires, are outside of each other's field of view and do not hear
+ * each other at all. The STAs of a room are thus hidden from each other
+ * and cannot sense each other's transmissions; only the uplink reflected
+ * by the walls and ceiling, which is not modeled, would let them.
+ */
+class VlcLambertianPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcLambertianPropagationLossModel ();
+
+  /**
+   * \param semiAngle the semi-angle at half power of the emitter (degrees)
+   */
+  void SetSemiAngle (double semiAngle);
+  /**
+   * \returns the semi-angle at half power of the emitter (degrees)
+   */
+  double GetSemiAngle (void) const;
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  double m_semiAngle;    //!< Semi-angle at half power of the emitter (degrees)
+  double m_order;        //!< Lambertian order of the emitter
+  double m_area;         //!< Area of the detector (m^2)
+  double m_fieldOfView;  //!< Field of view of the detector (degrees)
+};
+
+/**
+ * \brief attenuation of the links crossing obstacles
+ *
+ * Every link whose line of sight crosses one of the boxes of the model
+ * is attenuated by a fixed amount; with the default attenuation the
+ * link is effectively cut, as a person or a partition does with light.
+ * The cost of a link is linear in the number of boxes, so the model is
+ * meant to hold the few obstacles of one room.
+ */
+class VlcBlockerPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcBlockerPropagationLossModel ();
+
+  /**
+   * \param blocker the volume of an obstacle
+   */
+  void AddBlocker (Box blocker);
+  /**
+   * \returns the number of obstacles
+   */
+  uint32_t GetNBlockers (void) const;
+  /**
+   * \param i the index of an obstacle
+   * \returns the volume of the obstacle
+   */
+  Box GetBlocker (uint32_t i) const;
+
+  /**
+   * \param a a position
+   * \param b another position
+   * \returns true if the segment between the two positions crosses an
+   *          obstacle, false otherwise
+   */
+  bool IsBlocked (Vector a, Vector b) const;
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  std::vector<Box> m_blockers; //!< Volumes of the obstacles
+  double m_attenuation;        //!< Attenuation of a blocked link (dB)
+};
+
+} // namespace ns3
+
+#endif /* VLC_PROPAGATION_LOSS_MODEL_H */
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-snr-rate-manager.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/double.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("VlcSnrRateManager");
+
+namespace ns3 {
+
+/**
+ * The link state of a station: the last SNR measured and the mode it
+ * selects, which stays valid as long as the SNR remains between the
+ * threshold of that mode and the threshold of the next faster one.
+ */
+struct VlcSnrRateStation : public WifiRemoteStation
+{
+  double m_snr;        //!< Last SNR measured (linear ratio)
+  bool m_hasSnr;       //!< Flag if m_snr holds a measurement
+  bool m_modeValid;    //!< Flag if m_mode matches m_snr
+  uint32_t m_mode;     //!< Index of the selected mode in the supported modes of the station
+  double m_modeLow;    //!< SNR below which m_mode must be selected again
+  double m_modeHigh;   //!< SNR from which m_mode must be selected again
+};
+
+NS_OBJECT_ENSURE_REGISTERED (VlcSnrRateManager)
+  ;
+
+TypeId
+VlcSnrRateManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcSnrRateManager")
+    .SetParent<WifiRemoteStationManager> ()
+    .AddConstructor<VlcSnrRateManager> ()
+    .AddAttribute ("BerThreshold",
+                   "The maximum bit error rate of the selected mode.",
+                   DoubleValue (10e-6),
+                   MakeDoubleAccessor (&VlcSnrRateManager::m_ber),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("SnrMargin",
+                   "The margin, in dB, added to the SNR threshold of every mode to absorb "
+                   "the small variations of the optical channel between two measurements.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&VlcSnrRateManager::m_snrMargin),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+VlcSnrRateManager::VlcSnrRateManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+VlcSnrRateManager::~VlcSnrRateManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VlcSnrRateManager::SetupPhy (Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  double margin = std::pow (10.0, m_snrMargin / 10.0);
+  m_thresholds.clear ();
+  for (uint32_t i = 0; i < phy->GetNModes (); i++)
+    {
+      Threshold threshold;
+      threshold.mode = phy->GetMode (i);
+      threshold.snr = phy->CalculateSnr (threshold.mode, m_ber) * margin;
+      NS_LOG_DEBUG ("mode=" << threshold.mode << ", snr=" << threshold.snr);
+      m_thresholds.push_back (threshold);
+    }
+  WifiRemoteStationManager::SetupPhy (phy);
+}
+
+double
+VlcSnrRateManager::GetSnrThreshold (WifiMode mode) const
+{
+  for (Thresholds::const_iterator i = m_thresholds.begin (); i != m_thresholds.end (); i++)
+    {
+      if (i->mode == mode)
+        {
+          return i->snr;
+        }
+    }
+  NS_ASSERT (false);
+  return std::numeric_limits<double>::max ();
+}
+
+WifiRemoteStation *
+VlcSnrRateManager::DoCreateStation (void) const
+{
+  NS_LOG_FUNCTION (this);
+  VlcSnrRateStation *station = new VlcSnrRateStation ();
+  station->m_snr = 0.0;
+  station->m_hasSnr = false;
+  station->m_modeValid = false;
+  station->m_mode = 0;
+  station->m_modeLow = 0.0;
+  station->m_modeHigh = 0.0;
+  return station;
+}
+
+void
+VlcSnrRateManager::UpdateSnr (WifiRemoteStation *st, double snr)
+{
+  VlcSnrRateStation *station = (VlcSnrRateStation *)st;
+  station->m_snr = snr;
+  station->m_hasSnr = true;
+  if (snr < station->m_modeLow || snr >= station->m_modeHigh)
+    {
+      station->m_modeValid = false;
+    }
+}
+
+void
+VlcSnrRateManager::DoReportRxOk (WifiRemoteStation *station,
+                                 double rxSnr, WifiMode txMode)
+{
+  NS_LOG_FUNCTION (this << station << rxSnr << txMode);
+  // The optical channel is reciprocal enough for the SNR of the frames
+  // we receive to predict the SNR of the frames we send.
+  UpdateSnr (station, rxSnr);
+}
+
+void
+VlcSnrRateManager::DoReportRtsFailed (WifiRemoteStation *station)
+{
+  NS_LOG_FUNCTION (this << station);
+}
+
+void
+VlcSnrRateManager::DoReportDataFailed (WifiRemoteStation *station)
+{
+  NS_LOG_FUNCTION (this << station);
+}
+
+void
+VlcSnrRateManager::DoReportRtsOk (WifiRemoteStation *station,
+                                  double ctsSnr, WifiMode ctsMode, double rtsSnr)
+{
+  NS_LOG_FUNCTION (this << station << ctsSnr << ctsMode << rtsSnr);
+  UpdateSnr (station, rtsSnr);
+}
+
+void
+VlcSnrRateManager::DoReportDataOk (WifiRemoteStation *station,
+                                   double ackSnr, WifiMode ackMode, double dataSnr)
+{
+  NS_LOG_FUNCTION (this << station << ackSnr << ackMode << dataSnr);
+  // dataSnr is the SNR of our frame at the station, as reported by the ACK
+  UpdateSnr (station, dataSnr);
+}
+
+void
+VlcSnrRateManager::DoReportFinalRtsFailed (WifiRemoteStation *station)
+{
+  NS_LOG_FUNCTION (this << station);
+}
+
+void
+VlcSnrRateManager::DoReportFinalDataFailed (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  // The link changed more than the margin: fall back to the most robust
+  // mode until the next measurement.
+  VlcSnrRateStation *station = (VlcSnrRateStation *)st;
+  station->m_hasSnr = false;
+  station->m_modeValid = false;
+}
+
+WifiTxVector
+VlcSnrRateManager::DoGetDataTxVector (WifiRemoteStation *st, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << st << size);
+  VlcSnrRateStation *station = (VlcSnrRateStation *)st;
+  if (!station->m_modeValid)
+    {
+      station->m_mode = 0;
+      station->m_modeLow = 0.0;
+      station->m_modeHigh = std::numeric_limits<double>::max ();
+      if (station->m_hasSnr)
+        {
+          // The fastest mode whose threshold is met; the thresholds of the
+          // faster modes bound the validity of the choice.
+          uint64_t bestRate = 0;
+          for (uint32_t i = 0; i < GetNSupported (station); i++)
+            {
+              WifiMode mode = GetSupported (station, i);
+              double threshold = GetSnrThreshold (mode);
+              if (threshold <= station->m_snr)
+                {
+                  if (mode.GetDataRate () > bestRate)
+                    {
+                      bestRate = mode.GetDataRate ();
+                      station->m_mode = i;
+                      station->m_modeLow = threshold;
+                    }
+                }
+              else if (threshold < station->m_modeHigh)
+                {
+                  station->m_modeHigh = threshold;
+                }
+            }
+        }
+      else
+        {
+          // No measurement yet: the most robust mode, until the first one
+          station->m_modeHigh = 0.0;
+        }
+      station->m_modeValid = station->m_hasSnr;
+    }
+  return WifiTxVector (GetSupported (station, station->m_mode), GetDefaultTxPowerLevel (), GetLongRetryCount (station),
+                       GetShortGuardInterval (station), std::min (GetNumberOfReceiveAntennas (station), GetNumberOfTransmitAntennas ()),
+                       GetNumberOfTransmitAntennas (station), GetStbc (station));
+}
+
+WifiTxVector
+VlcSnrRateManager::DoGetRtsTxVector (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  VlcSnrRateStation *station = (VlcSnrRateStation *)st;
+  // RTSs are rare and must reach the station: use the most robust mode
+  return WifiTxVector (GetSupported (station, 0), GetDefaultTxPowerLevel (), GetShortRetryCount (station),
+                       GetShortGuardInterval (station), std::min (GetNumberOfReceiveAntennas (station), GetNumberOfTransmitAntennas ()),
+                       GetNumberOfTransmitAntennas (station), GetStbc (station));
+}
+
+bool
+VlcSnrRateManager::IsLowLatency (void) const
+{
+  return true;
+}
+
+} // namespace ns3
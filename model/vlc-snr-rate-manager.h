@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_SNR_RATE_MANAGER_H
+#define VLC_SNR_RATE_MANAGER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/wifi-mode.h"
+
+namespace ns3 {
+
+/**
+ * \brief rate control driven by the SNR of the received frames
+ * \ingroup wifi
+ *
+ * Optical links change slowly, so instead of probing rates like ARF or
+ * Minstrel, this manager picks the fastest mode whose SNR threshold is
+ * met by the last SNR measured on the link. The SNR comes from every
+ * frame received from the station (the value the PHY passes to
+ * SwitchFromRxEndOk) and from the ACKs and CTSs it sends back; the
+ * thresholds are computed once per PHY from the target bit error rate.
+ */
+class VlcSnrRateManager : public WifiRemoteStationManager
+{
+public:
+  static TypeId GetTypeId (void);
+
+  VlcSnrRateManager ();
+  virtual ~VlcSnrRateManager ();
+
+  virtual void SetupPhy (Ptr<WifiPhy> phy);
+
+private:
+  // overriden from base class
+  virtual WifiRemoteStation* DoCreateStation (void) const;
+  virtual void DoReportRxOk (WifiRemoteStation *station,
+                             double rxSnr, WifiMode txMode);
+  virtual void DoReportRtsFailed (WifiRemoteStation *station);
+  virtual void DoReportDataFailed (WifiRemoteStation *station);
+  virtual void DoReportRtsOk (WifiRemoteStation *station,
+                              double ctsSnr, WifiMode ctsMode, double rtsSnr);
+  virtual void DoReportDataOk (WifiRemoteStation *station,
+                               double ackSnr, WifiMode ackMode, double dataSnr);
+  virtual void DoReportFinalRtsFailed (WifiRemoteStation *station);
+  virtual void DoReportFinalDataFailed (WifiRemoteStation *station);
+  virtual WifiTxVector DoGetDataTxVector (WifiRemoteStation *station, uint32_t size);
+  virtual WifiTxVector DoGetRtsTxVector (WifiRemoteStation *station);
+  virtual bool IsLowLatency (void) const;
+
+  /**
+   * Record a new SNR measurement of the link with the given station.
+   *
+   * \param station the station
+   * \param snr the SNR (linear ratio)
+   */
+  void UpdateSnr (WifiRemoteStation *station, double snr);
+  /**
+   * \param mode a mode of the PHY
+   * \return the minimum SNR (linear ratio) of the mode, including the margin
+   */
+  double GetSnrThreshold (WifiMode mode) const;
+
+  /**
+   * A mode and the SNR it needs.
+   */
+  struct Threshold
+  {
+    WifiMode mode;  //!< The mode
+    double snr;     //!< The minimum SNR of the mode (linear ratio)
+  };
+  typedef std::vector<Threshold> Thresholds; //!< Thresholds of the PHY modes
+
+  Thresholds m_thresholds; //!< Thresholds of the PHY modes
+  double m_ber;            //!< Target bit error rate
+  double m_snrMargin;      //!< Safety margin added to the thresholds (dB)
+};
+
+} // namespace ns3
+
+#endif /* VLC_SNR_RATE_MANAGER_H */
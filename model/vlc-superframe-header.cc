@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlc-superframe-header.h"
+#include "ns3/address-utils.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (VlcSuperframeHeader)
+  ;
+
+VlcSuperframeHeader::VlcSuperframeHeader ()
+  : m_finalCapSlot (NUM_SLOTS - 1)
+{
+}
+
+void
+VlcSuperframeHeader::SetFinalCapSlot (uint8_t slot)
+{
+  NS_ASSERT (slot < NUM_SLOTS);
+  m_finalCapSlot = slot;
+}
+
+uint8_t
+VlcSuperframeHeader::GetFinalCapSlot (void) const
+{
+  return m_finalCapSlot;
+}
+
+void
+VlcSuperframeHeader::AddGts (Mac48Address address, uint8_t startSlot, uint8_t length)
+{
+  NS_ASSERT (startSlot > m_finalCapSlot && startSlot + length <= NUM_SLOTS);
+  Gts gts;
+  gts.address = address;
+  gts.startSlot = startSlot;
+  gts.length = length;
+  m_gts.push_back (gts);
+}
+
+uint32_t
+VlcSuperframeHeader::GetNGts (void) const
+{
+  return m_gts.size ();
+}
+
+VlcSuperframeHeader::Gts
+VlcSuperframeHeader::GetGts (uint32_t i) const
+{
+  NS_ASSERT (i < m_gts.size ());
+  return m_gts[i];
+}
+
+bool
+VlcSuperframeHeader::FindGts (Mac48Address address, Gts &gts) const
+{
+  for (std::vector<Gts>::const_iterator i = m_gts.begin (); i != m_gts.end (); i++)
+    {
+      if (i->address == address)
+        {
+          gts = *i;
+          return true;
+        }
+    }
+  return false;
+}
+
+TypeId
+VlcSuperframeHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlcSuperframeHeader")
+    .SetParent<Header> ()
+    .AddConstructor<VlcSuperframeHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+VlcSuperframeHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+VlcSuperframeHeader::Print (std::ostream &os) const
+{
+  os << "finalCapSlot=" << (uint32_t) m_finalCapSlot;
+  for (std::vector<Gts>::const_iterator i = m_gts.begin (); i != m_gts.end (); i++)
+    {
+      os << ", gts=" << i->address
+         << ":" << (uint32_t) i->startSlot
+         << "+" << (uint32_t) i->length;
+    }
+}
+
+uint32_t
+VlcSuperframeHeader::GetSerializedSize (void) const
+{
+  return 2 + m_gts.size () * 8;
+}
+
+void
+VlcSuperframeHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_finalCapSlot);
+  i.WriteU8 (m_gts.size ());
+  for (std::vector<Gts>::const_iterator j = m_gts.begin (); j != m_gts.end (); j++)
+    {
+      WriteTo (i, j->address);
+      i.WriteU8 (j->startSlot);
+      i.WriteU8 (j->length);
+    }
+}
+
+uint32_t
+VlcSuperframeHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_finalCapSlot = i.ReadU8 ();
+  uint8_t nGts = i.ReadU8 ();
+  m_gts.clear ();
+  for (uint8_t j = 0; j < nGts; j++)
+    {
+      Gts gts;
+      ReadFrom (i, gts.address);
+      gts.startSlot = i.ReadU8 ();
+      gts.length = i.ReadU8 ();
+      m_gts.push_back (gts);
+    }
+  return i.GetDistanceFrom (start);
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLC_SUPERFRAME_HEADER_H
+#define VLC_SUPERFRAME_HEADER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/header.h"
+#include "ns3/mac48-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * The superframe specification and GTS list carried by the beacons of a
+ * beacon-enabled VLC BSS, modelled after IEEE 802.15.7.
+ *
+ * The beacon interval is divided into NUM_SLOTS equal slots. Slots 0 to
+ * FinalCapSlot form the contention access period (CAP), during which the
+ * STAs without a guaranteed time slot (GTS) use CSMA/CA. The remaining
+ * slots form the contention free period, split into the GTS listed in
+ * the header. The header follows the MgtBeaconHeader in the beacon.
+ */
+class VlcSuperframeHeader : public Header
+{
+public:
+  /**
+   * The number of slots in a superframe.
+   */
+  static const uint8_t NUM_SLOTS = 16;
+
+  /**
+   * A GTS allocated to one STA.
+   */
+  struct Gts
+  {
+    Mac48Address address;  //!< The STA the GTS is allocated to
+    uint8_t startSlot;     //!< The first slot of the GTS
+    uint8_t length;        //!< The number of slots of the GTS
+  };
+
+  VlcSuperframeHeader ();
+
+  /**
+   * \param slot the last slot of the contention access period
+   */
+  void SetFinalCapSlot (uint8_t slot);
+  /**
+   * \return the last slot of the contention access period
+   */
+  uint8_t GetFinalCapSlot (void) const;
+  /**
+   * Add a GTS to the list.
+   *
+   * \param address the STA the GTS is allocated to
+   * \param startSlot the first slot of the GTS
+   * \param length the number of slots of the GTS
+   */
+  void AddGts (Mac48Address address, uint8_t startSlot, uint8_t length);
+  /**
+   * \return the number of GTS in the list
+   */
+  uint32_t GetNGts (void) const;
+  /**
+   * \param i the index of the GTS
+   * \return the i-th GTS of the list
+   */
+  Gts GetGts (uint32_t i) const;
+  /**
+   * Look for the GTS allocated to the given STA.
+   *
+   * \param address the address of the STA
+   * \param gts the GTS found, if any
+   * \return true if a GTS is allocated to the STA, false otherwise
+   */
+  bool FindGts (Mac48Address address, Gts &gts) const;
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_finalCapSlot;    //!< The last slot of the CAP
+  std::vector<Gts> m_gts;    //!< The GTS list
+};
+
+} // namespace ns3
+
+#endif /* VLC_SUPERFRAME_HEADER_H */
@@ -137,6 +137,12 @@ YansVlcChannel::Add (Ptr<YansVlcPhy> phy)
   m_phyList.push_back (phy);
 }
 
+void
+YansVlcChannel::Reserve (uint32_t n)
+{
+  m_phyList.reserve (n);
+}
+
 int64_t
 YansVlcChannel::AssignStreams (int64_t stream)
 {
@@ -26,7 +26,7 @@ class YansVlcPhy;
  * This wifi channel implements the propagation model described in
  * "Yet Another Network Simulator", (http://cutebugs.net/files/wns2-yans.pdf).
  *
- * This class is expected to be used in tandem with the ns3::YansvlcPhy
+ * This class is expected to be used in tandem with the ns3::YansVlcPhy
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
@@ -44,11 +44,18 @@ public:
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
   /**
-   * Adds the given YansvlcPhy to the PHY list
+   * Adds the given YansVlcPhy to the PHY list
    *
-   * \param phy the YansvlcPhy to be added to the PHY list
+   * \param phy the YansVlcPhy to be added to the PHY list
    */
   void Add (Ptr<YansVlcPhy> phy_vlc);
+  /**
+   * Reserve room for the given number of PHYs in the PHY list, before
+   * adding many of them.
+   *
+   * \param n the number of PHYs
+   */
+  void Reserve (uint32_t n);
  /**
    * \param loss the new propagation loss model.
    */
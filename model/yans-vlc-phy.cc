@@ -37,6 +37,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/boolean.h"
 #include <cmath>
+#include <map>
 
 NS_LOG_COMPONENT_DEFINE ("YansvlcPhy");
 
@@ -48,7 +49,7 @@ NS_OBJECT_ENSURE_REGISTERED (YansVlcPhy)
 TypeId
 YansVlcPhy::GetTypeId (void)
 {
-  static TypeId tid = TypeId ("ns3::YansvlcPhy")
+  static TypeId tid = TypeId ("ns3::YansVlcPhy")
     .SetParent<VlcPhy> ()
     .AddConstructor<YansVlcPhy> ()
     .AddAttribute ("EnergyDetectionThreshold",
@@ -111,6 +112,12 @@ YansVlcPhy::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansVlcPhy::m_state),
                    MakePointerChecker<VlcPhyStateHelper> ())
+    .AddAttribute ("StateRecorder",
+                   "The recorder of the state intervals of the PHY in a binary state log, if any.",
+                   PointerValue (),
+                   MakePointerAccessor (&YansVlcPhy::SetStateRecorder,
+                                        &YansVlcPhy::GetStateRecorder),
+                   MakePointerChecker<VlcPhyStateRecorder> ())
     .AddAttribute ("ChannelSwitchDelay",
                    "Delay between two short frames transmitted on different frequencies.",
                    TimeValue (MicroSeconds (250)),
@@ -170,6 +177,7 @@ YansVlcPhy::GetTypeId (void)
 
 YansVlcPhy::YansVlcPhy ()
   :  m_channelNumber (1),
+    m_modes (0),
     m_endRxEvent (),
     m_channelStartingFrequency (0)
 {
@@ -187,9 +195,11 @@ void
 YansVlcPhy::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_state->GetStateRecorder () != 0)
+    {
+      m_state->GetStateRecorder ()->Flush ();
+    }
   m_channel = 0;
-  m_deviceRateSet.clear ();
-  m_deviceMcsSet.clear();
   m_device = 0;
   m_mobility = 0;
   m_state = 0;
@@ -202,36 +212,63 @@ YansVlcPhy::ConfigureStandard (enum WifiPhyStandard standard)
   switch (standard)
     {
     case WIFI_PHY_STANDARD_80211a:
-      Configure80211a ();
+    case WIFI_PHY_STANDARD_80211_10MHZ:
+    case WIFI_PHY_STANDARD_80211_5MHZ:
+    case WIFI_PHY_STANDARD_holland:
+    case WIFI_PHY_STANDARD_80211n_5GHZ:
+      m_channelStartingFrequency = 5e3; // 5.000 GHz
+      break;
+    case WIFI_PHY_STANDARD_80211b:
+    case WIFI_PHY_STANDARD_80211g:
+    case WIFI_PHY_STANDARD_80211n_2_4GHZ:
+      m_channelStartingFrequency = 2407; // 2.407 GHz
+      break;
+    default:
+      NS_ASSERT (false);
+      break;
+    }
+  m_modes = GetModeTable (standard);
+}
+
+const VlcPhyModeTable *
+YansVlcPhy::GetModeTable (enum WifiPhyStandard standard)
+{
+  static std::map<enum WifiPhyStandard, VlcPhyModeTable> tables;
+  std::map<enum WifiPhyStandard, VlcPhyModeTable>::iterator it = tables.find (standard);
+  if (it != tables.end ())
+    {
+      return &it->second;
+    }
+  VlcPhyModeTable *table = &tables[standard];
+  switch (standard)
+    {
+    case WIFI_PHY_STANDARD_80211a:
+      Configure80211a (table);
       break;
     case WIFI_PHY_STANDARD_80211b:
-      Configure80211b ();
+      Configure80211b (table);
       break;
     case WIFI_PHY_STANDARD_80211g:
-      Configure80211g ();
+      Configure80211g (table);
       break;
     case WIFI_PHY_STANDARD_80211_10MHZ:
-      Configure80211_10Mhz ();
+      Configure80211_10Mhz (table);
       break;
     case WIFI_PHY_STANDARD_80211_5MHZ:
-      Configure80211_5Mhz ();
+      Configure80211_5Mhz (table);
       break;
     case WIFI_PHY_STANDARD_holland:
-      ConfigureHolland ();
+      ConfigureHolland (table);
       break;
     case WIFI_PHY_STANDARD_80211n_2_4GHZ:
-      m_channelStartingFrequency=2407;
-      Configure80211n ();
-      break;
     case WIFI_PHY_STANDARD_80211n_5GHZ:
-      m_channelStartingFrequency=5e3;
-      Configure80211n ();
+      Configure80211n (table);
       break;
-
     default:
       NS_ASSERT (false);
       break;
     }
+  return table;
 }
 
 
@@ -282,6 +319,8 @@ YansVlcPhy::SetCcaMode1Threshold (double threshold_vlc)
 {
   NS_LOG_FUNCTION (this << threshold_vlc);
   m_ccaMode1ThresholdW = DbmToW (threshold_vlc);
+  // The predicted end of the CCA busy state depends on the threshold
+  m_state->InvalidateCcaBusyPrediction ();
 }
 void
 YansVlcPhy::SetErrorRateModel (Ptr<ErrorRateModel> rate_vlc)
@@ -304,6 +343,17 @@ YansVlcPhy::GetRxNoiseFigure (void) const
 {
   return RatioToDb (m_interference.GetNoiseFigure ());
 }
+void
+YansVlcPhy::SetStateRecorder (Ptr<VlcPhyStateRecorder> recorder)
+{
+  NS_LOG_FUNCTION (this << recorder);
+  m_state->SetStateRecorder (recorder);
+}
+Ptr<VlcPhyStateRecorder>
+YansVlcPhy::GetStateRecorder (void) const
+{
+  return m_state->GetStateRecorder ();
+}
 double
 YansVlcPhy::GetTxPowerStart (void) const
 {
@@ -359,7 +409,7 @@ YansVlcPhy::CalculateSnr (WifiMode txMode, double ber_vlc) const
   return m_interference.GetErrorRateModel ()->CalculateSnr (txMode, ber_vlc);
 }
 
-Ptr<VlcChannel>
+Ptr<WifiChannel>
 YansVlcPhy::GetChannel (void) const
 {
   return m_channel;
@@ -410,6 +460,7 @@ switchChannel:
   NS_LOG_DEBUG ("switching channel " << m_channelNumber << " -> " << nch_vlc);
   m_state->SwitchToChannelSwitching (m_channelSwitchDelay);
   m_interference.EraseEvents ();
+  m_state->SetCcaBusyPrediction (Simulator::Now ());
   /*
    * Needed here to be able to correctly sensed the medium for the first
    * time after the switching. The actual switching is not performed until
@@ -463,11 +514,19 @@ WifiMode txMode=txVector_vlc.GetMode();
                               rxPowerW,
 		          txVector_vlc);  // we need it to calculate duration of HT training symbols
 
+  // If the new signal ends after the predicted end of the CCA busy state,
+  // the prediction must be recomputed next time it is needed.
+  bool ccaBusyPredictionValid = m_state->IsCcaBusyPredictionValid (endRx);
+  if (!ccaBusyPredictionValid)
+    {
+      m_state->InvalidateCcaBusyPrediction ();
+    }
+
   switch (m_state->GetState ())
     {
     case YansVlcPhy::SWITCHING:
       NS_LOG_DEBUG ("drop packet because of channel switching");
-      NotifyRxDrop (packet_vlc);
+      NotifyRxDrop (packet_vlc, RX_DROP_SWITCHING);
       /*
        * Packets received on the upcoming channel are added to the event list
        * during the switching state. This way the medium can be correctly sensed
@@ -486,7 +545,7 @@ WifiMode txMode=txVector_vlc.GetMode();
     case YansVlcPhy::RX:
       NS_LOG_DEBUG ("drop packet because already in Rx (power=" <<
                     rxPowerW << "W)");
-      NotifyRxDrop (packet_vlc);
+      NotifyRxDrop (packet_vlc, RX_DROP_ALREADY_RX);
       if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
         {
           // that packet will be noise _after_ the reception of the
@@ -497,7 +556,7 @@ WifiMode txMode=txVector_vlc.GetMode();
     case YansVlcPhy::TX:
       NS_LOG_DEBUG ("drop packet because already in Tx (power=" <<
                     rxPowerW << "W)");
-      NotifyRxDrop (packet_vlc);
+      NotifyRxDrop (packet_vlc, RX_DROP_ALREADY_TX);
       if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
         {
           // that packet will be noise _after_ the transmission of the
@@ -523,7 +582,7 @@ WifiMode txMode=txVector_vlc.GetMode();
         {
           NS_LOG_DEBUG ("drop packet because signal power too Small (" <<
                         rxPowerW << "<" << m_edThresholdW << ")");
-          NotifyRxDrop (packet_vlc);
+          NotifyRxDrop (packet_vlc, RX_DROP_BELOW_THRESHOLD);
           goto maybeCcaBusy;
         }
       break;
@@ -537,7 +596,14 @@ maybeCcaBusy:
   // In this model, CCA becomes busy when the aggregation of all signals as
   // tracked by the InterferenceHelper class is higher than the CcaBusyThreshold
 
+  // The aggregate only needs to be scanned again if this signal may
+  // extend the time during which it stays above the threshold.
+  if (ccaBusyPredictionValid)
+    {
+      return;
+    }
   Time delayUntilCcaEnd = m_interference.GetEnergyDuration (m_ccaMode1ThresholdW);
+  m_state->SetCcaBusyPrediction (Simulator::Now () + delayUntilCcaEnd);
   if (!delayUntilCcaEnd.IsZero ())
     {
       m_state->SwitchMaybeToCcaBusy (delayUntilCcaEnd);
@@ -573,12 +639,12 @@ YansVlcPhy::SendPacket (Ptr<const Packet> packet_vlc, WifiMode txMode, WifiPream
 uint32_t
 YansVlcPhy::GetNModes (void) const
 {
-  return m_deviceRateSet.size ();
+  return m_modes != 0 ? m_modes->deviceRateSet.size () : 0;
 }
 WifiMode
 YansVlcPhy::GetMode (uint32_t mode_vlc) const
 {
-  return m_deviceRateSet[mode_vlc];
+  return m_modes->deviceRateSet[mode_vlc];
 }
 uint32_t
 YansVlcPhy::GetNTxPower (void) const
@@ -587,96 +653,85 @@ YansVlcPhy::GetNTxPower (void) const
 }
 
 void
-YansVlcPhy::Configure80211a (void)
+YansVlcPhy::Configure80211a (VlcPhyModeTable *table)
 {
-  NS_LOG_FUNCTION (this);
-  m_channelStartingFrequency = 5e3; // 5.000 GHz
-
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate6Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate9Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate12Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate18Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate24Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate36Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate48Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate54Mbps ());
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate6Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate9Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate12Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate18Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate24Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate36Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate48Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate54Mbps ());
 }
 
 
 void
-YansVlcPhy::Configure80211b (void)
+YansVlcPhy::Configure80211b (VlcPhyModeTable *table)
 {
-  NS_LOG_FUNCTION (this);
-  m_channelStartingFrequency = 2407; // 2.407 GHz
-
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate1Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate2Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate5_5Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate11Mbps ());
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate1Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate2Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate5_5Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate11Mbps ());
 }
 
 void
-YansVlcPhy::Configure80211g (void)
-{
-  NS_LOG_FUNCTION (this);
-  m_channelStartingFrequency = 2407; // 2.407 GHz
-
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate1Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate2Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate5_5Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate6Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate9Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate11Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate12Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate18Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate24Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate36Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate48Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate54Mbps ());
+YansVlcPhy::Configure80211g (VlcPhyModeTable *table)
+{
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate1Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate2Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate5_5Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate6Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate9Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate11Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate12Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate18Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate24Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate36Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate48Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate54Mbps ());
 }
 
 void
-YansVlcPhy::Configure80211_10Mhz (void)
+YansVlcPhy::Configure80211_10Mhz (VlcPhyModeTable *table)
 {
-  NS_LOG_FUNCTION (this);
-  m_channelStartingFrequency = 5e3; // 5.000 GHz, suppose 802.11a
-
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate3MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate4_5MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate6MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate9MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate12MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate18MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate24MbpsBW10MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate27MbpsBW10MHz ());
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate3MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate4_5MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate6MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate9MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate12MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate18MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate24MbpsBW10MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate27MbpsBW10MHz ());
 }
 
 void
-YansVlcPhy::Configure80211_5Mhz (void)
+YansVlcPhy::Configure80211_5Mhz (VlcPhyModeTable *table)
 {
-  NS_LOG_FUNCTION (this);
-  m_channelStartingFrequency = 5e3; // 5.000 GHz, suppose 802.11a
-
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate1_5MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate2_25MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate3MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate4_5MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate6MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate9MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate12MbpsBW5MHz ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate13_5MbpsBW5MHz ());
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate1_5MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate2_25MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate3MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate4_5MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate6MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate9MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate12MbpsBW5MHz ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate13_5MbpsBW5MHz ());
 }
 
 void
-YansVlcPhy::ConfigureHolland (void)
+YansVlcPhy::ConfigureHolland (VlcPhyModeTable *table)
 {
-  NS_LOG_FUNCTION (this);
-  m_channelStartingFrequency = 5e3; // 5.000 GHz
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate6Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate12Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate18Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate36Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetOfdmRate54Mbps ());
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate6Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate12Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate18Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate36Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetOfdmRate54Mbps ());
 }
 
 void
@@ -684,6 +739,16 @@ YansVlcPhy::RegisterListener (WifiPhyListener *listener)
 {
   m_state->RegisterListener (listener);
 }
+void
+YansVlcPhy::RegisterListener (WifiPhyListener *listener, uint32_t notifications)
+{
+  m_state->RegisterListener (listener, notifications);
+}
+void
+YansVlcPhy::RegisterDcfManager (DcfManager *manager)
+{
+  m_state->RegisterDcfManager (manager);
+}
 
 bool
 YansVlcPhy::IsStateCcaBusy (void)
@@ -810,7 +875,7 @@ YansVlcPhy::EndReceive (Ptr<Packet> packet_vlc, Ptr<InterferenceHelper::Event> e
   else
     {
       /* failure. */
-      NotifyRxDrop (packet_vlc);
+      NotifyRxDrop (packet_vlc, RX_DROP_PER);
       m_state->SwitchFromRxEndError (packet_vlc, snrPer.snr);
     }
 }
@@ -915,32 +980,32 @@ YansVlcPhy::SetChannelBonding(bool channelbonding_vlc)
 }
 
 void
-YansVlcPhy::Configure80211n (void)
-{
-  NS_LOG_FUNCTION (this);
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate1Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate2Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate5_5Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate6Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetDsssRate11Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate12Mbps ());
-  m_deviceRateSet.push_back (VlcPhy::GetErpOfdmRate24Mbps ());
-  m_bssMembershipSelectorSet.push_back(HT_PHY);
+YansVlcPhy::Configure80211n (VlcPhyModeTable *table)
+{
+  NS_LOG_FUNCTION (table);
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate1Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate2Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate5_5Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate6Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetDsssRate11Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate12Mbps ());
+  table->deviceRateSet.push_back (VlcPhy::GetErpOfdmRate24Mbps ());
+  table->bssMembershipSelectorSet.push_back (HT_PHY);
   for (uint8_t i=0; i <8; i++)
     {
-      m_deviceMcsSet.push_back(i);
+      table->deviceMcsSet.push_back (i);
     }
 
 }
 uint32_t
 YansVlcPhy::GetNBssMembershipSelectors (void) const
 {
-  return  m_bssMembershipSelectorSet.size ();
+  return m_modes != 0 ? m_modes->bssMembershipSelectorSet.size () : 0;
 }
 uint32_t
 YansVlcPhy::GetBssMembershipSelector (uint32_t selector_vlc) const
 {
-  return  m_bssMembershipSelectorSet[selector_vlc];
+  return m_modes->bssMembershipSelectorSet[selector_vlc];
 }
 WifiModeList
 YansVlcPhy::GetMembershipSelectorModes(uint32_t selector_vlc)
@@ -964,12 +1029,12 @@ YansVlcPhy::GetMembershipSelectorModes(uint32_t selector_vlc)
 uint8_t
 YansVlcPhy::GetNMcs (void) const
 {
-  return  m_deviceMcsSet.size ();
+  return m_modes != 0 ? m_modes->deviceMcsSet.size () : 0;
 }
 uint8_t
 YansVlcPhy::GetMcs (uint8_t mcs_vlc) const
 {
-  return  m_deviceMcsSet[mcs_vlc];
+  return m_modes->deviceMcsSet[mcs_vlc];
 }
 uint32_t 
 YansVlcPhy::WifiModeToMcs (WifiMode mode_vlc)
@@ -26,7 +26,22 @@ namespace ns3 {
 
 class YansVlcChannel;
 class VlcPhyStateHelper;
+class VlcPhyStateRecorder;
 
+/**
+ * \ingroup wifi
+ *
+ * The transmission modes, MCS and BSS membership selectors supported
+ * for one standard. The tables are built once per standard and shared
+ * by all the YansVlcPhy configured for it (see YansVlcPhy::GetModeTable)
+ * so that large deployments do not duplicate them for every PHY.
+ */
+struct VlcPhyModeTable
+{
+  WifiModeList deviceRateSet;                      //!< The DeviceRateSet, see YansVlcPhy::m_modes
+  std::vector<uint32_t> bssMembershipSelectorSet;  //!< The BssMembershipSelectorSet
+  std::vector<uint8_t> deviceMcsSet;               //!< The DeviceMcsSet
+};
 
 /**
  * \brief 802.11 PHY layer model
@@ -139,7 +154,8 @@ public:
   /**
    * Sets the CCA threshold (dBm).  The energy of a received signal
    * should be higher than this threshold to allow the PHY
-   * layer to declare CCA BUSY state.
+   * layer to declare CCA BUSY state. The cached prediction of the end
+   * of the CCA BUSY state is recomputed at the next signal.
    *
    * \param threshold the CCA threshold in dBm
    */
@@ -166,6 +182,16 @@ public:
    * \param mobility the mobility model this PHY is associated with
    */
   void SetMobility (Ptr<Object> mobility_vlc);
+  /**
+   * Record the state intervals of this PHY in the given recorder.
+   *
+   * \param recorder the recorder, or 0 to disable recording
+   */
+  void SetStateRecorder (Ptr<VlcPhyStateRecorder> recorder);
+  /**
+   * \return the recorder of the state intervals of this PHY, or 0
+   */
+  Ptr<VlcPhyStateRecorder> GetStateRecorder (void) const;
   /**
    * Return the RX noise figure (dBm).
    *
@@ -235,6 +261,8 @@ public:
   virtual void SetReceiveErrorCallback (VlcPhy::RxErrorCallback callback);
   virtual void SendPacket (Ptr<const Packet> packet_vlc, WifiMode mode_vlc, enum WifiPreamble preamble_vlc, WifiTxVector txvector_vlc);
   virtual void RegisterListener (WifiPhyListener *listener);
+  virtual void RegisterListener (WifiPhyListener *listener, uint32_t notifications);
+  virtual void RegisterDcfManager (DcfManager *manager);
   virtual bool IsStateCcaBusy (void);
   virtual bool IsStateIdle (void);
   virtual bool IsStateBusy (void);
@@ -247,7 +275,7 @@ public:
   virtual uint32_t GetNModes (void) const;
   virtual WifiMode GetMode (uint32_t mode_vlc) const;
   virtual double CalculateSnr (WifiMode txMode, double ber_vlc) const;
-  virtual Ptr<VlcChannel> GetChannel (void) const;
+  virtual Ptr<WifiChannel> GetChannel (void) const;
   
   virtual void ConfigureStandard (enum WifiPhyStandard standard_vlc);
 
@@ -353,40 +381,49 @@ public:
   virtual uint32_t WifiModeToMcs (WifiMode mode_vlc);
   virtual WifiMode McsToWifiMode (uint8_t mcs_vlc);
 
+  /**
+   * Return the mode table of the given standard, building it on first use.
+   * The returned table is shared by all the PHYs and must not be modified.
+   *
+   * \param standard the standard
+   * \return the mode table of the standard
+   */
+  static const VlcPhyModeTable * GetModeTable (enum WifiPhyStandard standard);
+
 private:
   //YansVlcPhy (const YansVlcPhy &o);
   virtual void DoDispose (void);
   /**
-   * Configure YansVlcPhy with appropriate channel frequency and
-   * supported rates for 802.11a standard.
+   * Fill the given table with the supported rates for 802.11a standard.
    */
-  void Configure80211a (void);
+  static void Configure80211a (VlcPhyModeTable *table);
   /**
-   * Configure YansVlcPhy with appropriate channel frequency and
-   * supported rates for 802.11b standard.
+   * Fill the given table with the supported rates for 802.11b standard.
    */
-  void Configure80211b (void);
+  static void Configure80211b (VlcPhyModeTable *table);
   /**
-   * Configure YansVlcPhy with appropriate channel frequency and
-   * supported rates for 802.11g standard.
+   * Fill the given table with the supported rates for 802.11g standard.
    */
-  void Configure80211g (void);
+  static void Configure80211g (VlcPhyModeTable *table);
   /**
-   * Configure YansVlcPhy with appropriate channel frequency and
-   * supported rates for 802.11a standard with 10MHz channel spacing.
+   * Fill the given table with the supported rates for 802.11a standard
+   * with 10MHz channel spacing.
    */
-  void Configure80211_10Mhz (void);
+  static void Configure80211_10Mhz (VlcPhyModeTable *table);
   /**
-   * Configure YansVlcPhy with appropriate channel frequency and
-   * supported rates for 802.11a standard with 5MHz channel spacing.
+   * Fill the given table with the supported rates for 802.11a standard
+   * with 5MHz channel spacing.
    */
-  void Configure80211_5Mhz ();
-  void ConfigureHolland (void);
+  static void Configure80211_5Mhz (VlcPhyModeTable *table);
   /**
-   * Configure YansVlcPhy with appropriate channel frequency and
-   * supported rates for 802.11n standard.
+   * Fill the given table with the supported rates for the holland
+   * standard.
    */
-  void Configure80211n (void);
+  static void ConfigureHolland (VlcPhyModeTable *table);
+  /**
+   * Fill the given table with the supported rates for 802.11n standard.
+   */
+  static void Configure80211n (VlcPhyModeTable *table);
   /**
    * Return the energy detection threshold.
    *
@@ -461,7 +498,7 @@ private:
 
 
   /**
-   * This vector holds the set of transmission modes that this
+   * This table holds the set of transmission modes that this
    * VlcPhy(-derived class) can support. In conversation we call this
    * the DeviceRateSet (not a term you'll find in the standard), and
    * it is a superset of standard-defined parameters such as the
@@ -495,11 +532,12 @@ private:
    * future. Basically, the key point is that we can't be making
    * assumptions like "the Operational Rate Set will contain all the
    * mandatory rates".
+   *
+   * The table also holds the BSS membership selectors and the MCS
+   * supported. It is shared by all the PHYs configured for the same
+   * standard.
    */
-  WifiModeList m_deviceRateSet;
-  
-  std::vector<uint32_t> m_bssMembershipSelectorSet;
-  std::vector<uint8_t> m_deviceMcsSet;
+  const VlcPhyModeTable *m_modes;
   EventId m_endRxEvent;
 
   Ptr<UniformRandomVariable> m_random;  //!< Provides uniform random variables.
@@ -2,6 +2,46 @@
 
 // Include a header file from your module to test.
 #include "ns3/yans-vlc-channel.h"
+#include "ns3/yans-vlc-phy.h"
+#include "ns3/vlc-phy-state-helper.h"
+#include "ns3/vlc-phy-state-recorder.h"
+#include "ns3/vlc-helper.h"
+#include "ns3/vlc-net-device.h"
+#include "ns3/vlc-static-association-helper.h"
+#include "ns3/vlc-drr-queue.h"
+#include "ns3/vlc-header-compressor.h"
+#include "ns3/vlc-compact-llc-header.h"
+#include "ns3/vlc-counter-snapshotter.h"
+#include "ns3/vlc-office-floor-helper.h"
+#include "ns3/vlc-propagation-loss-model.h"
+#include "ns3/vlc-superframe-header.h"
+#include "ns3/vlc-beacon-scheduler.h"
+#include "ns3/vlc-snr-rate-manager.h"
+#include "ns3/ap-vlc-mac.h"
+#include "ns3/sta-vlc-mac.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/mac-low.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "ns3/amsdu-subframe-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -10,40 +50,2299 @@
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class NewModuleTestCase1 : public TestCase
+// Check that the mode tables are shared between PHYs configured for the
+// same standard, and that the memory used by each PHY stays within its
+// budget.
+class VlcPhyFootprintTestCase : public TestCase
 {
 public:
-  NewModuleTestCase1 ();
-  virtual ~NewModuleTestCase1 ();
+  VlcPhyFootprintTestCase ();
 
 private:
   virtual void DoRun (void);
 };
 
-// Add some help text to this case to describe what it is intended to test
-NewModuleTestCase1::NewModuleTestCase1 ()
-  : TestCase ("NewModule test case (does nothing)")
+VlcPhyFootprintTestCase::VlcPhyFootprintTestCase ()
+  : TestCase ("Check the per-PHY memory footprint of YansVlcPhy")
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-NewModuleTestCase1::~NewModuleTestCase1 ()
+void
+VlcPhyFootprintTestCase::DoRun (void)
+{
+  const uint32_t nPhys = 1000;
+  std::vector<Ptr<YansVlcPhy> > phys;
+  for (uint32_t i = 0; i < nPhys; i++)
+    {
+      Ptr<YansVlcPhy> phy = CreateObject<YansVlcPhy> ();
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      phys.push_back (phy);
+    }
+  NS_TEST_ASSERT_MSG_EQ (phys[0]->GetNModes (), 8, "802.11a should support 8 modes");
+  NS_TEST_ASSERT_MSG_EQ (phys[nPhys - 1]->GetMode (7), phys[0]->GetMode (7), "PHYs should support the same modes");
+
+  const VlcPhyModeTable *table = YansVlcPhy::GetModeTable (WIFI_PHY_STANDARD_80211a);
+  NS_TEST_ASSERT_MSG_EQ (YansVlcPhy::GetModeTable (WIFI_PHY_STANDARD_80211a), table, "Mode tables should be shared");
+  NS_TEST_ASSERT_MSG_NE (YansVlcPhy::GetModeTable (WIFI_PHY_STANDARD_80211b), table, "Each standard should have its own table");
+
+  // The shared table is built once, so its cost is amortized over all the
+  // PHYs configured for the standard.
+  uint32_t tableBytes = sizeof (VlcPhyModeTable)
+    + table->deviceRateSet.capacity () * sizeof (WifiMode)
+    + table->bssMembershipSelectorSet.capacity () * sizeof (uint32_t)
+    + table->deviceMcsSet.capacity () * sizeof (uint8_t);
+  uint32_t phyBytes = sizeof (YansVlcPhy) + sizeof (VlcPhyStateHelper) + tableBytes / nPhys;
+  NS_TEST_ASSERT_MSG_LT (phyBytes, 2048, "A PHY and its state helper should fit in 2 KiB");
+  NS_TEST_ASSERT_MSG_LT (tableBytes / nPhys, 8, "The mode table should cost almost nothing per PHY");
+
+  for (std::vector<Ptr<YansVlcPhy> >::iterator i = phys.begin (); i != phys.end (); i++)
+    {
+      (*i)->Dispose ();
+    }
+}
+
+// Build a luminaire and a STA on their own channel, the STA on a desk
+// below the luminaire. The device of the AP comes first.
+static NetDeviceContainer
+InstallApAndSta (const VlcMacHelper &apMac, const VlcMacHelper &staMac)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (0.0, 0.0, 3.0));
+  positions->Add (Vector (0.5, 0.0, 0.8));
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (nodes);
+
+  VlcPhyHelper phy = VlcPhyHelper::Default ();
+  phy.SetChannel (VlcChannelHelper::Default ().Create ());
+  VlcHelper vlc = VlcHelper::Default ();
+  NetDeviceContainer devices = vlc.Install (phy, apMac, nodes.Get (0));
+  devices.Add (vlc.Install (phy, staMac, nodes.Get (1)));
+  return devices;
+}
+
+// Check that the helpers build AP and STA MACs, and that the STA
+// associates with the AP from its beacons.
+class VlcAssociationTestCase : public TestCase
+{
+public:
+  VlcAssociationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Assoc (Mac48Address bssid);
+
+  uint32_t m_assoc;
+  Mac48Address m_bssid;
+};
+
+VlcAssociationTestCase::VlcAssociationTestCase ()
+  : TestCase ("Check the association of a STA with an AP built by VlcHelper"),
+    m_assoc (0)
+{
+}
+
+void
+VlcAssociationTestCase::Assoc (Mac48Address bssid)
+{
+  m_assoc++;
+  m_bssid = bssid;
+}
+
+void
+VlcAssociationTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  VlcMacHelper staMac = VlcMacHelper::Default ();
+  NetDeviceContainer devices = InstallApAndSta (apMac, staMac);
+
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  NS_TEST_ASSERT_MSG_NE (DynamicCast<ApVlcMac> (ap->GetMac ()), 0, "The AP should have an ApVlcMac");
+  NS_TEST_ASSERT_MSG_NE (DynamicCast<StaVlcMac> (sta->GetMac ()), 0, "The STA should have a StaVlcMac");
+  NS_TEST_ASSERT_MSG_NE (ap->GetChannel (), 0, "The device should see the channel of its PHY");
+  sta->GetMac ()->TraceConnectWithoutContext ("Assoc", MakeCallback (&VlcAssociationTestCase::Assoc, this));
+
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_assoc, 1, "The STA should associate once");
+  NS_TEST_ASSERT_MSG_EQ (m_bssid, ap->GetMac ()->GetAddress (), "The STA should associate with the AP");
+  NS_TEST_ASSERT_MSG_EQ (sta->IsLinkUp (), true, "The link of the STA should be up");
+  Simulator::Destroy ();
+}
+
+// A listener which counts the notifications it receives.
+class VlcCountingPhyListener : public WifiPhyListener
+{
+public:
+  VlcCountingPhyListener ()
+    : m_rxStart (0),
+      m_txStart (0)
+  {
+  }
+  virtual void NotifyRxStart (Time duration)
+  {
+    m_rxStart++;
+  }
+  virtual void NotifyRxEndOk (void)
+  {
+  }
+  virtual void NotifyRxEndError (void)
+  {
+  }
+  virtual void NotifyTxStart (Time duration)
+  {
+    m_txStart++;
+  }
+  virtual void NotifyMaybeCcaBusyStart (Time duration)
+  {
+  }
+  virtual void NotifySwitchingStart (Time duration)
+  {
+  }
+
+  uint32_t m_rxStart;
+  uint32_t m_txStart;
+};
+
+// Check that the MAC registers its DcfManager on the fast path of the
+// PHY and not as a listener as well, and that a listener subscribed to
+// some notifications receives each of them once and no others.
+class VlcPhyNotificationTestCase : public TestCase
+{
+public:
+  VlcPhyNotificationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void PhyTxBegin (Ptr<const Packet> packet);
+
+  uint32_t m_phyTxBegin;
+};
+
+VlcPhyNotificationTestCase::VlcPhyNotificationTestCase ()
+  : TestCase ("Check the notifications of the DcfManager and the listeners of a VlcPhy"),
+    m_phyTxBegin (0)
+{
+}
+
+void
+VlcPhyNotificationTestCase::PhyTxBegin (Ptr<const Packet> packet)
+{
+  m_phyTxBegin++;
+}
+
+void
+VlcPhyNotificationTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  PointerValue value;
+  sta->GetPhy ()->GetAttribute ("State", value);
+  Ptr<VlcPhyStateHelper> state = value.Get<VlcPhyStateHelper> ();
+  NS_TEST_ASSERT_MSG_NE (state->GetDcfManager (), 0, "The DcfManager should be registered on the fast path");
+  // MacLow registers its own listener on the PHY: the PHY of the MAC
+  // should have that one only, and no listener for the DcfManager.
+  Ptr<YansVlcPhy> lowPhy = CreateObject<YansVlcPhy> ();
+  Ptr<MacLow> low = CreateObject<MacLow> ();
+  low->SetPhy (lowPhy);
+  lowPhy->GetAttribute ("State", value);
+  uint32_t lowListeners = value.Get<VlcPhyStateHelper> ()->GetNListeners ();
+  low->Dispose ();
+  lowPhy->Dispose ();
+  NS_TEST_ASSERT_MSG_EQ (state->GetNListeners (), lowListeners, "The DcfManager should not be registered as a listener too");
+
+  VlcCountingPhyListener listener;
+  sta->GetPhy ()->RegisterListener (&listener, VlcPhy::TX_START);
+  sta->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcPhyNotificationTestCase::PhyTxBegin, this));
+
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_phyTxBegin, 0, "The STA should transmit to associate");
+  NS_TEST_ASSERT_MSG_EQ (listener.m_txStart, m_phyTxBegin, "The listener should be notified once per transmission");
+  NS_TEST_ASSERT_MSG_EQ (listener.m_rxStart, 0, "The listener should not be notified of receptions");
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (state->GetDcfManager (), 0, "The MAC should unregister its DcfManager when disposed");
+}
+
+// Check that the records of a VlcPhyStateRecorder read back unchanged,
+// that the recorder does not keep the simulation running, and that
+// VlcHelper::EnableStateLog records the states of the PHYs.
+class VlcStateLogTestCase : public TestCase
+{
+public:
+  VlcStateLogTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcStateLogTestCase::VlcStateLogTestCase ()
+  : TestCase ("Check the write/read round trip of a binary PHY state log")
+{
+}
+
+void
+VlcStateLogTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("vlc-states.bin");
+  Ptr<VlcPhyStateRecordFile> file = CreateObject<VlcPhyStateRecordFile> ();
+  file->Open (filename);
+  Ptr<VlcPhyStateRecorder> recorder = CreateObject<VlcPhyStateRecorder> ();
+  recorder->SetAttribute ("BufferSize", UintegerValue (4));
+  recorder->SetPhyId (7);
+  recorder->SetFile (file);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (0.1), &VlcPhyStateRecorder::Record, recorder,
+                           MicroSeconds (10 * i), MicroSeconds (10), VlcPhy::RX);
+    }
+  // Without a Simulator::Stop, Run returns only if the recorder stops
+  // scheduling flushes once its buffer is empty.
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (1.1), "The last event should be the flush of the last records");
+  NS_TEST_ASSERT_MSG_EQ (file->GetNRecords (), 10, "All the records should be flushed");
+  Simulator::Destroy ();
+  file->Close ();
+
+  std::vector<VlcPhyStateRecord> records;
+  NS_TEST_ASSERT_MSG_EQ (VlcPhyStateRecordFile::Read (filename, records), true, "The log should be readable");
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 10, "All the records should be read back");
+  for (uint32_t i = 0; i < records.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (records[i].phyId, 7, "The PHY identifier should be kept");
+      NS_TEST_ASSERT_MSG_EQ (records[i].state, VlcPhy::RX, "The state should be kept");
+      NS_TEST_ASSERT_MSG_EQ (records[i].start, MicroSeconds (10 * i).GetNanoSeconds (), "The records should be in order");
+      NS_TEST_ASSERT_MSG_EQ (records[i].duration, 10000, "The duration should be kept");
+    }
+
+  filename = CreateTempDirFilename ("vlc-states-helper.bin");
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  file = VlcHelper::EnableStateLog (filename, devices);
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  file->Close ();
+
+  records.clear ();
+  NS_TEST_ASSERT_MSG_EQ (VlcPhyStateRecordFile::Read (filename, records), true, "The log should be readable");
+  int64_t total[2] = { 0, 0 };
+  for (uint32_t i = 0; i < records.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_LT (records[i].phyId, 2, "Each device should record with its index");
+      total[records[i].phyId] += records[i].duration;
+    }
+  NS_TEST_ASSERT_MSG_GT (total[0], 0, "The states of the AP should be recorded");
+  NS_TEST_ASSERT_MSG_GT (total[1], 0, "The states of the STA should be recorded");
+  NS_TEST_ASSERT_MSG_LT (total[0], Seconds (0.5).GetNanoSeconds () + 1, "The states of a PHY should not overlap");
+  NS_TEST_ASSERT_MSG_LT (total[1], Seconds (0.5).GetNanoSeconds () + 1, "The states of a PHY should not overlap");
+}
+
+// Check that a device stopped by a full MAC is woken up once the MAC
+// drains, here with broadcast frames, which are sent without an ACK.
+class VlcQueueWakeTestCase : public TestCase
+{
+public:
+  VlcQueueWakeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Fill (Ptr<VlcNetDevice> device);
+  void Stop (void);
+  void Wake (void);
+
+  uint32_t m_sent;
+  uint32_t m_stops;
+  uint32_t m_wakes;
+};
+
+VlcQueueWakeTestCase::VlcQueueWakeTestCase ()
+  : TestCase ("Check that a stopped VlcNetDevice is woken up when its MAC drains"),
+    m_sent (0),
+    m_stops (0),
+    m_wakes (0)
+{
+}
+
+void
+VlcQueueWakeTestCase::Fill (Ptr<VlcNetDevice> device)
+{
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      if (device->Send (Create<Packet> (500), device->GetBroadcast (), 0x0800))
+        {
+          m_sent++;
+        }
+    }
+}
+
+void
+VlcQueueWakeTestCase::Stop (void)
+{
+  m_stops++;
+}
+
+void
+VlcQueueWakeTestCase::Wake (void)
+{
+  m_wakes++;
+}
+
+void
+VlcQueueWakeTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  ap->SetAttribute ("MaxQueuedPackets", UintegerValue (8));
+  ap->SetAttribute ("WakeQueuedPackets", UintegerValue (2));
+  ap->SetQueueStopCallback (MakeCallback (&VlcQueueWakeTestCase::Stop, this));
+  ap->SetQueueWakeCallback (MakeCallback (&VlcQueueWakeTestCase::Wake, this));
+
+  Simulator::Schedule (Seconds (0.5), &VlcQueueWakeTestCase::Fill, this, ap);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_sent, 7, "The device should accept packets until the MAC is full");
+  NS_TEST_ASSERT_MSG_LT (m_sent, 20, "The device should refuse packets once the MAC is full");
+  NS_TEST_ASSERT_MSG_EQ (m_stops, 1, "The device should stop once");
+  NS_TEST_ASSERT_MSG_EQ (m_wakes, 1, "The device should wake up once the MAC drains");
+  NS_TEST_ASSERT_MSG_EQ (ap->IsQueueStopped (), false, "The device should accept packets again");
+  NS_TEST_ASSERT_MSG_EQ (ap->GetQueuedPackets (), 0, "The MAC should be empty");
+  Simulator::Destroy ();
+}
+
+// Check that VlcStaticAssociationHelper associates a STA without any
+// management exchange, and that the AP then accepts its data frames.
+class VlcStaticAssociationTestCase : public TestCase
+{
+public:
+  VlcStaticAssociationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Assoc (Mac48Address bssid);
+  void PhyTxBegin (Ptr<const Packet> packet);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_assoc;
+  uint32_t m_mgtTx;
+  uint32_t m_received;
+};
+
+VlcStaticAssociationTestCase::VlcStaticAssociationTestCase ()
+  : TestCase ("Check the static association of a STA with an AP"),
+    m_assoc (0),
+    m_mgtTx (0),
+    m_received (0)
+{
+}
+
+void
+VlcStaticAssociationTestCase::Assoc (Mac48Address bssid)
+{
+  m_assoc++;
+}
+
+void
+VlcStaticAssociationTestCase::PhyTxBegin (Ptr<const Packet> packet)
+{
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (hdr.IsMgt ())
+    {
+      m_mgtTx++;
+    }
+}
+
+bool
+VlcStaticAssociationTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                       uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+VlcStaticAssociationTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac", "BeaconGeneration", BooleanValue (false));
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  sta->GetMac ()->TraceConnectWithoutContext ("Assoc", MakeCallback (&VlcStaticAssociationTestCase::Assoc, this));
+  sta->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcStaticAssociationTestCase::PhyTxBegin, this));
+  ap->SetReceiveCallback (MakeCallback (&VlcStaticAssociationTestCase::Receive, this));
+
+  VlcStaticAssociationHelper::Install (NetDeviceContainer (sta), NetDeviceContainer (ap));
+  NS_TEST_ASSERT_MSG_EQ (m_assoc, 1, "The static binding should fire Assoc once");
+  NS_TEST_ASSERT_MSG_EQ (sta->IsLinkUp (), true, "The link of the STA should be up at once");
+  NS_TEST_ASSERT_MSG_EQ (sta->GetMac ()->GetBssid (), ap->GetMac ()->GetAddress (), "The STA should be in the BSS of the AP");
+
+  Simulator::Schedule (Seconds (0.1), &VlcNetDevice::Send, sta, Create<Packet> (500), ap->GetAddress (), 0x0800);
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_assoc, 1, "The STA should not associate again without beacons");
+  NS_TEST_ASSERT_MSG_EQ (m_mgtTx, 0, "The STA should not send any association request");
+  NS_TEST_ASSERT_MSG_EQ (m_received, 1, "The AP should accept the frames of the STA");
+  Simulator::Destroy ();
+}
+
+// Check that a burst sent with SendBatch reaches the MAC of the AP,
+// with one MacTx per packet and one MacTxBatch for the burst, and is
+// delivered to its destinations.
+class VlcSendBatchTestCase : public TestCase
+{
+public:
+  VlcSendBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void SendBurst (Ptr<VlcNetDevice> ap, Address sta);
+  void MacTx (Ptr<const Packet> packet);
+  void MacTxBatch (uint32_t packets, uint32_t bytes);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_macTx;
+  uint32_t m_batches;
+  uint32_t m_batchPackets;
+  uint32_t m_received;
+};
+
+VlcSendBatchTestCase::VlcSendBatchTestCase ()
+  : TestCase ("Check the delivery of a burst sent with VlcNetDevice::SendBatch"),
+    m_macTx (0),
+    m_batches (0),
+    m_batchPackets (0),
+    m_received (0)
+{
+}
+
+void
+VlcSendBatchTestCase::SendBurst (Ptr<VlcNetDevice> ap, Address sta)
+{
+  std::vector<std::pair<Ptr<Packet>, Address> > packets;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      packets.push_back (std::make_pair (Create<Packet> (200), i % 2 ? ap->GetBroadcast () : sta));
+    }
+  NS_TEST_EXPECT_MSG_EQ (ap->SendBatch (packets, 0x0800), true, "The burst should be accepted");
+}
+
+void
+VlcSendBatchTestCase::MacTx (Ptr<const Packet> packet)
+{
+  m_macTx++;
+}
+
+void
+VlcSendBatchTestCase::MacTxBatch (uint32_t packets, uint32_t bytes)
+{
+  m_batches++;
+  m_batchPackets += packets;
+}
+
+bool
+VlcSendBatchTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                               uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+VlcSendBatchTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac", "BeaconGeneration", BooleanValue (false));
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  VlcStaticAssociationHelper::Associate (sta, ap);
+  ap->GetMac ()->TraceConnectWithoutContext ("MacTx", MakeCallback (&VlcSendBatchTestCase::MacTx, this));
+  ap->GetMac ()->TraceConnectWithoutContext ("MacTxBatch", MakeCallback (&VlcSendBatchTestCase::MacTxBatch, this));
+  sta->SetReceiveCallback (MakeCallback (&VlcSendBatchTestCase::Receive, this));
+
+  Simulator::Schedule (Seconds (0.1), &VlcSendBatchTestCase::SendBurst, this, ap, sta->GetAddress ());
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_macTx, 10, "MacTx should be fired once per packet");
+  NS_TEST_ASSERT_MSG_EQ (m_batches, 1, "MacTxBatch should be fired once per burst");
+  NS_TEST_ASSERT_MSG_EQ (m_batchPackets, 10, "MacTxBatch should report the packets of the burst");
+  NS_TEST_ASSERT_MSG_EQ (ap->GetMac ()->GetCounters ().tx, 10, "Each packet should be counted once");
+  NS_TEST_ASSERT_MSG_EQ (m_received, 10, "The STA should receive the unicast and the broadcast packets");
+  Simulator::Destroy ();
+}
+
+// Check that the frames an AP sends as A-MSDUs under a block ack
+// agreement are all delivered, and that the device, stopped by its full
+// MAC, is woken up although block acks complete the frames without a
+// TxOk.
+class VlcAggregationTestCase : public TestCase
+{
+public:
+  VlcAggregationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Fill (void);
+  void Wake (void);
+  void PhyTx (Ptr<const Packet> packet);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  Ptr<VlcNetDevice> m_ap;
+  Address m_sta;
+  uint32_t m_sent;
+  uint32_t m_wakes;
+  uint32_t m_phyTx;
+  uint32_t m_received;
+};
+
+VlcAggregationTestCase::VlcAggregationTestCase ()
+  : TestCase ("Check the delivery of A-MSDUs sent under a block ack agreement"),
+    m_sent (0),
+    m_wakes (0),
+    m_phyTx (0),
+    m_received (0)
+{
+}
+
+void
+VlcAggregationTestCase::Fill (void)
+{
+  while (m_sent < 40 && m_ap->Send (Create<Packet> (300), m_sta, 0x0800))
+    {
+      m_sent++;
+    }
+}
+
+void
+VlcAggregationTestCase::Wake (void)
+{
+  m_wakes++;
+  Fill ();
+}
+
+void
+VlcAggregationTestCase::PhyTx (Ptr<const Packet> packet)
+{
+  m_phyTx++;
+}
+
+bool
+VlcAggregationTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                 uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+VlcAggregationTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac",
+                 "BeaconGeneration", BooleanValue (false),
+                 "QosSupported", BooleanValue (true),
+                 "EnableAggregation", BooleanValue (true),
+                 "MaxAggregateAge", TimeValue (MilliSeconds (1)));
+  VlcMacHelper staMac = VlcMacHelper::Default ();
+  staMac.SetType ("ns3::StaVlcMac", "QosSupported", BooleanValue (true));
+  NetDeviceContainer devices = InstallApAndSta (apMac, staMac);
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  VlcStaticAssociationHelper::Associate (sta, ap);
+  m_ap = ap;
+  m_sta = sta->GetAddress ();
+  ap->SetAttribute ("MaxQueuedPackets", UintegerValue (8));
+  ap->SetAttribute ("WakeQueuedPackets", UintegerValue (2));
+  ap->SetQueueWakeCallback (MakeCallback (&VlcAggregationTestCase::Wake, this));
+  ap->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcAggregationTestCase::PhyTx, this));
+  sta->SetReceiveCallback (MakeCallback (&VlcAggregationTestCase::Receive, this));
+
+  Simulator::Schedule (Seconds (0.1), &VlcAggregationTestCase::Fill, this);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sent, 40, "The device should be woken up until all the packets are sent");
+  NS_TEST_ASSERT_MSG_GT (m_wakes, 0, "The device should have been stopped and woken up");
+  NS_TEST_ASSERT_MSG_EQ (m_received, 40, "The STA should receive all the packets");
+  NS_TEST_ASSERT_MSG_LT (m_phyTx, 40, "The packets should be sent in aggregates");
+  NS_TEST_ASSERT_MSG_EQ (ap->GetQueuedPackets (), 0, "The MAC should be empty");
+  m_ap = 0;
+  Simulator::Destroy ();
+}
+
+// Check that a STA of a beacon-enabled BSS transmits only in the window
+// the last beacon gave it, and that a STA which stops sending loses its
+// GTS after GtsTimeout.
+class VlcSuperframeTestCase : public TestCase
+{
+public:
+  VlcSuperframeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Send (void);
+  void ApTx (Ptr<const Packet> packet);
+  void StaTx (Ptr<const Packet> packet);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  Ptr<VlcNetDevice> m_ap;
+  Ptr<VlcNetDevice> m_sta;
+  uint64_t m_slotUs;
+  Time m_lastBeacon;
+  bool m_lastBeaconHasGts;
+  VlcSuperframeHeader::Gts m_gts;
+  uint32_t m_maxGts;
+  uint32_t m_inGts;
+  uint32_t m_outOfWindow;
+  uint32_t m_received;
+};
+
+VlcSuperframeTestCase::VlcSuperframeTestCase ()
+  : TestCase ("Check the superframe schedule and the withdrawal of idle GTS"),
+    m_slotUs (0),
+    m_lastBeaconHasGts (false),
+    m_maxGts (0),
+    m_inGts (0),
+    m_outOfWindow (0),
+    m_received (0)
+{
+}
+
+void
+VlcSuperframeTestCase::Send (void)
+{
+  m_sta->Send (Create<Packet> (500), m_ap->GetAddress (), 0x0800);
+}
+
+void
+VlcSuperframeTestCase::ApTx (Ptr<const Packet> packet)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  WifiMacHeader hdr;
+  copy->RemoveHeader (hdr);
+  if (!hdr.IsBeacon ())
+    {
+      return;
+    }
+  WifiMacTrailer fcs;
+  copy->RemoveTrailer (fcs);
+  MgtBeaconHeader beacon;
+  copy->RemoveHeader (beacon);
+  VlcSuperframeHeader superframe;
+  copy->RemoveHeader (superframe);
+  m_lastBeacon = Simulator::Now ();
+  m_lastBeaconHasGts = superframe.FindGts (m_sta->GetMac ()->GetAddress (), m_gts);
+  m_maxGts = std::max (m_maxGts, superframe.GetNGts ());
+}
+
+void
+VlcSuperframeTestCase::StaTx (Ptr<const Packet> packet)
+{
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (!hdr.IsData ())
+    {
+      return;
+    }
+  // The STA starts its window when it has received the beacon, after the
+  // AP started sending it.
+  Time offset = Simulator::Now () - m_lastBeacon;
+  if (m_lastBeaconHasGts)
+    {
+      if (offset < MicroSeconds (m_slotUs * m_gts.startSlot)
+          || offset > MicroSeconds (m_slotUs * VlcSuperframeHeader::NUM_SLOTS))
+        {
+          m_outOfWindow++;
+        }
+      m_inGts++;
+    }
+  else if (offset > MicroSeconds (m_slotUs * 9))
+    {
+      // without a GTS, the STA contends in the 9 slots of the CAP
+      m_outOfWindow++;
+    }
+}
+
+bool
+VlcSuperframeTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+VlcSuperframeTestCase::DoRun (void)
+{
+  uint64_t beaconIntervalUs = 102400;
+  m_slotUs = beaconIntervalUs / VlcSuperframeHeader::NUM_SLOTS;
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac",
+                 "BeaconInterval", TimeValue (MicroSeconds (beaconIntervalUs)),
+                 "EnableSuperframe", BooleanValue (true),
+                 "FinalCapSlot", UintegerValue (8),
+                 "GtsTimeout", TimeValue (Seconds (0.3)));
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  m_ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  m_sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  m_ap->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcSuperframeTestCase::ApTx, this));
+  m_sta->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcSuperframeTestCase::StaTx, this));
+  m_ap->SetReceiveCallback (MakeCallback (&VlcSuperframeTestCase::Receive, this));
+
+  // 25 packets between 0.5s and 1s, then nothing
+  for (uint32_t i = 0; i < 25; i++)
+    {
+      Simulator::Schedule (Seconds (0.5) + MilliSeconds (20 * i), &VlcSuperframeTestCase::Send, this);
+    }
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, 25, "The AP should receive all the packets of the STA");
+  NS_TEST_ASSERT_MSG_EQ (m_maxGts, 1, "The STA should have been given a GTS");
+  NS_TEST_ASSERT_MSG_GT (m_inGts, 0, "The STA should have sent in its GTS");
+  NS_TEST_ASSERT_MSG_EQ (m_outOfWindow, 0, "The STA should only send in the window the beacon gave it");
+  NS_TEST_ASSERT_MSG_EQ (m_lastBeaconHasGts, false, "The silent STA should have lost its GTS");
+  m_ap = 0;
+  m_sta = 0;
+  Simulator::Destroy ();
+}
+
+// Check that each beacon carries the time it was sent, although its
+// body comes from a cached template.
+class VlcBeaconTimestampTestCase : public TestCase
+{
+public:
+  VlcBeaconTimestampTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void ApTx (Ptr<const Packet> packet);
+
+  uint32_t m_beacons;
+  uint64_t m_lastTimestamp;
+  uint32_t m_stale;
+};
+
+VlcBeaconTimestampTestCase::VlcBeaconTimestampTestCase ()
+  : TestCase ("Check the timestamp of the beacons built from the template"),
+    m_beacons (0),
+    m_lastTimestamp (0),
+    m_stale (0)
+{
+}
+
+void
+VlcBeaconTimestampTestCase::ApTx (Ptr<const Packet> packet)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  WifiMacHeader hdr;
+  copy->RemoveHeader (hdr);
+  if (!hdr.IsBeacon ())
+    {
+      return;
+    }
+  MgtBeaconHeader beacon;
+  copy->RemoveHeader (beacon);
+  // The beacon is stamped when it is queued, and waits at most for the
+  // medium to be free before it is sent.
+  uint64_t now = Simulator::Now ().GetMicroSeconds ();
+  if (beacon.GetTimestamp () > now
+      || now - beacon.GetTimestamp () > 1000
+      || (m_beacons > 0 && beacon.GetTimestamp () <= m_lastTimestamp))
+    {
+      m_stale++;
+    }
+  m_lastTimestamp = beacon.GetTimestamp ();
+  m_beacons++;
+}
+
+void
+VlcBeaconTimestampTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  ap->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcBeaconTimestampTestCase::ApTx, this));
+
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_beacons, 5, "The AP should send a beacon every beacon interval");
+  NS_TEST_ASSERT_MSG_EQ (m_stale, 0, "Each beacon should carry the time it was sent");
+  Simulator::Destroy ();
+}
+
+// Check that a STA walking from one luminaire to the next hands over
+// to the second one, that the first one is told the STA left, and that
+// the link is down for no longer than an association exchange.
+class VlcHandoverTestCase : public TestCase
+{
+public:
+  VlcHandoverTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Handover (Mac48Address oldBssid, Mac48Address newBssid, Time interruption);
+
+  uint32_t m_handovers;
+  Mac48Address m_oldBssid;
+  Mac48Address m_newBssid;
+  Time m_interruption;
+};
+
+VlcHandoverTestCase::VlcHandoverTestCase ()
+  : TestCase ("Check the handover of a moving STA between two luminaires"),
+    m_handovers (0)
+{
+}
+
+void
+VlcHandoverTestCase::Handover (Mac48Address oldBssid, Mac48Address newBssid, Time interruption)
+{
+  m_handovers++;
+  m_oldBssid = oldBssid;
+  m_newBssid = newBssid;
+  m_interruption = interruption;
+}
+
+void
+VlcHandoverTestCase::DoRun (void)
+{
+  // The second luminaire is out of the field of view of the STA at
+  // first, so that the STA associates with the first one.
+  NodeContainer apNodes;
+  apNodes.Create (2);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (0.0, 0.0, 3.0));
+  positions->Add (Vector (8.0, 0.0, 3.0));
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (apNodes);
+  Ptr<Node> staNode = CreateObject<Node> ();
+  Ptr<ConstantVelocityMobilityModel> walk = CreateObject<ConstantVelocityMobilityModel> ();
+  walk->SetPosition (Vector (0.5, 0.0, 0.8));
+  walk->SetVelocity (Vector (2.0, 0.0, 0.0));
+  staNode->AggregateObject (walk);
+
+  // The luminaires do not see each other: jitter their beacons so that
+  // they do not always collide at the STA.
+  VlcChannelHelper channel;
+  channel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  channel.AddPropagationLoss ("ns3::VlcLambertianPropagationLossModel");
+  VlcPhyHelper phy = VlcPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  VlcHelper vlc = VlcHelper::Default ();
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac",
+                 "EnableBeaconJitter", BooleanValue (true));
+  VlcMacHelper staMac = VlcMacHelper::Default ();
+  staMac.SetType ("ns3::StaVlcMac",
+                  "EnableHandover", BooleanValue (true));
+  NetDeviceContainer apDevices = vlc.Install (phy, apMac, apNodes);
+  NetDeviceContainer staDevices = vlc.Install (phy, staMac, staNode);
+  Ptr<VlcNetDevice> ap1 = DynamicCast<VlcNetDevice> (apDevices.Get (0));
+  Ptr<VlcNetDevice> ap2 = DynamicCast<VlcNetDevice> (apDevices.Get (1));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (staDevices.Get (0));
+  sta->GetMac ()->TraceConnectWithoutContext ("Handover", MakeCallback (&VlcHandoverTestCase::Handover, this));
+
+  // The STA reaches the middle of the two luminaires at 1.75s and
+  // stops 0.5m before the second one.
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+
+  Mac48Address staAddress = sta->GetMac ()->GetAddress ();
+  NS_TEST_ASSERT_MSG_EQ (m_handovers, 1, "The STA should hand over once");
+  NS_TEST_ASSERT_MSG_EQ (m_oldBssid, ap1->GetMac ()->GetAddress (), "The STA should leave the first luminaire");
+  NS_TEST_ASSERT_MSG_EQ (m_newBssid, ap2->GetMac ()->GetAddress (), "The STA should join the second luminaire");
+  NS_TEST_ASSERT_MSG_LT (m_interruption, MilliSeconds (20), "The link should only be down for an association exchange");
+  NS_TEST_ASSERT_MSG_EQ (ap1->GetMac ()->GetWifiRemoteStationManager ()->IsAssociated (staAddress), false,
+                         "The first luminaire should have received the disassociation of the STA");
+  NS_TEST_ASSERT_MSG_EQ (ap2->GetMac ()->GetWifiRemoteStationManager ()->IsAssociated (staAddress), true,
+                         "The second luminaire should have the STA associated");
+  Simulator::Destroy ();
+}
+
+// Check that VlcHeaderCompressor restores the headers it compresses, that
+// its decompressor recovers from lost packets, and that a context given
+// to a new flow whose IR packets are lost does not rebuild the packets of
+// that flow with the headers of the old one.
+class VlcHeaderCompressorTestCase : public TestCase
+{
+public:
+  VlcHeaderCompressorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  // Build an IPv4/UDP datagram with a 100-byte payload
+  static Ptr<Packet> CreateDatagram (uint16_t sourcePort, uint16_t id);
+  // Compress a datagram and return the compressed packet
+  Ptr<Packet> Compress (uint16_t sourcePort, uint16_t id);
+  // Decompress a packet and check its headers; return false if the packet
+  // was dropped
+  bool Decompress (Ptr<Packet> packet, uint16_t sourcePort, uint16_t id);
+
+  Ptr<VlcHeaderCompressor> m_compressor;
+  Ptr<VlcHeaderCompressor> m_decompressor;
+  Mac48Address m_from;
+  Mac48Address m_to;
+};
+
+VlcHeaderCompressorTestCase::VlcHeaderCompressorTestCase ()
+  : TestCase ("Check the IR/CO round trip, loss recovery and context reuse of VlcHeaderCompressor"),
+    m_from (Mac48Address ("00:00:00:00:00:01")),
+    m_to (Mac48Address ("00:00:00:00:00:02"))
+{
+}
+
+Ptr<Packet>
+VlcHeaderCompressorTestCase::CreateDatagram (uint16_t sourcePort, uint16_t id)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (sourcePort);
+  udp.SetDestinationPort (9);
+  packet->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (Ipv4Address ("10.1.1.1"));
+  ip.SetDestination (Ipv4Address ("10.1.1.2"));
+  ip.SetProtocol (17);
+  ip.SetPayloadSize (packet->GetSize ());
+  ip.SetTtl (64);
+  ip.SetIdentification (id);
+  packet->AddHeader (ip);
+  return packet;
+}
+
+Ptr<Packet>
+VlcHeaderCompressorTestCase::Compress (uint16_t sourcePort, uint16_t id)
+{
+  Ptr<Packet> packet = CreateDatagram (sourcePort, id);
+  uint16_t protocol = 0x0800;
+  m_compressor->Compress (packet, protocol, m_from, m_to);
+  NS_TEST_EXPECT_MSG_EQ (protocol, VlcHeaderCompressor::PROT_NUMBER, "The datagram should be compressed");
+  return packet;
+}
+
+bool
+VlcHeaderCompressorTestCase::Decompress (Ptr<Packet> packet, uint16_t sourcePort, uint16_t id)
+{
+  uint16_t protocol = VlcHeaderCompressor::PROT_NUMBER;
+  if (!m_decompressor->Decompress (packet, protocol, m_from, m_to))
+    {
+      return false;
+    }
+  NS_TEST_EXPECT_MSG_EQ (protocol, 0x0800, "The packet should be restored as IPv4");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 128, "The packet should get back its size");
+  Ipv4Header ip;
+  packet->RemoveHeader (ip);
+  UdpHeader udp;
+  packet->RemoveHeader (udp);
+  NS_TEST_EXPECT_MSG_EQ (ip.GetSource (), Ipv4Address ("10.1.1.1"), "The source address should be restored");
+  NS_TEST_EXPECT_MSG_EQ (ip.GetIdentification (), id, "The identification should be restored");
+  NS_TEST_EXPECT_MSG_EQ (ip.GetTtl (), 64, "The TTL should be restored");
+  NS_TEST_EXPECT_MSG_EQ (udp.GetSourcePort (), sourcePort, "The source port should be restored");
+  NS_TEST_EXPECT_MSG_EQ (udp.GetDestinationPort (), 9, "The destination port should be restored");
+  return true;
+}
+
+void
+VlcHeaderCompressorTestCase::DoRun (void)
+{
+  m_compressor = CreateObject<VlcHeaderCompressor> ();
+  m_compressor->SetAttribute ("MaxContexts", UintegerValue (1));
+  m_compressor->SetAttribute ("RefreshInterval", UintegerValue (4));
+  m_compressor->SetAttribute ("IrRepeat", UintegerValue (3));
+  m_decompressor = CreateObject<VlcHeaderCompressor> ();
+
+  // The first three packets of a flow are IR packets, the next ones CO
+  // packets of 4 bytes instead of the 28 bytes of the IP/UDP headers.
+  uint16_t id = 1000;
+  for (uint32_t i = 0; i < 6; i++, id++)
+    {
+      Ptr<Packet> packet = Compress (1000, id);
+      NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), i < 3 ? 133 : 104, "Unexpected size of packet " << i);
+      NS_TEST_ASSERT_MSG_EQ (Decompress (packet, 1000, id), true, "Packet " << i << " should be decompressed");
+    }
+
+  // Lose a few CO packets: the next one still finds its MSN and
+  // identification.
+  id += 3;
+  m_compressor->SetAttribute ("RefreshInterval", UintegerValue (64));
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Compress (1000, id - 3 + i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (Decompress (Compress (1000, id), 1000, id), true, "The flow should survive lost packets");
+  id++;
+  NS_TEST_ASSERT_MSG_EQ (m_decompressor->GetDecompressionFailures (), 0, "No packet should be dropped so far");
+
+  // A second flow takes the only context and its IR packets are lost:
+  // its CO packets must be dropped, not rebuilt with the ports of the
+  // first flow, until its next IR packet.
+  m_compressor->SetAttribute ("RefreshInterval", UintegerValue (4));
+  for (uint32_t i = 0; i < 3; i++, id++)
+    {
+      Compress (2000, id);
+    }
+  for (uint32_t i = 0; i < 4; i++, id++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Decompress (Compress (2000, id), 2000, id), false,
+                             "A CO packet of an unknown flow should be dropped");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_decompressor->GetDecompressionFailures (), 4, "The CRC should catch every packet of the new flow");
+  NS_TEST_ASSERT_MSG_EQ (Decompress (Compress (2000, id), 2000, id), true, "The IR packet should resynchronize the flow");
+  id++;
+  NS_TEST_ASSERT_MSG_EQ (Decompress (Compress (2000, id), 2000, id), true, "The new flow should be decompressed");
+
+  m_compressor->Dispose ();
+  m_decompressor->Dispose ();
+}
+
+// Check that in hybrid mode the frames of the upper layers of a STA go
+// over its uplink device while the downlink stays optical, and that the
+// devices of the uplink keep their addresses, whether they get them
+// before or after they are attached.
+class VlcHybridTestCase : public TestCase
+{
+public:
+  VlcHybridTestCase (bool uplinkFirst);
+
+private:
+  virtual void DoRun (void);
+  void SendUplink (void);
+  void SendDownlink (void);
+  void StaVlcTx (Ptr<const Packet> packet);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  bool m_uplinkFirst;
+  Ptr<VlcNetDevice> m_ap;
+  Ptr<VlcNetDevice> m_sta;
+  uint32_t m_apRx;
+  uint32_t m_staRx;
+  uint32_t m_staVlcData;
+};
+
+VlcHybridTestCase::VlcHybridTestCase (bool uplinkFirst)
+  : TestCase (uplinkFirst
+              ? "Check the hybrid mode of VlcNetDevice with uplink devices attached before their addresses are set"
+              : "Check the hybrid VLC downlink / RF uplink mode of VlcNetDevice"),
+    m_uplinkFirst (uplinkFirst),
+    m_apRx (0),
+    m_staRx (0),
+    m_staVlcData (0)
+{
+}
+
+void
+VlcHybridTestCase::SendUplink (void)
+{
+  m_sta->Send (Create<Packet> (500), m_ap->GetAddress (), 0x0800);
+}
+
+void
+VlcHybridTestCase::SendDownlink (void)
+{
+  m_ap->Send (Create<Packet> (500), m_sta->GetAddress (), 0x0800);
+}
+
+void
+VlcHybridTestCase::StaVlcTx (Ptr<const Packet> packet)
+{
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (hdr.IsData ())
+    {
+      m_staVlcData++;
+    }
+}
+
+bool
+VlcHybridTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  if (device == m_ap)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Mac48Address::ConvertFrom (from), m_sta->GetAddress (), "The AP should see the address of the STA");
+      m_apRx++;
+    }
+  else
+    {
+      m_staRx++;
+    }
+  return true;
+}
+
+void
+VlcHybridTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  m_ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  m_sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+
+  Ptr<SimpleChannel> rf = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> apRf = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> staRf = CreateObject<SimpleNetDevice> ();
+  apRf->SetChannel (rf);
+  staRf->SetChannel (rf);
+  m_ap->GetNode ()->AddDevice (apRf);
+  m_sta->GetNode ()->AddDevice (staRf);
+  m_ap->SetAttribute ("HybridMode", EnumValue (VlcNetDevice::HYBRID_AP));
+  m_sta->SetAttribute ("HybridMode", EnumValue (VlcNetDevice::HYBRID_STA));
+  if (m_uplinkFirst)
+    {
+      // The uplink devices get their addresses once attached, and the
+      // VLC devices are given addresses of their own afterwards.
+      m_ap->SetUplinkDevice (apRf);
+      m_sta->SetUplinkDevice (staRf);
+      apRf->SetAddress (Mac48Address::Allocate ());
+      staRf->SetAddress (Mac48Address::Allocate ());
+      m_ap->SetAddress (Mac48Address::Allocate ());
+      m_sta->SetAddress (Mac48Address::Allocate ());
+    }
+  else
+    {
+      apRf->SetAddress (Mac48Address::Allocate ());
+      staRf->SetAddress (Mac48Address::Allocate ());
+      m_ap->SetUplinkDevice (apRf);
+      m_sta->SetUplinkDevice (staRf);
+    }
+  Mac48Address apRfAddress = Mac48Address::ConvertFrom (apRf->GetAddress ());
+  Mac48Address staRfAddress = Mac48Address::ConvertFrom (staRf->GetAddress ());
+  NS_TEST_ASSERT_MSG_EQ (Mac48Address::ConvertFrom (apRf->GetAddress ()), apRfAddress, "The uplink device of the AP should keep its address");
+  NS_TEST_ASSERT_MSG_EQ (Mac48Address::ConvertFrom (m_ap->GetAddress ()), apRfAddress, "The AP should take the address of its uplink device");
+  NS_TEST_ASSERT_MSG_EQ (Mac48Address::ConvertFrom (staRf->GetAddress ()), staRfAddress, "The uplink device of the STA should keep its address");
+  NS_TEST_ASSERT_MSG_EQ (Mac48Address::ConvertFrom (m_sta->GetAddress ()), staRfAddress, "The STA should take the address of its uplink device");
+  NS_TEST_ASSERT_MSG_EQ (m_ap->GetMac ()->GetAddress (), apRfAddress, "The VLC MAC of the AP should use the address of the uplink device");
+  NS_TEST_ASSERT_MSG_EQ (m_sta->GetMac ()->GetAddress (), staRfAddress, "The VLC MAC of the STA should use the address of the uplink device");
+  VlcStaticAssociationHelper::Associate (m_sta, m_ap);
+
+  m_ap->SetReceiveCallback (MakeCallback (&VlcHybridTestCase::Receive, this));
+  m_sta->SetReceiveCallback (MakeCallback (&VlcHybridTestCase::Receive, this));
+  m_sta->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcHybridTestCase::StaVlcTx, this));
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (0.1) + MilliSeconds (10 * i), &VlcHybridTestCase::SendUplink, this);
+      Simulator::Schedule (Seconds (0.1) + MilliSeconds (10 * i + 5), &VlcHybridTestCase::SendDownlink, this);
+    }
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_apRx, 10, "The AP should receive the uplink over the uplink device");
+  NS_TEST_ASSERT_MSG_EQ (m_staRx, 10, "The STA should receive the downlink over VLC");
+  NS_TEST_ASSERT_MSG_EQ (m_staVlcData, 0, "The STA should send no data frame over VLC");
+  m_ap = 0;
+  m_sta = 0;
+  Simulator::Destroy ();
+}
+
+// Check that the MTU of VlcNetDevice is bounded by the PLCP header of
+// the PHY, and that the fragmentation threshold raised for a jumbo MTU
+// comes back when the MTU goes down.
+class VlcMtuTestCase : public TestCase
+{
+public:
+  VlcMtuTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcMtuTestCase::VlcMtuTestCase ()
+  : TestCase ("Check the jumbo MTU bounds and the fragmentation threshold of VlcNetDevice")
+{
+}
+
+void
+VlcMtuTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> device = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<WifiRemoteStationManager> manager = device->GetRemoteStationManager ();
+  uint32_t threshold = manager->GetFragmentationThreshold ();
+
+  // 4095 bytes of PSDU, less the QoS data header, the FCS and LLC/SNAP
+  NS_TEST_ASSERT_MSG_EQ (device->SetMtu (4058), false, "An 802.11a PSDU cannot exceed 4095 bytes");
+  NS_TEST_ASSERT_MSG_EQ (device->SetMtu (4057), true, "The largest 802.11a MTU should be accepted");
+  NS_TEST_ASSERT_MSG_GT (manager->GetFragmentationThreshold (), 4057, "The jumbo MSDUs should not be fragmented");
+  NS_TEST_ASSERT_MSG_EQ (device->SetMtu (3000), true, "A smaller jumbo MTU should be accepted");
+  NS_TEST_ASSERT_MSG_LT (manager->GetFragmentationThreshold (), 3100, "The threshold should follow the MTU down");
+  NS_TEST_ASSERT_MSG_EQ (device->SetMtu (1500), true, "A regular MTU should be accepted");
+  NS_TEST_ASSERT_MSG_EQ (manager->GetFragmentationThreshold (), threshold, "The original threshold should be restored");
+  Simulator::Destroy ();
+}
+
+// Check that VlcDrrQueue shares the airtime, not the frames, between a
+// fast and a slow station, and that its lookups stay cheap with many
+// stations.
+class VlcDrrQueueTestCase : public TestCase
+{
+public:
+  VlcDrrQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcDrrQueueTestCase::VlcDrrQueueTestCase ()
+  : TestCase ("Check the airtime fairness and the lookups of VlcDrrQueue")
+{
+}
+
+void
+VlcDrrQueueTestCase::DoRun (void)
+{
+  Mac48Address fast = Mac48Address::Allocate ();
+  Mac48Address slow = Mac48Address::Allocate ();
+  Time fastAirtime = MicroSeconds (100);
+  Time slowAirtime = MicroSeconds (1000);
+  Time quantum = MicroSeconds (1000);
+  VlcDrrQueue queue;
+  queue.SetQuantum (quantum);
+  WifiMacHeader hdr;
+  hdr.SetTypeData ();
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      hdr.SetAddr1 (fast);
+      queue.Enqueue (Create<Packet> (100), hdr, fastAirtime);
+      hdr.SetAddr1 (slow);
+      queue.Enqueue (Create<Packet> (1000), hdr, slowAirtime);
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.GetNPackets (), 400, "All the frames should be queued");
+
+  Time fastTotal = Seconds (0);
+  Time slowTotal = Seconds (0);
+  Ptr<const Packet> packet;
+  while (fastTotal + slowTotal < MilliSeconds (100) && queue.Dequeue (packet, hdr))
+    {
+      if (hdr.GetAddr1 () == fast)
+        {
+          fastTotal += fastAirtime;
+        }
+      else
+        {
+          slowTotal += slowAirtime;
+        }
+    }
+  // A round robin over the frames would give the fast station a tenth of
+  // the airtime of the slow one. With deficits in airtime, the shares
+  // differ by at most a quantum and a frame.
+  Time difference = fastTotal > slowTotal ? fastTotal - slowTotal : slowTotal - fastTotal;
+  NS_TEST_ASSERT_MSG_EQ (difference <= quantum + slowAirtime, true, "The stations should get the same airtime");
+
+  VlcDrrQueue many;
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      hdr.SetAddr1 (Mac48Address::Allocate ());
+      many.Enqueue (Create<Packet> (100), hdr, fastAirtime);
+    }
+  NS_TEST_ASSERT_MSG_EQ (many.GetNStations (), 5000, "Each address should have its own queue");
+  NS_TEST_ASSERT_MSG_LT (many.GetMaxBucketSize (), 3, "The lookup cost should not grow with the number of stations");
+  NS_TEST_ASSERT_MSG_EQ (many.RemoveStation (hdr.GetAddr1 ()), 1, "The queue of the station should be dropped");
+  NS_TEST_ASSERT_MSG_EQ (many.GetNPackets (), 4999, "Only the frame of the removed station should be dropped");
+}
+
+// VlcCounterSnapshotter writes the MAC counters, including the frames
+// the MAC drops itself: a frame for a station which is not associated,
+// and a frame which exhausts its retries once the STA is out of reach.
+class VlcCounterSnapshotterTestCase : public TestCase
+{
+public:
+  VlcCounterSnapshotterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcCounterSnapshotterTestCase::VlcCounterSnapshotterTestCase ()
+  : TestCase ("Check the MAC counters written by VlcCounterSnapshotter")
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-NewModuleTestCase1::DoRun (void)
+VlcCounterSnapshotterTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac", "BeaconGeneration", BooleanValue (false));
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  VlcStaticAssociationHelper::Associate (sta, ap);
+
+  std::string filename = CreateTempDirFilename ("vlc-counters.txt");
+  Ptr<VlcCounterSnapshotter> snapshotter = CreateObject<VlcCounterSnapshotter> ();
+  snapshotter->SetAttribute ("Interval", TimeValue (Seconds (0.25)));
+  snapshotter->Add (devices);
+  snapshotter->Start (filename);
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (0.1) + MicroSeconds (i * 10), &VlcNetDevice::Send, ap,
+                           Create<Packet> (500), sta->GetAddress (), 0x0800);
+    }
+  Simulator::Schedule (Seconds (0.2), &VlcNetDevice::Send, ap,
+                       Create<Packet> (500), Mac48Address ("00:00:00:00:00:99"), 0x0800);
+  Ptr<MobilityModel> mobility = sta->GetNode ()->GetObject<MobilityModel> ();
+  Simulator::Schedule (Seconds (0.6), &MobilityModel::SetPosition, mobility, Vector (1000.0, 0.0, 0.8));
+  Simulator::Schedule (Seconds (0.7), &VlcNetDevice::Send, sta,
+                       Create<Packet> (500), ap->GetAddress (), 0x0800);
+  Simulator::Schedule (Seconds (1.9), &VlcCounterSnapshotter::Stop, snapshotter);
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+
+  const VlcMac::Counters &apCounters = ap->GetMac ()->GetCounters ();
+  const VlcMac::Counters &staCounters = sta->GetMac ()->GetCounters ();
+  NS_TEST_ASSERT_MSG_EQ (apCounters.tx, 10, "The frames for the STA should be accepted");
+  NS_TEST_ASSERT_MSG_EQ (apCounters.txDrop, 1, "The frame for an unknown station should be dropped");
+  NS_TEST_ASSERT_MSG_EQ (staCounters.rx, 10, "The STA should receive the frames of the AP");
+  NS_TEST_ASSERT_MSG_GT (staCounters.retryDrop, 0, "The frame sent out of reach should exhaust its retries");
+
+  std::ifstream is (filename.c_str ());
+  std::string line;
+  std::getline (is, line);
+  NS_TEST_ASSERT_MSG_EQ (line.substr (0, 6), "# time", "The file should start with the column names");
+  std::vector<std::vector<double> > rows;
+  while (std::getline (is, line))
+    {
+      std::istringstream iss (line);
+      std::vector<double> row;
+      double value;
+      while (iss >> value)
+        {
+          row.push_back (value);
+        }
+      rows.push_back (row);
+    }
+  // 7 periodic snapshots, from 0.25s to 1.75s, and the last one at 1.9s
+  NS_TEST_ASSERT_MSG_EQ (rows.size (), 16, "Each snapshot should write one line per device");
+  const VlcMac::Counters *counters[2] = { &apCounters, &staCounters };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      const std::vector<double> &row = rows[rows.size () - 2 + i];
+      NS_TEST_ASSERT_MSG_EQ (row.size (), 26, "Each line should have all the columns");
+      NS_TEST_ASSERT_MSG_EQ (row[0], 1.9, "The last snapshot should be written by Stop");
+      NS_TEST_ASSERT_MSG_EQ (row[3], counters[i]->tx, "macTx should be written");
+      NS_TEST_ASSERT_MSG_EQ (row[5], counters[i]->txDrop, "macTxDrop should be written");
+      NS_TEST_ASSERT_MSG_EQ (row[6], counters[i]->retryDrop, "macRetryDrop should be written");
+      NS_TEST_ASSERT_MSG_EQ (row[7], counters[i]->lifetimeDrop, "macLifetimeDrop should be written");
+      NS_TEST_ASSERT_MSG_EQ (row[8], counters[i]->rx, "macRx should be written");
+    }
+  Simulator::Destroy ();
+}
+
+// VlcOfficeFloorHelper builds a working floor, and builds the same floor
+// again from the same stream.
+class VlcOfficeFloorTestCase : public TestCase
+{
+public:
+  VlcOfficeFloorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::vector<Vector> BuildFloor (int64_t stream);
+};
+
+VlcOfficeFloorTestCase::VlcOfficeFloorTestCase ()
+  : TestCase ("Check that VlcOfficeFloorHelper is reproducible with SetStream")
+{
+}
+
+std::vector<Vector>
+VlcOfficeFloorTestCase::BuildFloor (int64_t stream)
+{
+  VlcOfficeFloorHelper floor;
+  floor.SetRooms (2, 1, 6.0, 6.0);
+  floor.SetLuminaireGrid (2, 2);
+  floor.SetStasPerRoom (3);
+  floor.SetRandomBlockers (2, Vector (0.5, 0.5, 1.8));
+  floor.SetStream (stream);
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  floor.Install (VlcHelper::Default (), VlcPhyHelper::Default (), apMac, VlcMacHelper::Default ());
+  NS_TEST_EXPECT_MSG_EQ (floor.GetNRooms (), 2, "The floor should have a room per cell of the grid");
+  NS_TEST_EXPECT_MSG_EQ (floor.GetApDevices ().GetN (), 8, "Each room should have its grid of luminaires");
+  NS_TEST_EXPECT_MSG_EQ (floor.GetStaDevices ().GetN (), 6, "Each room should have its STAs");
+
+  std::vector<Vector> positions;
+  for (uint32_t room = 0; room < floor.GetNRooms (); room++)
+    {
+      NodeContainer stas = floor.GetStaNodes (room);
+      for (uint32_t i = 0; i < stas.GetN (); i++)
+        {
+          positions.push_back (stas.Get (i)->GetObject<MobilityModel> ()->GetPosition ());
+        }
+      PointerValue loss;
+      floor.GetChannel (room)->GetAttribute ("PropagationLossModel", loss);
+      Ptr<VlcBlockerPropagationLossModel> blockers = loss.Get<VlcBlockerPropagationLossModel> ();
+      NS_TEST_EXPECT_MSG_NE (blockers, 0, "The room should have its obstacles");
+      for (uint32_t i = 0; blockers != 0 && i < blockers->GetNBlockers (); i++)
+        {
+          Box box = blockers->GetBlocker (i);
+          positions.push_back (Vector (box.xMin, box.yMin, box.zMin));
+        }
+    }
+  Simulator::Destroy ();
+  return positions;
+}
+
+void
+VlcOfficeFloorTestCase::DoRun (void)
+{
+  std::vector<Vector> first = BuildFloor (10);
+  std::vector<Vector> second = BuildFloor (10);
+  NS_TEST_ASSERT_MSG_EQ (first.size (), 10, "The STAs and obstacles of both rooms should be placed");
+  NS_TEST_ASSERT_MSG_EQ (second.size (), first.size (), "The same stream should build the same floor");
+  for (uint32_t i = 0; i < first.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (second[i].x, first[i].x, "The same stream should build the same floor");
+      NS_TEST_ASSERT_MSG_EQ (second[i].y, first[i].y, "The same stream should build the same floor");
+    }
+
+  std::vector<Vector> other = BuildFloor (20);
+  bool differ = false;
+  for (uint32_t i = 0; i < first.size () && i < other.size (); i++)
+    {
+      differ = differ || other[i].x != first[i].x || other[i].y != first[i].y;
+    }
+  NS_TEST_ASSERT_MSG_EQ (differ, true, "Another stream should build another floor");
+}
+
+// The airtime accounted by VlcPhyStateHelper in the PHY states adds up
+// to the time elapsed since the last reset, including in the middle of
+// a transmission or a reception.
+class VlcAirtimeStatsTestCase : public TestCase
+{
+public:
+  VlcAirtimeStatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void PhyTxBegin (Ptr<const Packet> packet);
+  void Check (void);
+  void Reset (void);
+
+  Ptr<VlcPhyStateHelper> m_states[2];
+  Time m_resetTime;
+  uint32_t m_checks;
+};
+
+VlcAirtimeStatsTestCase::VlcAirtimeStatsTestCase ()
+  : TestCase ("Check that the airtime statistics add up to the elapsed time"),
+    m_checks (0)
+{
+}
+
+void
+VlcAirtimeStatsTestCase::PhyTxBegin (Ptr<const Packet> packet)
+{
+  // Check at the start of the frame and while it is in the air
+  Check ();
+  Simulator::Schedule (MicroSeconds (10), &VlcAirtimeStatsTestCase::Check, this);
+  Simulator::Schedule (MicroSeconds (30), &VlcAirtimeStatsTestCase::Check, this);
+}
+
+void
+VlcAirtimeStatsTestCase::Check (void)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      VlcPhyStateHelper::AirtimeStats stats = m_states[i]->GetAirtimeStats ();
+      Time total = stats.idleTime + stats.ccaBusyTime + stats.txTime + stats.rxTime + stats.switchingTime;
+      NS_TEST_EXPECT_MSG_EQ (total, Simulator::Now () - m_resetTime, "The airtime should add up to the elapsed time");
+      m_checks++;
+    }
+}
+
+void
+VlcAirtimeStatsTestCase::Reset (void)
+{
+  m_states[0]->ResetAirtimeStats ();
+  m_states[1]->ResetAirtimeStats ();
+  m_resetTime = Simulator::Now ();
+}
+
+void
+VlcAirtimeStatsTestCase::DoRun (void)
+{
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac");
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<VlcNetDevice> device = DynamicCast<VlcNetDevice> (devices.Get (i));
+      PointerValue value;
+      device->GetPhy ()->GetAttribute ("State", value);
+      m_states[i] = value.Get<VlcPhyStateHelper> ();
+      device->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcAirtimeStatsTestCase::PhyTxBegin, this));
+    }
+  m_resetTime = Seconds (0);
+  for (uint32_t i = 1; i < 20; i++)
+    {
+      Simulator::Schedule (MilliSeconds (50 * i), &VlcAirtimeStatsTestCase::Check, this);
+    }
+  Simulator::Schedule (MilliSeconds (512), &VlcAirtimeStatsTestCase::Reset, this);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  // The beacons and the association exchange give frames to check
+  NS_TEST_ASSERT_MSG_GT (m_checks, 2 * 19, "The airtime should be checked during the transmissions");
+  VlcPhyStateHelper::AirtimeStats ap = m_states[0]->GetAirtimeStats ();
+  VlcPhyStateHelper::AirtimeStats sta = m_states[1]->GetAirtimeStats ();
+  NS_TEST_ASSERT_MSG_GT (ap.txFrames, 0, "The AP should transmit beacons after the reset");
+  NS_TEST_ASSERT_MSG_EQ (sta.rxTime.IsStrictlyPositive (), true, "The STA should receive the beacons");
+  Simulator::Destroy ();
+}
+
+// The end of the CCA busy state predicted by VlcPhyStateHelper matches
+// GetDelayUntilIdle as undecodable signals are added to the medium, and
+// a change of the CCA threshold invalidates the prediction.
+class VlcCcaPredictionTestCase : public TestCase
+{
+public:
+  VlcCcaPredictionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Sense (void);
+  Time Receive (uint32_t size, double rxPowerDbm);
+
+  Ptr<YansVlcPhy> m_phy;
+  Ptr<VlcPhyStateHelper> m_state;
+};
+
+VlcCcaPredictionTestCase::VlcCcaPredictionTestCase ()
+  : TestCase ("Check the predicted end of the CCA busy state of YansVlcPhy")
+{
+}
+
+Time
+VlcCcaPredictionTestCase::Receive (uint32_t size, double rxPowerDbm)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  m_phy->StartReceivePacket (Create<Packet> (size), rxPowerDbm, txVector, WIFI_PREAMBLE_LONG);
+  return Simulator::Now () + m_phy->CalculateTxDuration (size, txVector, WIFI_PREAMBLE_LONG);
+}
+
+void
+VlcCcaPredictionTestCase::Sense (void)
+{
+  Time now = Simulator::Now ();
+  Time end = Receive (1000, -70.0);
+  NS_TEST_EXPECT_MSG_EQ (m_state->IsStateCcaBusy (), true, "A signal above the CCA threshold should make the medium busy");
+  NS_TEST_EXPECT_MSG_EQ (m_state->GetPredictedCcaBusyEnd (), end, "The prediction should be the end of the signal");
+  NS_TEST_EXPECT_MSG_EQ (now + m_state->GetDelayUntilIdle (), end, "The prediction should match GetDelayUntilIdle");
+
+  // A shorter signal cannot move the end of the busy state
+  Receive (100, -70.0);
+  NS_TEST_EXPECT_MSG_EQ (m_state->GetPredictedCcaBusyEnd (), end, "A shorter signal should not move the prediction");
+  NS_TEST_EXPECT_MSG_EQ (now + m_state->GetDelayUntilIdle (), end, "The prediction should match GetDelayUntilIdle");
+
+  end = Receive (2000, -70.0);
+  NS_TEST_EXPECT_MSG_EQ (m_state->GetPredictedCcaBusyEnd (), end, "A longer signal should move the prediction");
+  NS_TEST_EXPECT_MSG_EQ (now + m_state->GetDelayUntilIdle (), end, "The prediction should match GetDelayUntilIdle");
+
+  // No signal is above the new threshold: the next scan finds an idle
+  // medium instead of keeping the prediction made for the old threshold.
+  m_phy->SetAttribute ("CcaMode1Threshold", DoubleValue (-50.0));
+  NS_TEST_EXPECT_MSG_EQ (m_state->IsCcaBusyPredictionValid (now), false, "A new threshold should invalidate the prediction");
+  Receive (100, -70.0);
+  NS_TEST_EXPECT_MSG_EQ (m_state->GetPredictedCcaBusyEnd (), now, "The prediction should use the new threshold");
+}
+
+void
+VlcCcaPredictionTestCase::DoRun (void)
+{
+  m_phy = CreateObject<YansVlcPhy> ();
+  m_phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  m_phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  // Too weak to synchronize on, strong enough to make the medium busy
+  m_phy->SetAttribute ("EnergyDetectionThreshold", DoubleValue (-60.0));
+  m_phy->SetAttribute ("CcaMode1Threshold", DoubleValue (-80.0));
+  PointerValue value;
+  m_phy->GetAttribute ("State", value);
+  m_state = value.Get<VlcPhyStateHelper> ();
+
+  Simulator::Schedule (Seconds (1.0), &VlcCcaPredictionTestCase::Sense, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_phy->Dispose ();
+  m_phy = 0;
+  m_state = 0;
+}
+
+// An access point which records the times of its beacons.
+class VlcBeaconRecorder
+{
+public:
+  void Beacon (void)
+  {
+    m_times.push_back (Simulator::Now ());
+  }
+
+  std::vector<Time> m_times;
+};
+
+// VlcBeaconScheduler keeps the phase of each access point, set by its
+// initial delay, while other access points are added and removed,
+// including one sharing its phase.
+class VlcBeaconSchedulerTestCase : public TestCase
+{
+public:
+  VlcBeaconSchedulerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcBeaconSchedulerTestCase::VlcBeaconSchedulerTestCase ()
+  : TestCase ("Check that VlcBeaconScheduler keeps the beacon phases across Add and Remove")
+{
+}
+
+void
+VlcBeaconSchedulerTestCase::DoRun (void)
+{
+  const Time interval = MilliSeconds (100);
+  const uint32_t nAps = 5;
+  // The last access point is added at 0.42s, 5ms before its first beacon
+  const Time phase[nAps] = { MilliSeconds (10), MilliSeconds (35), MilliSeconds (35), MilliSeconds (70), MilliSeconds (25) };
+  const uint32_t expected[nAps] = { 10, 3, 10, 10, 6 };
+  VlcBeaconRecorder aps[nAps];
+  VlcBeaconScheduler scheduler;
+  uint32_t ids[nAps - 1];
+  for (uint32_t i = 0; i < nAps - 1; i++)
+    {
+      ids[i] = scheduler.Add (interval, phase[i], MakeCallback (&VlcBeaconRecorder::Beacon, &aps[i]));
+    }
+  Simulator::Schedule (Seconds (0.25), &VlcBeaconScheduler::Remove, &scheduler, interval, ids[1]);
+  Simulator::Schedule (Seconds (0.42), &VlcBeaconScheduler::Add, &scheduler, interval, MilliSeconds (5),
+                       MakeCallback (&VlcBeaconRecorder::Beacon, &aps[nAps - 1]));
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < nAps; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (aps[i].m_times.size (), expected[i], "Each access point should send one beacon per interval");
+      for (uint32_t j = 0; j < aps[i].m_times.size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((aps[i].m_times[j] - phase[i]).GetNanoSeconds () % interval.GetNanoSeconds (), 0,
+                                 "Each access point should keep its phase");
+          if (j > 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (aps[i].m_times[j] - aps[i].m_times[j - 1], interval,
+                                     "Each access point should send a beacon every interval");
+            }
+        }
+    }
+  // The scheduler is destroyed with this scope: its events must go first
+  Simulator::Destroy ();
+}
+
+// Access points whose phases fall in the same tick of VlcBeaconScheduler
+// are dispatched together, at the start of the tick, while the next tick
+// has its own dispatch.
+class VlcBeaconTickTestCase : public TestCase
+{
+public:
+  VlcBeaconTickTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcBeaconTickTestCase::VlcBeaconTickTestCase ()
+  : TestCase ("Check that VlcBeaconScheduler dispatches the phases of a tick at once")
+{
+}
+
+void
+VlcBeaconTickTestCase::DoRun (void)
+{
+  const Time interval = MilliSeconds (100);
+  const uint32_t nAps = 3;
+  // The first two access points are 0.5ms apart, within a 1ms tick
+  const Time phase[nAps] = { MicroSeconds (10200), MicroSeconds (10700), MicroSeconds (11100) };
+  const Time dispatch[nAps] = { MilliSeconds (10), MilliSeconds (10), MilliSeconds (11) };
+  VlcBeaconRecorder aps[nAps];
+  VlcBeaconScheduler scheduler;
+  for (uint32_t i = 0; i < nAps; i++)
+    {
+      // Each access point sets the tick before registering, as ApVlcMac does
+      scheduler.SetTick (MilliSeconds (1));
+      scheduler.Add (interval, phase[i], MakeCallback (&VlcBeaconRecorder::Beacon, &aps[i]));
+    }
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < nAps; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (aps[i].m_times.size (), 5, "Each access point should send one beacon per interval");
+      for (uint32_t j = 0; j < aps[i].m_times.size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (aps[i].m_times[j], dispatch[i] + MilliSeconds (100 * j),
+                                 "The phase should be rounded down to the tick");
+        }
+    }
+  Simulator::Destroy ();
+}
+
+// VlcSnrRateManager sends with the fastest mode whose SNR threshold is
+// met by the last measurement, and falls back to the most robust mode
+// after the final failure of a frame.
+class VlcSnrRateManagerTestCase : public TestCase
+{
+public:
+  VlcSnrRateManagerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+VlcSnrRateManagerTestCase::VlcSnrRateManagerTestCase ()
+  : TestCase ("Check the mode selected by VlcSnrRateManager")
+{
+}
+
+void
+VlcSnrRateManagerTestCase::DoRun (void)
+{
+  const double ber = 1e-5;
+  Ptr<YansVlcPhy> phy = CreateObject<YansVlcPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  Ptr<VlcSnrRateManager> manager = CreateObject<VlcSnrRateManager> ();
+  manager->SetAttribute ("BerThreshold", DoubleValue (ber));
+  manager->SetAttribute ("SnrMargin", DoubleValue (0.0));
+  manager->SetupPhy (phy);
+
+  Mac48Address address ("00:00:00:00:00:01");
+  for (uint32_t i = 0; i < phy->GetNModes (); i++)
+    {
+      manager->AddSupportedMode (address, phy->GetMode (i));
+    }
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_DATA);
+  hdr.SetAddr1 (address);
+  Ptr<Packet> packet = Create<Packet> (1000);
+  WifiMode robust = phy->GetMode (0);
+  NS_TEST_ASSERT_MSG_EQ (manager->GetDataTxVector (address, &hdr, packet, 1000).GetMode (), robust,
+                         "The most robust mode should be used until the first measurement");
+
+  // Just above the threshold of the 36 Mbit/s mode
+  double snr = phy->CalculateSnr (WifiPhy::GetOfdmRate36Mbps (), ber) * 1.01;
+  WifiMode fastest = robust;
+  for (uint32_t i = 0; i < phy->GetNModes (); i++)
+    {
+      WifiMode mode = phy->GetMode (i);
+      if (phy->CalculateSnr (mode, ber) <= snr && mode.GetDataRate () > fastest.GetDataRate ())
+        {
+          fastest = mode;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (fastest.GetDataRate () >= 36000000, true, "The 36 Mbit/s mode should be usable");
+  manager->ReportRxOk (address, &hdr, snr, robust);
+  NS_TEST_ASSERT_MSG_EQ (manager->GetDataTxVector (address, &hdr, packet, 1000).GetMode (), fastest,
+                         "The fastest mode above its threshold should be selected");
+
+  manager->ReportFinalDataFailed (address, &hdr);
+  NS_TEST_ASSERT_MSG_EQ (manager->GetDataTxVector (address, &hdr, packet, 1000).GetMode (), robust,
+                         "The most robust mode should be used after the final failure");
+
+  manager->ReportRxOk (address, &hdr, snr, robust);
+  NS_TEST_ASSERT_MSG_EQ (manager->GetDataTxVector (address, &hdr, packet, 1000).GetMode (), fastest,
+                         "The next measurement should select the fastest mode again");
+
+  // Just at the threshold of the most robust mode
+  manager->ReportRxOk (address, &hdr, phy->CalculateSnr (robust, ber), robust);
+  WifiMode slow = manager->GetDataTxVector (address, &hdr, packet, 1000).GetMode ();
+  NS_TEST_ASSERT_MSG_EQ (slow.GetDataRate () < fastest.GetDataRate (), true, "A lower SNR should select a slower mode");
+
+  manager->Dispose ();
+  phy->Dispose ();
+}
+
+// Check that a QoS STA continues its TXOPs: with a TXOP limit, the
+// frames of a saturated uplink follow each other a SIFS after the ACK
+// of the previous one, within the limit; without one, each frame waits
+// for a new backoff.
+class VlcTxopTestCase : public TestCase
+{
+public:
+  VlcTxopTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void RunBurst (Time txopLimit);
+  void State (Time start, Time duration, enum VlcPhy::State state);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  Time m_sifs;
+  Time m_slot;
+  Time m_idle;
+  Time m_txopStart;
+  Time m_maxTxopSpan;
+  uint32_t m_txops;
+  uint32_t m_frames;
+  uint32_t m_received;
+};
+
+VlcTxopTestCase::VlcTxopTestCase ()
+  : TestCase ("Check the number of frames sent per TXOP")
+{
+}
+
+void
+VlcTxopTestCase::State (Time start, Time duration, enum VlcPhy::State state)
+{
+  if (state == VlcPhy::IDLE)
+    {
+      m_idle = duration;
+      return;
+    }
+  if (state != VlcPhy::TX)
+    {
+      return;
+    }
+  m_frames++;
+  // Without a backoff, the medium was only idle for a SIFS since the ACK
+  // of the previous frame.
+  if (m_txops == 0 || m_idle >= m_sifs + m_slot)
+    {
+      m_txops++;
+      m_txopStart = start;
+    }
+  m_maxTxopSpan = Max (m_maxTxopSpan, start + duration - m_txopStart);
+}
+
+bool
+VlcTxopTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                          uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+VlcTxopTestCase::RunBurst (Time txopLimit)
+{
+  m_idle = Seconds (0);
+  m_maxTxopSpan = Seconds (0);
+  m_txops = 0;
+  m_frames = 0;
+  m_received = 0;
+
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac",
+                 "BeaconGeneration", BooleanValue (false),
+                 "QosSupported", BooleanValue (true));
+  VlcMacHelper staMac = VlcMacHelper::Default ();
+  staMac.SetType ("ns3::StaVlcMac",
+                  "QosSupported", BooleanValue (true),
+                  "BE_TxopLimit", TimeValue (txopLimit));
+  NetDeviceContainer devices = InstallApAndSta (apMac, staMac);
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  VlcStaticAssociationHelper::Associate (sta, ap);
+  ap->SetReceiveCallback (MakeCallback (&VlcTxopTestCase::Receive, this));
+  m_sifs = sta->GetMac ()->GetSifs ();
+  m_slot = sta->GetMac ()->GetSlot ();
+  PointerValue value;
+  sta->GetPhy ()->GetAttribute ("State", value);
+  value.Get<VlcPhyStateHelper> ()->TraceConnectWithoutContext ("State", MakeCallback (&VlcTxopTestCase::State, this));
+
+  // The STA has no other frame to send
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      Simulator::Schedule (MilliSeconds (100), &VlcNetDevice::Send, sta,
+                           Create<Packet> (500), ap->GetAddress (), 0x0800);
+    }
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+VlcTxopTestCase::DoRun (void)
+{
+  RunBurst (Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (m_received, 20, "The AP should receive all the packets");
+  NS_TEST_ASSERT_MSG_EQ (m_txops, m_frames, "Without a TXOP limit, each frame should have its own TXOP");
+
+  RunBurst (MicroSeconds (3008));
+  NS_TEST_ASSERT_MSG_EQ (m_received, 20, "The AP should receive all the packets");
+  NS_TEST_ASSERT_MSG_EQ (m_frames, 20, "No frame should be retransmitted");
+  NS_TEST_ASSERT_MSG_GT (m_frames, m_txops, "Several frames should be sent per TXOP");
+  NS_TEST_ASSERT_MSG_LT (m_maxTxopSpan, MicroSeconds (3008 + 1), "The frames of a TXOP should be sent within its limit");
+}
+
+// Check that an AP splits the MSDUs of a received A-MSDU, padded
+// subframes and a truncated last subframe included, between those it
+// forwards up and those it relays to another STA, and that the relayed
+// MSDUs enter the queues together, so that they leave in one A-MSDU.
+class VlcAmsduRelayTestCase : public TestCase
+{
+public:
+  VlcAmsduRelayTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void AddSubframe (Ptr<Packet> amsdu, Mac48Address to, uint32_t size, uint32_t length);
+  void SendAmsdu (void);
+  void ApTx (Ptr<const Packet> packet);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  Ptr<VlcNetDevice> m_ap;
+  Ptr<VlcNetDevice> m_sta;
+  Ptr<VlcNetDevice> m_peer;
+  std::vector<uint32_t> m_apRx;
+  std::vector<uint32_t> m_peerRx;
+  uint32_t m_relayTx;
+  uint32_t m_relayAmsduTx;
+};
+
+VlcAmsduRelayTestCase::VlcAmsduRelayTestCase ()
+  : TestCase ("Check the deaggregation of an A-MSDU received by an AP"),
+    m_relayTx (0),
+    m_relayAmsduTx (0)
+{
+}
+
+void
+VlcAmsduRelayTestCase::AddSubframe (Ptr<Packet> amsdu, Mac48Address to, uint32_t size, uint32_t length)
+{
+  Ptr<Packet> msdu = Create<Packet> (size);
+  LlcSnapHeader llc;
+  llc.SetType (0x0800);
+  msdu->AddHeader (llc);
+  AmsduSubframeHeader subframe;
+  subframe.SetDestinationAddr (to);
+  subframe.SetSourceAddr (m_sta->GetMac ()->GetAddress ());
+  // A length beyond the MSDU makes a truncated subframe
+  subframe.SetLength (length == 0 ? msdu->GetSize () : length);
+  msdu->AddHeader (subframe);
+  uint32_t padding = (4 - (msdu->GetSize () % 4)) % 4;
+  amsdu->AddAtEnd (msdu);
+  amsdu->AddAtEnd (Create<Packet> (padding));
+}
+
+void
+VlcAmsduRelayTestCase::SendAmsdu (void)
+{
+  Mac48Address ap = m_ap->GetMac ()->GetAddress ();
+  Mac48Address peer = m_peer->GetMac ()->GetAddress ();
+  Ptr<Packet> amsdu = Create<Packet> ();
+  AddSubframe (amsdu, ap, 100, 0);
+  AddSubframe (amsdu, peer, 201, 0);
+  AddSubframe (amsdu, peer, 151, 0);
+  AddSubframe (amsdu, ap, 101, 0);
+  AddSubframe (amsdu, peer, 20, 300);
+
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetQosTid (0);
+  hdr.SetQosAmsdu ();
+  hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
+  hdr.SetQosNoEosp ();
+  hdr.SetQosTxopLimit (0);
+  hdr.SetAddr1 (ap);
+  hdr.SetAddr2 (m_sta->GetMac ()->GetAddress ());
+  hdr.SetAddr3 (ap);
+  hdr.SetDsTo ();
+  hdr.SetDsNotFrom ();
+  hdr.SetSequenceNumber (0);
+  hdr.SetFragmentNumber (0);
+  hdr.SetNoMoreFragments ();
+  hdr.SetNoRetry ();
+  amsdu->AddHeader (hdr);
+  WifiMacTrailer fcs;
+  amsdu->AddTrailer (fcs);
+
+  // Sent by the PHY of the STA, as the STA does not aggregate its frames
+  WifiMode mode = m_sta->GetPhy ()->GetMode (0);
+  WifiTxVector txVector;
+  txVector.SetMode (mode);
+  txVector.SetTxPowerLevel (0);
+  m_sta->GetPhy ()->SendPacket (amsdu, mode, WIFI_PREAMBLE_LONG, txVector);
+}
+
+void
+VlcAmsduRelayTestCase::ApTx (Ptr<const Packet> packet)
+{
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (hdr.IsData () && hdr.GetAddr1 () == m_peer->GetMac ()->GetAddress ())
+    {
+      m_relayTx++;
+      if (hdr.IsQosAmsdu ())
+        {
+          m_relayAmsduTx++;
+        }
+    }
+}
+
+bool
+VlcAmsduRelayTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                uint16_t protocol, const Address &from)
+{
+  if (device == m_ap)
+    {
+      m_apRx.push_back (packet->GetSize ());
+    }
+  else
+    {
+      m_peerRx.push_back (packet->GetSize ());
+    }
+  return true;
+}
+
+void
+VlcAmsduRelayTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (0.0, 0.0, 3.0));
+  positions->Add (Vector (0.5, 0.0, 0.8));
+  positions->Add (Vector (-0.5, 0.0, 0.8));
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (nodes);
+
+  VlcPhyHelper phy = VlcPhyHelper::Default ();
+  phy.SetChannel (VlcChannelHelper::Default ().Create ());
+  VlcHelper vlc = VlcHelper::Default ();
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac",
+                 "BeaconGeneration", BooleanValue (false),
+                 "QosSupported", BooleanValue (true),
+                 "EnableAggregation", BooleanValue (true),
+                 "MaxAggregateAge", TimeValue (MilliSeconds (1)),
+                 "BlockAckThreshold", UintegerValue (0));
+  VlcMacHelper staMac = VlcMacHelper::Default ();
+  staMac.SetType ("ns3::StaVlcMac", "QosSupported", BooleanValue (true));
+  m_ap = DynamicCast<VlcNetDevice> (vlc.Install (phy, apMac, nodes.Get (0)).Get (0));
+  m_sta = DynamicCast<VlcNetDevice> (vlc.Install (phy, staMac, nodes.Get (1)).Get (0));
+  m_peer = DynamicCast<VlcNetDevice> (vlc.Install (phy, staMac, nodes.Get (2)).Get (0));
+  VlcStaticAssociationHelper::Associate (m_sta, m_ap);
+  VlcStaticAssociationHelper::Associate (m_peer, m_ap);
+  m_ap->SetReceiveCallback (MakeCallback (&VlcAmsduRelayTestCase::Receive, this));
+  m_peer->SetReceiveCallback (MakeCallback (&VlcAmsduRelayTestCase::Receive, this));
+  m_ap->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcAmsduRelayTestCase::ApTx, this));
+
+  Simulator::Schedule (Seconds (0.1), &VlcAmsduRelayTestCase::SendAmsdu, this);
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_apRx.size (), 2, "The AP should forward up the MSDUs addressed to it");
+  NS_TEST_ASSERT_MSG_EQ (m_apRx[0], 100, "The first MSDU should be cut before its padding");
+  NS_TEST_ASSERT_MSG_EQ (m_apRx[1], 101, "The MSDU after the relayed ones should be forwarded up");
+  NS_TEST_ASSERT_MSG_EQ (m_peerRx.size (), 2, "The truncated subframe should be dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_peerRx[0], 201, "The relayed MSDUs should keep their order");
+  NS_TEST_ASSERT_MSG_EQ (m_peerRx[1], 151, "The relayed MSDUs should keep their order");
+  NS_TEST_ASSERT_MSG_EQ (m_relayTx, 1, "The relayed MSDUs should be queued together");
+  NS_TEST_ASSERT_MSG_EQ (m_relayAmsduTx, 1, "The relayed MSDUs should be aggregated again");
+  m_ap = 0;
+  m_sta = 0;
+  m_peer = 0;
+  Simulator::Destroy ();
+}
+
+// Check that YansVlcPhy reports each reason why it drops a packet both
+// through the PhyRxDropReason trace and in its per-reason counters.
+class VlcRxDropReasonTestCase : public TestCase
+{
+public:
+  VlcRxDropReasonTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Receive (double rxPowerDbm);
+  void Transmit (void);
+  void RxDrop (Ptr<const Packet> packet, enum VlcPhy::RxDropReason reason);
+
+  Ptr<YansVlcPhy> m_phy;
+  std::vector<enum VlcPhy::RxDropReason> m_reasons;
+};
+
+VlcRxDropReasonTestCase::VlcRxDropReasonTestCase ()
+  : TestCase ("Check the reasons of the packets dropped by the PHY")
+{
+}
+
+void
+VlcRxDropReasonTestCase::Receive (double rxPowerDbm)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (m_phy->GetMode (0));
+  txVector.SetTxPowerLevel (0);
+  m_phy->StartReceivePacket (Create<Packet> (1000), rxPowerDbm, txVector, WIFI_PREAMBLE_LONG);
+}
+
+void
+VlcRxDropReasonTestCase::Transmit (void)
+{
+  PointerValue value;
+  m_phy->GetAttribute ("State", value);
+  value.Get<VlcPhyStateHelper> ()->SwitchToTx (MicroSeconds (500), Create<Packet> (1000),
+                                               m_phy->GetMode (0), WIFI_PREAMBLE_LONG, 0);
+}
+
+void
+VlcRxDropReasonTestCase::RxDrop (Ptr<const Packet> packet, enum VlcPhy::RxDropReason reason)
+{
+  m_reasons.push_back (reason);
+}
+
+void
+VlcRxDropReasonTestCase::DoRun (void)
+{
+  m_phy = CreateObject<YansVlcPhy> ();
+  m_phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  m_phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  // Low enough to synchronize on a signal far below the noise
+  m_phy->SetAttribute ("EnergyDetectionThreshold", DoubleValue (-120.0));
+  m_phy->TraceConnectWithoutContext ("PhyRxDropReason", MakeCallback (&VlcRxDropReasonTestCase::RxDrop, this));
+
+  // A packet arriving during the reception of another one, weak enough
+  // not to corrupt it
+  Simulator::Schedule (Seconds (1.0), &VlcRxDropReasonTestCase::Receive, this, -50.0);
+  Simulator::Schedule (Seconds (1.0) + MicroSeconds (10), &VlcRxDropReasonTestCase::Receive, this, -80.0);
+  // A packet below the energy detection threshold
+  Simulator::Schedule (Seconds (2.0), &VlcRxDropReasonTestCase::Receive, this, -130.0);
+  // A packet arriving during a transmission
+  Simulator::Schedule (Seconds (3.0), &VlcRxDropReasonTestCase::Transmit, this);
+  Simulator::Schedule (Seconds (3.0) + MicroSeconds (10), &VlcRxDropReasonTestCase::Receive, this, -50.0);
+  // A packet synchronized on, but received with errors
+  Simulator::Schedule (Seconds (4.0), &VlcRxDropReasonTestCase::Receive, this, -110.0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_reasons.size (), 4, "The PHY should drop four packets");
+  NS_TEST_ASSERT_MSG_EQ (m_reasons[0], VlcPhy::RX_DROP_ALREADY_RX, "The PHY was receiving");
+  NS_TEST_ASSERT_MSG_EQ (m_reasons[1], VlcPhy::RX_DROP_BELOW_THRESHOLD, "The signal was too weak");
+  NS_TEST_ASSERT_MSG_EQ (m_reasons[2], VlcPhy::RX_DROP_ALREADY_TX, "The PHY was transmitting");
+  NS_TEST_ASSERT_MSG_EQ (m_reasons[3], VlcPhy::RX_DROP_PER, "The packet had errors");
+
+  const VlcPhy::Counters &counters = m_phy->GetCounters ();
+  NS_TEST_ASSERT_MSG_EQ (counters.rxDrop, 4, "Each drop should be counted");
+  NS_TEST_ASSERT_MSG_EQ (counters.rxDropReason[VlcPhy::RX_DROP_SWITCHING], 0, "The PHY never switched channel");
+  NS_TEST_ASSERT_MSG_EQ (counters.rxDropReason[VlcPhy::RX_DROP_ALREADY_RX], 1, "Drops while receiving should be counted");
+  NS_TEST_ASSERT_MSG_EQ (counters.rxDropReason[VlcPhy::RX_DROP_ALREADY_TX], 1, "Drops while transmitting should be counted");
+  NS_TEST_ASSERT_MSG_EQ (counters.rxDropReason[VlcPhy::RX_DROP_BELOW_THRESHOLD], 1, "Weak signals should be counted");
+  NS_TEST_ASSERT_MSG_EQ (counters.rxDropReason[VlcPhy::RX_DROP_PER], 1, "Packets with errors should be counted");
+  NS_TEST_ASSERT_MSG_EQ (counters.rxEnd, 1, "The first packet should be received");
+  m_phy->Dispose ();
+  m_phy = 0;
+}
+
+// Check that the packets of a device go through with and without
+// compact framing, with the same ethertype, and that the ethertypes
+// starting with 0xaa keep their LLC/SNAP header.
+class VlcCompactFramingTestCase : public TestCase
+{
+public:
+  VlcCompactFramingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void RunRoundTrip (bool compact);
+  void StaTx (Ptr<const Packet> packet);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  std::vector<uint32_t> m_bodySizes;
+  std::vector<uint16_t> m_protocols;
+  std::vector<uint32_t> m_sizes;
+};
+
+VlcCompactFramingTestCase::VlcCompactFramingTestCase ()
+  : TestCase ("Check the round trip of the LLC header with and without compact framing")
+{
+}
+
+void
+VlcCompactFramingTestCase::StaTx (Ptr<const Packet> packet)
+{
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (hdr.IsData ())
+    {
+      m_bodySizes.push_back (packet->GetSize () - hdr.GetSize () - WIFI_MAC_FCS_LENGTH);
+    }
+}
+
+bool
+VlcCompactFramingTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                    uint16_t protocol, const Address &from)
+{
+  m_protocols.push_back (protocol);
+  m_sizes.push_back (packet->GetSize ());
+  return true;
+}
+
+void
+VlcCompactFramingTestCase::RunRoundTrip (bool compact)
+{
+  m_bodySizes.clear ();
+  m_protocols.clear ();
+  m_sizes.clear ();
+  VlcMacHelper apMac = VlcMacHelper::Default ();
+  apMac.SetType ("ns3::ApVlcMac", "BeaconGeneration", BooleanValue (false));
+  NetDeviceContainer devices = InstallApAndSta (apMac, VlcMacHelper::Default ());
+  Ptr<VlcNetDevice> ap = DynamicCast<VlcNetDevice> (devices.Get (0));
+  Ptr<VlcNetDevice> sta = DynamicCast<VlcNetDevice> (devices.Get (1));
+  VlcStaticAssociationHelper::Associate (sta, ap);
+  sta->SetAttribute ("CompactFraming", BooleanValue (compact));
+  sta->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&VlcCompactFramingTestCase::StaTx, this));
+  ap->SetReceiveCallback (MakeCallback (&VlcCompactFramingTestCase::Receive, this));
+
+  const uint16_t protocols[3] = { 0x0800, 0x86dd, 0xaa01 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (MilliSeconds (100 * (i + 1)), &VlcNetDevice::Send, sta,
+                           Create<Packet> (100 + i), ap->GetAddress (), protocols[i]);
+    }
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_protocols.size (), 3, "The AP should receive all the packets");
+  NS_TEST_ASSERT_MSG_EQ (m_bodySizes.size (), 3, "Each packet should be sent once");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_protocols[i], protocols[i], "The ethertype should survive the round trip");
+      NS_TEST_ASSERT_MSG_EQ (m_sizes[i], 100 + i, "The LLC header should be removed");
+      uint32_t llcSize = compact && VlcCompactLlcHeader::CanCompact (protocols[i]) ? 2 : 8;
+      NS_TEST_ASSERT_MSG_EQ (m_bodySizes[i], 100 + i + llcSize, "Unexpected LLC header size");
+    }
+}
+
+void
+VlcCompactFramingTestCase::DoRun (void)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  NS_TEST_ASSERT_MSG_EQ (VlcCompactLlcHeader::CanCompact (0x0800), true, "IPv4 should use compact framing");
+  NS_TEST_ASSERT_MSG_EQ (VlcCompactLlcHeader::CanCompact (0xaa01), false, "0xaa01 would be taken for LLC/SNAP");
+  RunRoundTrip (false);
+  RunRoundTrip (true);
 }
 
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
@@ -60,7 +2359,33 @@ NewModuleTestSuite::NewModuleTestSuite ()
   : TestSuite ("new-module", UNIT)
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new NewModuleTestCase1, TestCase::QUICK);
+  AddTestCase (new VlcPhyFootprintTestCase, TestCase::QUICK);
+  AddTestCase (new VlcAssociationTestCase, TestCase::QUICK);
+  AddTestCase (new VlcPhyNotificationTestCase, TestCase::QUICK);
+  AddTestCase (new VlcStateLogTestCase, TestCase::QUICK);
+  AddTestCase (new VlcQueueWakeTestCase, TestCase::QUICK);
+  AddTestCase (new VlcStaticAssociationTestCase, TestCase::QUICK);
+  AddTestCase (new VlcSendBatchTestCase, TestCase::QUICK);
+  AddTestCase (new VlcAggregationTestCase, TestCase::QUICK);
+  AddTestCase (new VlcSuperframeTestCase, TestCase::QUICK);
+  AddTestCase (new VlcBeaconTimestampTestCase, TestCase::QUICK);
+  AddTestCase (new VlcHandoverTestCase, TestCase::QUICK);
+  AddTestCase (new VlcHybridTestCase (false), TestCase::QUICK);
+  AddTestCase (new VlcHybridTestCase (true), TestCase::QUICK);
+  AddTestCase (new VlcMtuTestCase, TestCase::QUICK);
+  AddTestCase (new VlcDrrQueueTestCase, TestCase::QUICK);
+  AddTestCase (new VlcHeaderCompressorTestCase, TestCase::QUICK);
+  AddTestCase (new VlcCounterSnapshotterTestCase, TestCase::QUICK);
+  AddTestCase (new VlcOfficeFloorTestCase, TestCase::QUICK);
+  AddTestCase (new VlcAirtimeStatsTestCase, TestCase::QUICK);
+  AddTestCase (new VlcCcaPredictionTestCase, TestCase::QUICK);
+  AddTestCase (new VlcBeaconSchedulerTestCase, TestCase::QUICK);
+  AddTestCase (new VlcBeaconTickTestCase, TestCase::QUICK);
+  AddTestCase (new VlcSnrRateManagerTestCase, TestCase::QUICK);
+  AddTestCase (new VlcTxopTestCase, TestCase::QUICK);
+  AddTestCase (new VlcAmsduRelayTestCase, TestCase::QUICK);
+  AddTestCase (new VlcRxDropReasonTestCase, TestCase::QUICK);
+  AddTestCase (new VlcCompactFramingTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite